@@ -153,6 +153,13 @@ es_make_install_third_party_library(
     RESULT_INSTALL_DIR ZLIB_ROOT
 )
 
+# The multithreaded compression relies on pthreads which are unavailable with Emscripten.
+if(EMSCRIPTEN)
+    set(zstd_multithread_support OFF)
+else()
+    set(zstd_multithread_support ON)
+endif()
+
 es_make_install_third_party_library(
     zstd
     REQUIRED
@@ -165,7 +172,7 @@ es_make_install_third_party_library(
     -DZSTD_BUILD_SHARED=OFF
     -DZSTD_BUILD_TESTS=OFF
     -DZSTD_BUILD_PROGRAMS=OFF
-    -DZSTD_MULTITHREAD_SUPPORT=OFF
+    -DZSTD_MULTITHREAD_SUPPORT=${zstd_multithread_support}
     ${extra_cmake_args}
     SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR}/third-party/zstd/build/cmake
 )
@@ -27,16 +27,73 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <memory_resource>
 #include <new>
 
 extern "C" {
+/**
+ * @brief A backend serving all allocations of the ABI containers.
+ * @remark Allocations request the default alignment unless over-aligned storage is needed, and every deallocation
+ *         carries the exact size and alignment of the allocation. The allocation routine returns nullptr on failure.
+ */
+struct es_allocator_backend {
+    void* (*allocate)(void* context, std::size_t size, std::size_t alignment) noexcept;
+    void (*deallocate)(void* context, void* ptr, std::size_t size, std::size_t alignment) noexcept;
+    void* context;
+};
+
 ES_API(CPPESSENCE) void* es_alloc(std::size_t size) noexcept;
 ES_API(CPPESSENCE) void* es_aligned_alloc(std::size_t size, std::size_t alignment) noexcept;
 ES_API(CPPESSENCE) void es_dealloc(void* ptr, std::size_t size) noexcept;
 ES_API(CPPESSENCE) void es_aligned_dealloc(void* ptr, std::size_t size, std::size_t alignment) noexcept;
+
+/**
+ * @brief Gets the current allocator backend.
+ * @return The current allocator backend.
+ */
+ES_API(CPPESSENCE) const es_allocator_backend* es_get_allocator_backend() noexcept;
+
+/**
+ * @brief Installs an allocator backend.
+ * @param backend The backend which must live until the process exits, or nullptr to restore the global operator new.
+ * @return True if installed; false if the current backend has already served an allocation, whose memory must not be
+ *         released to another backend.
+ * @remark Install the backend at startup before any other thread uses the library.
+ */
+ES_API(CPPESSENCE) bool es_set_allocator_backend(const es_allocator_backend* backend) noexcept;
+
+/**
+ * @brief Gets the built-in size-class allocator, which serves small allocations from per-thread caches of
+ *        fixed-size blocks and falls back to the global operator new for large or over-aligned ones.
+ * @return The backend.
+ */
+ES_API(CPPESSENCE) const es_allocator_backend* es_get_size_class_allocator_backend() noexcept;
+
+/**
+ * @brief Gets the backend which maps large allocations to their own pages backed by huge pages where supported.
+ * @return The backend.
+ * @remark See essence::memory::get_huge_page_resource.
+ */
+ES_API(CPPESSENCE) const es_allocator_backend* es_get_huge_page_allocator_backend() noexcept;
+
+/**
+ * @brief Gets the backend which maps large allocations to their own pages on the NUMA node of the allocating thread.
+ * @return The backend.
+ * @remark See essence::memory::get_numa_local_resource.
+ */
+ES_API(CPPESSENCE) const es_allocator_backend* es_get_numa_local_allocator_backend() noexcept;
 }
 
 namespace essence::abi {
+    /**
+     * @brief Makes a backend forwarding to a PMR resource, e.g. to serve the ABI containers of a short-lived process
+     *        from an arena.
+     * @param resource The resource, which must outlive every allocation served through the backend.
+     * @return The backend, which must live as long as it is installed.
+     */
+    [[nodiscard]] ES_API(CPPESSENCE) es_allocator_backend make_allocator_backend(
+        std::pmr::memory_resource& resource) noexcept;
+
     struct uniform_allocator_base {
         ES_API(CPPESSENCE) uniform_allocator_base() noexcept;
         ES_API(CPPESSENCE) uniform_allocator_base(const uniform_allocator_base&) noexcept;
@@ -29,6 +29,12 @@
 #include "../zstring_view.hpp"
 #include "common_types.hpp"
 
+#ifdef CPP_ESSENCE_HAS_THREADS
+#include "../io/async_file_io.hpp"
+
+#include <future>
+#endif
+
 #include <cstddef>
 #include <optional>
 #include <span>
@@ -126,6 +132,19 @@ namespace essence::crypto {
      */
     ES_API(CPPESSENCE) abi::string make_file_digest(digest_mode mode, std::string_view path);
 
+#ifdef CPP_ESSENCE_HAS_THREADS
+    /**
+     * @brief Calculates the hashes of files asynchronously, reading each file chunk by chunk.
+     * @param mode The hashing mode.
+     * @param paths The file paths.
+     * @param engine The asynchronous file engine.
+     * @return The futures of the hash codes, in the order of the paths.
+     */
+    ES_API(CPPESSENCE)
+    abi::vector<std::future<abi::string>> make_file_digests_async(digest_mode mode,
+        std::span<const std::string_view> paths, const io::async_file_engine& engine = io::get_async_file_engine());
+#endif
+
     template <byte_like_contiguous_range Range>
     abi::string hex_encode(Range&& range, std::optional<char> delimiter = {}) {
         return hex_encode(as_const_byte_span(range), delimiter);
@@ -26,6 +26,13 @@
 #include "abstract/image_header_extractor.hpp"
 #include "image_general_header.hpp"
 
+#ifdef CPP_ESSENCE_HAS_THREADS
+#include "../abi/vector.hpp"
+#include "../io/async_file_io.hpp"
+
+#include <future>
+#endif
+
 #include <cstddef>
 #include <iosfwd>
 #include <memory>
@@ -82,6 +89,19 @@ namespace essence::imaging {
          */
         [[nodiscard]] ES_API(CPPESSENCE) std::optional<image_general_header> extract_header(std::span<const std::byte> buffer) const;
 
+#ifdef CPP_ESSENCE_HAS_THREADS
+        /**
+         * @brief Extracts the general image headers from files asynchronously.
+         * @param paths The file paths.
+         * @param engine The asynchronous file engine.
+         * @return The futures of the image headers, in the order of the paths. The prober must outlive the completion
+         *         of the futures.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) abi::vector<std::future<std::optional<image_general_header>>>
+            extract_header_async(std::span<const std::string_view> paths,
+                const io::async_file_engine& engine = io::get_async_file_engine()) const;
+#endif
+
     private:
         class impl;
 
@@ -22,10 +22,20 @@
 
 #pragma once
 
+#include "../../abi/vector.hpp"
+#include "../../char8_t_remediation.hpp"
+#include "../../error_extensions.hpp"
+#include "../common_types.hpp"
+
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ios>
 #include <istream>
 #include <memory>
 #include <ostream>
+#include <span>
 #include <string_view>
 #include <type_traits>
 #include <utility>
@@ -100,6 +110,63 @@ namespace essence::io::abstract {
             return wrapper_->open_write(path, mode);
         }
 
+        /**
+         * @brief Reads the whole content of a file.
+         * @param path The path of the file.
+         * @return The content of the file.
+         */
+        [[nodiscard]] abi::vector<std::byte> read_all(std::string_view path) const {
+            return wrapper_->read_all(path);
+        }
+
+        /**
+         * @brief Reads a range of a file.
+         * @param path The path of the file.
+         * @param offset The offset in the file.
+         * @param result The output buffer, whose size is the length of the range.
+         * @return The number of bytes read, which is less than the size of the output buffer only at the end of the
+         *         file.
+         */
+        std::size_t read_range(std::string_view path, std::uint64_t offset, std::span<std::byte> result) const {
+            return wrapper_->read_range(path, offset, result);
+        }
+
+        /**
+         * @brief Replaces the content of a file, creating the file if it does not exist.
+         * @param path The path of the file.
+         * @param buffer The new content.
+         */
+        void write_all(std::string_view path, std::span<const std::byte> buffer) const {
+            wrapper_->write_all(path, buffer);
+        }
+
+        /**
+         * @brief Gets the size of a file.
+         * @param path The path of the file.
+         * @return The size of the file.
+         */
+        [[nodiscard]] std::uint64_t file_size(std::string_view path) const {
+            return wrapper_->file_size(path);
+        }
+
+        /**
+         * @brief Gets the last modification time of a file.
+         * @param path The path of the file.
+         * @return The last modification time, or the default value if the file system does not track it.
+         */
+        [[nodiscard]] std::filesystem::file_time_type last_write_time(std::string_view path) const {
+            return wrapper_->last_write_time(path);
+        }
+
+        /**
+         * @brief Lists the entries of a directory, excluding "." and "..".
+         * @param path The path of the directory.
+         * @return The entries in an unspecified order.
+         */
+        [[nodiscard]] abi::vector<directory_entry> list_directory(std::string_view path) const {
+            return wrapper_->list_directory(path);
+        }
+
     private:
         struct base {
             virtual ~base()                                                                                  = default;
@@ -109,8 +176,32 @@ namespace essence::io::abstract {
             virtual std::unique_ptr<std::iostream> open(std::string_view path, std::ios_base::openmode mode) = 0;
             virtual std::unique_ptr<std::istream> open_read(std::string_view path, std::ios_base::openmode mode)  = 0;
             virtual std::unique_ptr<std::ostream> open_write(std::string_view path, std::ios_base::openmode mode) = 0;
+            virtual abi::vector<std::byte> read_all(std::string_view path)                                        = 0;
+            virtual void write_all(std::string_view path, std::span<const std::byte> buffer)                      = 0;
+            virtual std::uint64_t file_size(std::string_view path)                                                = 0;
+            virtual std::filesystem::file_time_type last_write_time(std::string_view path)                        = 0;
+            virtual std::size_t read_range(
+                std::string_view path, std::uint64_t offset, std::span<std::byte> result) = 0;
+            virtual abi::vector<directory_entry> list_directory(std::string_view path) = 0;
         };
 
+        /**
+         * @brief Gets the size of a stream from its current position to the end.
+         * @param stream The stream.
+         * @return The size of the stream.
+         */
+        static std::uint64_t get_stream_size(std::istream& stream) {
+            const auto begin = stream.tellg();
+
+            stream.seekg(0, std::ios_base::end);
+
+            const auto end = stream.tellg();
+
+            stream.seekg(begin);
+
+            return static_cast<std::uint64_t>(end - begin);
+        }
+
         template <typename T>
         class wrapper final : public base {
         public:
@@ -141,6 +232,76 @@ namespace essence::io::abstract {
                 return value_.open_write(path, mode);
             }
 
+            // The backends may implement the following operations natively; otherwise the streams are used instead.
+            abi::vector<std::byte> read_all(std::string_view path) override {
+                if constexpr (requires { value_.read_all(path); }) {
+                    return value_.read_all(path);
+                } else {
+                    const auto stream = value_.open_read(path, std::ios_base::in | std::ios_base::binary);
+                    abi::vector<std::byte> result(static_cast<std::size_t>(get_stream_size(*stream)));
+
+                    stream->read(reinterpret_cast<char*>(result.data()), static_cast<std::streamsize>(result.size()));
+                    result.resize(static_cast<std::size_t>(stream->gcount()));
+
+                    return result;
+                }
+            }
+
+            std::size_t read_range(std::string_view path, std::uint64_t offset, std::span<std::byte> result) override {
+                if constexpr (requires { value_.read_range(path, offset, result); }) {
+                    return value_.read_range(path, offset, result);
+                } else {
+                    const auto stream = value_.open_read(path, std::ios_base::in | std::ios_base::binary);
+
+                    if (offset >= get_stream_size(*stream)) {
+                        return 0;
+                    }
+
+                    stream->seekg(static_cast<std::streamoff>(offset));
+                    stream->read(reinterpret_cast<char*>(result.data()), static_cast<std::streamsize>(result.size()));
+
+                    return static_cast<std::size_t>(stream->gcount());
+                }
+            }
+
+            void write_all(std::string_view path, std::span<const std::byte> buffer) override {
+                if constexpr (requires { value_.write_all(path, buffer); }) {
+                    value_.write_all(path, buffer);
+                } else {
+                    const auto stream = value_.open_write(
+                        path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+
+                    stream->write(
+                        reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+                    stream->flush();
+                }
+            }
+
+            std::uint64_t file_size(std::string_view path) override {
+                if constexpr (requires { value_.file_size(path); }) {
+                    return value_.file_size(path);
+                } else {
+                    return get_stream_size(*value_.open_read(path, std::ios_base::in | std::ios_base::binary));
+                }
+            }
+
+            std::filesystem::file_time_type last_write_time(std::string_view path) override {
+                if constexpr (requires { value_.last_write_time(path); }) {
+                    return value_.last_write_time(path);
+                } else {
+                    return {};
+                }
+            }
+
+            abi::vector<directory_entry> list_directory(std::string_view path) override {
+                if constexpr (requires { value_.list_directory(path); }) {
+                    return value_.list_directory(path);
+                } else {
+                    throw source_code_aware_runtime_error{
+                        U8("Path"), path, U8("Message"), U8("The file system does not support listing directories.")};
+                }
+            }
+
         private:
             T value_;
         };
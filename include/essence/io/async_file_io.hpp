@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/vector.hpp"
+#include "../compat.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <ios>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace essence::io {
+    /**
+     * @brief The backend of an asynchronous file engine.
+     */
+    enum class async_io_backend {
+        /**
+         * @brief Uses io_uring if the kernel supports it, otherwise a thread pool.
+         */
+        automatic,
+
+        /**
+         * @brief Uses io_uring, which is only available on Linux.
+         */
+        io_uring,
+
+        /**
+         * @brief Uses a pool of threads performing blocking positional I/O.
+         */
+        thread_pool,
+    };
+
+    /**
+     * @brief The options of an asynchronous file engine.
+     */
+    struct async_io_options {
+        /**
+         * @brief The backend.
+         */
+        async_io_backend backend{async_io_backend::automatic};
+
+        /**
+         * @brief The maximum number of operations in flight; further operations are queued.
+         */
+        std::uint32_t queue_depth{64};
+
+        /**
+         * @brief The number of threads of the thread-pool backend, or zero to use the hardware concurrency.
+         */
+        std::uint32_t worker_count{};
+    };
+
+    /**
+     * @brief A request to read a range of a file.
+     */
+    struct async_read_request {
+        /**
+         * @brief Indicates that the range extends to the end of the file.
+         */
+        static constexpr std::size_t to_end = std::numeric_limits<std::size_t>::max();
+
+        /**
+         * @brief The path of the file.
+         */
+        std::string_view path{};
+
+        /**
+         * @brief The offset of the range, relative to the origin.
+         */
+        std::uint64_t offset{};
+
+        /**
+         * @brief The maximum length of the range, which is truncated at the end of the file.
+         */
+        std::size_t length{to_end};
+
+        /**
+         * @brief The origin of the offset, either std::ios_base::beg or std::ios_base::end. In the latter case the
+         *        range ends offset bytes before the end of the file.
+         */
+        std::ios_base::seekdir origin{std::ios_base::beg};
+    };
+
+    /**
+     * @brief The result of a read.
+     */
+    struct async_read_result {
+        /**
+         * @brief The bytes read.
+         */
+        abi::vector<std::byte> data;
+
+        /**
+         * @brief The size of the whole file when the read was submitted.
+         */
+        std::uint64_t file_size{};
+    };
+
+    /**
+     * @brief The callback of a read, which receives either the result or the error.
+     */
+    using async_read_callback = std::function<void(async_read_result result, std::exception_ptr error)>;
+
+    /**
+     * @brief The callback of a write, which receives the error if any.
+     */
+    using async_write_callback = std::function<void(std::exception_ptr error)>;
+
+    /**
+     * @brief A file opened once for asynchronous reads, which are issued against the opened file instead of reopening
+     *        the path. A file replaced on the path meanwhile is not observed.
+     * @remark Operations in flight keep the file open after this object is destroyed.
+     */
+    class async_read_file {
+    public:
+        /**
+         * @brief Opens a file for reading.
+         * @param path The path of the file.
+         */
+        ES_API(CPPESSENCE) explicit async_read_file(std::string_view path);
+
+        ES_API(CPPESSENCE) async_read_file(async_read_file&&) noexcept;
+        ES_API(CPPESSENCE) ~async_read_file();
+        ES_API(CPPESSENCE) async_read_file& operator=(async_read_file&&) noexcept;
+
+        /**
+         * @brief Gets the current size of the file.
+         * @return The size.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::uint64_t size() const;
+
+    private:
+        friend class async_file_engine;
+
+        class impl;
+
+        std::unique_ptr<impl> impl_;
+    };
+
+    /**
+     * @brief Reads and writes files asynchronously, on io_uring where available and on a thread pool otherwise.
+     * @remark Callbacks are invoked on an internal thread and should not block; they may submit further operations.
+     *         If a file cannot be opened or the operation is refused by the kernel, the callback is invoked on the
+     *         calling thread instead. The destructor waits for all operations to complete.
+     */
+    class async_file_engine {
+    public:
+        /**
+         * @brief Creates an instance.
+         * @param options The options.
+         */
+        ES_API(CPPESSENCE) explicit async_file_engine(const async_io_options& options = {});
+
+        ES_API(CPPESSENCE) async_file_engine(async_file_engine&&) noexcept;
+        ES_API(CPPESSENCE) ~async_file_engine();
+        ES_API(CPPESSENCE) async_file_engine& operator=(async_file_engine&&) noexcept;
+
+        /**
+         * @brief Gets the backend actually in use.
+         * @return Either async_io_backend::io_uring or async_io_backend::thread_pool.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) async_io_backend backend() const noexcept;
+
+        /**
+         * @brief Submits a read.
+         * @param request The request.
+         * @param callback The callback.
+         */
+        ES_API(CPPESSENCE) void read(const async_read_request& request, async_read_callback callback) const;
+
+        /**
+         * @brief Submits a read of an opened file.
+         * @param file The opened file.
+         * @param request The request, whose path is ignored.
+         * @param callback The callback.
+         */
+        ES_API(CPPESSENCE)
+        void read(const async_read_file& file, const async_read_request& request, async_read_callback callback) const;
+
+        /**
+         * @brief Submits a batch of reads.
+         * @param requests The requests.
+         * @param callback The callback, which receives the index of the request as well.
+         */
+        ES_API(CPPESSENCE)
+        void read(std::span<const async_read_request> requests,
+            const std::function<void(std::size_t index, async_read_result result, std::exception_ptr error)>& callback)
+            const;
+
+        /**
+         * @brief Submits a read.
+         * @param request The request.
+         * @return The future of the result.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::future<async_read_result> read(const async_read_request& request) const;
+
+        /**
+         * @brief Submits a write which replaces the content of a file, creating the file if it does not exist.
+         * @param path The path of the file.
+         * @param buffer The new content, which is copied before returning.
+         * @param callback The callback.
+         */
+        ES_API(CPPESSENCE)
+        void write(std::string_view path, std::span<const std::byte> buffer, async_write_callback callback) const;
+
+        /**
+         * @brief Submits a write which replaces the content of a file, creating the file if it does not exist.
+         * @param path The path of the file.
+         * @param buffer The new content, which is copied before returning.
+         * @return The future of the completion.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::future<void> write(
+            std::string_view path, std::span<const std::byte> buffer) const;
+
+    private:
+        class impl;
+
+        std::unique_ptr<impl> impl_;
+    };
+
+    /**
+     * @brief Gets the shared asynchronous file engine with the default options.
+     * @return The asynchronous file engine.
+     */
+    ES_API(CPPESSENCE) const async_file_engine& get_async_file_engine();
+} // namespace essence::io
@@ -25,13 +25,37 @@
 #include "../compat.hpp"
 #include "abstract/bitstream_type_hint.hpp"
 
+#ifdef CPP_ESSENCE_HAS_THREADS
+#include "../abi/vector.hpp"
+#include "async_file_io.hpp"
+
+#include <future>
+#endif
+
 #include <cstddef>
+#include <exception>
 #include <iosfwd>
 #include <memory>
 #include <optional>
 #include <span>
+#include <string_view>
 
 namespace essence::io {
+    /**
+     * @brief The result of identifying the type of a file in a batch.
+     */
+    struct bitstream_identification {
+        /**
+         * @brief The corresponding type hint, or std::nullopt if not found.
+         */
+        std::optional<abstract::bitstream_type_hint> hint;
+
+        /**
+         * @brief The error which occurred when reading the file, or null if succeeded.
+         */
+        std::exception_ptr error;
+    };
+
     /**
      * @brief Provides an ability to identify the exact type of bitstream.
      */
@@ -77,6 +101,30 @@ namespace essence::io {
         [[nodiscard]] ES_API(CPPESSENCE) std::optional<abstract::bitstream_type_hint> identify(
             std::span<const std::byte> buffer) const;
 
+#ifdef CPP_ESSENCE_HAS_THREADS
+        /**
+         * @brief Identifies the types of the bitstreams from files in parallel, reading only the leading and the
+         *        trailing bytes of each file.
+         * @param paths The file paths.
+         * @param worker_count The count of worker threads, or zero to use the hardware concurrency.
+         * @return The results in the order of the paths, each of which carries its own error.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) abi::vector<bitstream_identification> identify_many(
+            std::span<const std::string_view> paths, std::size_t worker_count = 0) const;
+
+        /**
+         * @brief Identifies the types of the bitstreams from files asynchronously, reading only the leading and the
+         *        trailing bytes of each file.
+         * @param paths The file paths.
+         * @param engine The asynchronous file engine.
+         * @return The futures of the corresponding type hints, in the order of the paths. The judger must outlive
+         *         the completion of the futures.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) abi::vector<std::future<std::optional<abstract::bitstream_type_hint>>>
+            identify_async(std::span<const std::string_view> paths,
+                const async_file_engine& engine = get_async_file_engine()) const;
+#endif
+
     private:
         class impl;
 
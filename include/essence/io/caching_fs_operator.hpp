@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/vector.hpp"
+#include "../compat.hpp"
+#include "abstract/virtual_fs_operator.hpp"
+#include "common_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string_view>
+
+namespace essence::io {
+    /**
+     * @brief The options of a caching file system operator.
+     */
+    struct caching_fs_options {
+        /**
+         * @brief The maximum total size in bytes of the cached file contents.
+         */
+        std::size_t capacity{64 * 1024 * 1024};
+
+        /**
+         * @brief The number of independently locked shards, which must not be zero.
+         */
+        std::size_t shard_count{16};
+
+        /**
+         * @brief Whether to compare the size and the last modification time of a file with the cached ones on every
+         *        access, which costs a metadata query but no read.
+         */
+        bool validate{true};
+    };
+
+    /**
+     * @brief The counters of a caching file system operator.
+     */
+    struct caching_fs_stats {
+        /**
+         * @brief The number of reads served from the cache.
+         */
+        std::uint64_t hits{};
+
+        /**
+         * @brief The number of reads which loaded the file from the underlying file system.
+         */
+        std::uint64_t misses{};
+
+        /**
+         * @brief The number of cached files dropped because they were stale.
+         */
+        std::uint64_t stale{};
+
+        /**
+         * @brief The number of cached files dropped to stay within the capacity.
+         */
+        std::uint64_t evictions{};
+
+        /**
+         * @brief The number of exists() and is_file() calls served from the memoized results.
+         */
+        std::uint64_t metadata_hits{};
+
+        /**
+         * @brief The total size in bytes of the cached file contents.
+         */
+        std::size_t cached_bytes{};
+    };
+
+    /**
+     * @brief A decorator of a file system operator which keeps the contents of recently read files in memory, evicting
+     *        the least recently used ones when the capacity is exceeded.
+     * @remark Copies share the same cache. Writes through the operator invalidate the affected path; changes made
+     *         elsewhere are detected by the size and the last modification time when validation is enabled, except
+     *         for the memoized results of exists() and is_file(), which require invalidate() or clear().
+     */
+    class caching_fs_operator {
+    public:
+        /**
+         * @brief Creates an instance.
+         * @param inner The underlying file system operator.
+         * @param options The caching options.
+         */
+        ES_API(CPPESSENCE)
+        explicit caching_fs_operator(abstract::virtual_fs_operator inner, const caching_fs_options& options = {});
+
+        [[nodiscard]] ES_API(CPPESSENCE) bool exists(std::string_view path) const;
+        [[nodiscard]] ES_API(CPPESSENCE) bool is_file(std::string_view path) const;
+        [[nodiscard]] ES_API(CPPESSENCE) bool is_directory(std::string_view path) const;
+
+        [[nodiscard]] ES_API(CPPESSENCE) std::unique_ptr<std::iostream> open(
+            std::string_view path, std::ios_base::openmode mode) const;
+
+        /**
+         * @brief Opens a file as a stream over its cached content.
+         * @param path The path of the file.
+         * @param mode The open mode.
+         * @return A stream to read the file.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::unique_ptr<std::istream> open_read(
+            std::string_view path, std::ios_base::openmode mode = std::ios_base::in) const;
+
+        [[nodiscard]] ES_API(CPPESSENCE) std::unique_ptr<std::ostream> open_write(
+            std::string_view path, std::ios_base::openmode mode) const;
+
+        [[nodiscard]] ES_API(CPPESSENCE) abi::vector<std::byte> read_all(std::string_view path) const;
+
+        ES_API(CPPESSENCE)
+        std::size_t read_range(std::string_view path, std::uint64_t offset, std::span<std::byte> result) const;
+
+        ES_API(CPPESSENCE) void write_all(std::string_view path, std::span<const std::byte> buffer) const;
+
+        [[nodiscard]] ES_API(CPPESSENCE) std::uint64_t file_size(std::string_view path) const;
+
+        [[nodiscard]] ES_API(CPPESSENCE) std::filesystem::file_time_type last_write_time(std::string_view path) const;
+
+        /**
+         * @brief Lists the entries of a directory, which are not cached.
+         * @param path The path of the directory.
+         * @return The entries.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) abi::vector<directory_entry> list_directory(std::string_view path) const;
+
+        /**
+         * @brief Drops the cached content and the memoized metadata of a path.
+         * @param path The path.
+         */
+        ES_API(CPPESSENCE) void invalidate(std::string_view path) const;
+
+        /**
+         * @brief Drops all cached contents and memoized metadata.
+         */
+        ES_API(CPPESSENCE) void clear() const;
+
+        /**
+         * @brief Gets the counters of the cache.
+         * @return The counters.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) caching_fs_stats stats() const;
+
+    private:
+        class impl;
+
+        std::shared_ptr<impl> impl_;
+    };
+
+    /**
+     * @brief Makes a caching file system operator.
+     * @param inner The underlying file system operator.
+     * @param options The caching options.
+     * @return The caching file system operator.
+     */
+    ES_API(CPPESSENCE)
+    abstract::virtual_fs_operator make_caching_fs_operator(
+        abstract::virtual_fs_operator inner, const caching_fs_options& options = {});
+} // namespace essence::io
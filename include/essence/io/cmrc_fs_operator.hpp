@@ -22,11 +22,16 @@
 
 #pragma once
 
+#include "../abi/vector.hpp"
 #include "../char8_t_remediation.hpp"
 #include "../error_extensions.hpp"
+#include "common_types.hpp"
 #include "spanstream.hpp"
 
+#include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <istream>
 #include <memory>
 #include <span>
@@ -75,7 +80,54 @@ namespace essence::io {
                 U8("This CMRC file is read-only and cannot be opened as std::ostream.")};
         }
 
+        [[nodiscard]] abi::vector<std::byte> read_all(std::string_view path) const {
+            const auto file = as_bytes(path);
+
+            return abi::vector<std::byte>{file.begin(), file.end()};
+        }
+
+        std::size_t read_range(std::string_view path, std::uint64_t offset, std::span<std::byte> result) const {
+            const auto file = as_bytes(path);
+
+            if (offset >= file.size()) {
+                return 0;
+            }
+
+            const auto range = file.subspan(static_cast<std::size_t>(offset)).first(
+                std::min(result.size(), file.size() - static_cast<std::size_t>(offset)));
+
+            std::ranges::copy(range, result.begin());
+
+            return range.size();
+        }
+
+        static void write_all(
+            [[maybe_unused]] std::string_view path, [[maybe_unused]] std::span<const std::byte> buffer) {
+            throw source_code_aware_runtime_error{U8("This CMRC file is read-only and cannot be written.")};
+        }
+
+        [[nodiscard]] std::uint64_t file_size(std::string_view path) const {
+            return as_bytes(path).size();
+        }
+
+        [[nodiscard]] abi::vector<directory_entry> list_directory(std::string_view path) const {
+            abi::vector<directory_entry> result;
+
+            for (auto&& item : impl_.iterate_directory(std::string{path})) {
+                result.emplace_back(directory_entry{abi::string{item.filename()},
+                    item.is_directory() ? directory_entry_type::directory : directory_entry_type::file, false});
+            }
+
+            return result;
+        }
+
     private:
+        [[nodiscard]] std::span<const std::byte> as_bytes(std::string_view path) const {
+            auto file = impl_.open(std::string{path});
+
+            return std::as_bytes(std::span{file.begin(), file.end()});
+        }
+
         T impl_;
     };
 
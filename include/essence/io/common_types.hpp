@@ -22,6 +22,10 @@
 
 #pragma once
 
+#include "../abi/string.hpp"
+
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string_view>
 
@@ -29,6 +33,45 @@ namespace essence::io {
     enum class compression_mode {
         zstd,
         zlib,
+        gzip,
+
+        /**
+         * @brief The zstd compression in a framed container, which stores incompressible blocks raw and chooses the
+         *        compression level of each block by sampling.
+         */
+        adaptive,
+    };
+
+    /**
+     * @brief The tuning options of a compresser.
+     * @remark A zero value leaves the corresponding parameter at the default of the underlying library.
+     */
+    struct compression_options {
+        /**
+         * @brief The count of worker threads to compress in parallel, or zero to compress on the calling thread.
+         */
+        std::uint32_t worker_count{};
+
+        /**
+         * @brief The size in bytes of one single job dispatched to a worker thread, which is also the size of the
+         *        independently compressed blocks in the gzip and adaptive modes.
+         */
+        std::size_t job_size{};
+
+        /**
+         * @brief Whether to enable the long-distance matching for large inputs with repetitions far apart.
+         */
+        bool long_distance_matching{};
+
+        /**
+         * @brief The base-2 logarithm of the maximum back-reference distance.
+         */
+        std::int32_t window_log{};
+
+        /**
+         * @brief The maximum size in bytes of decompressed data, or zero to be unlimited.
+         */
+        std::size_t max_decompressed_size{};
     };
 
     enum class stdio_watcher_mode {
@@ -37,4 +80,30 @@ namespace essence::io {
     };
 
     using stdio_message_handler = std::function<void(std::string_view message)>;
+
+    enum class directory_entry_type {
+        file,
+        directory,
+        other,
+    };
+
+    /**
+     * @brief An entry of a directory.
+     */
+    struct directory_entry {
+        /**
+         * @brief The name of the entry without the directory.
+         */
+        abi::string name;
+
+        /**
+         * @brief The type of the entry, which is the type of the target for a symbolic link.
+         */
+        directory_entry_type type{};
+
+        /**
+         * @brief Whether the entry is a symbolic link.
+         */
+        bool symlink{};
+    };
 } // namespace essence::io
@@ -27,6 +27,7 @@
 #include "../compat.hpp"
 #include "../range.hpp"
 #include "common_types.hpp"
+#include "compression_dictionary.hpp"
 
 #include <cstddef>
 #include <cstdint>
@@ -36,6 +37,9 @@
 namespace essence::io {
     /**
      * @brief A general compresser.
+     * @remark Each instance owns its native compression contexts, so that repeated calls reuse them without
+     *         allocation. In exchange, every call on the same instance is serialized by an internal mutex, so threads
+     *         sharing one instance no longer compress in parallel; give each thread its own instance instead.
      */
     class compresser {
     public:
@@ -45,10 +49,58 @@ namespace essence::io {
          */
         ES_API(CPPESSENCE) explicit compresser(compression_mode mode);
 
+        /**
+         * @brief Creates an instance.
+         * @param mode The compression mode.
+         * @param options The tuning options.
+         */
+        ES_API(CPPESSENCE) compresser(compression_mode mode, const compression_options& options);
+
+        /**
+         * @brief Creates an instance which compresses and decompresses with a dictionary.
+         * @param mode The compression mode.
+         * @param dictionary The dictionary shared with the other side.
+         * @param options The tuning options.
+         */
+        ES_API(CPPESSENCE) compresser(compression_mode mode, const compression_dictionary& dictionary,
+            const compression_options& options = {});
+
         ES_API(CPPESSENCE) compresser(compresser&&) noexcept;
         ES_API(CPPESSENCE) ~compresser();
         ES_API(CPPESSENCE) compresser& operator=(compresser&&) noexcept;
 
+        /**
+         * @brief Gets the tuning options.
+         * @return The tuning options.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) const compression_options& options() const noexcept;
+
+        /**
+         * @brief Gets the maximum compressed size of a buffer in the worst case.
+         * @param size The size of the buffer.
+         * @return The maximum compressed size.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::size_t compress_bound(std::size_t size) const;
+
+        /**
+         * @brief Compresses a byte buffer into a caller-provided buffer.
+         * @param buffer The buffer.
+         * @param result The output buffer, whose size should be at least compress_bound(buffer.size()).
+         * @param level The compression level.
+         * @return The size of the compressed data.
+         */
+        ES_API(CPPESSENCE) std::size_t compress_into(
+            std::span<const std::byte> buffer, std::span<std::byte> result, std::int32_t level) const;
+
+        /**
+         * @brief Decompresses a byte buffer into a caller-provided buffer.
+         * @param buffer The buffer.
+         * @param result The output buffer.
+         * @return The size of the decompressed data.
+         */
+        ES_API(CPPESSENCE) std::size_t decompress_into(
+            std::span<const std::byte> buffer, std::span<std::byte> result) const;
+
         /**
          * @brief Compresses a byte buffer.
          * @param buffer The buffer.
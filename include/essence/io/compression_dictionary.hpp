@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/vector.hpp"
+#include "../compat.hpp"
+#include "../range.hpp"
+#include "abstract/virtual_fs_operator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <string_view>
+
+namespace essence::io {
+    /**
+     * @brief A zstd dictionary to improve the compression ratio and throughput of small messages.
+     * @remark The prepared compression and decompression states are shared between copies and can be used by
+     *         multiple compressers on multiple threads simultaneously.
+     */
+    class compression_dictionary {
+    public:
+        /**
+         * @brief The default maximum size in bytes of a trained dictionary.
+         */
+        static constexpr std::size_t default_max_size = 112640;
+
+        /**
+         * @brief Creates an instance from the content of a dictionary.
+         * @param content The content of the dictionary, either trained or raw.
+         */
+        ES_API(CPPESSENCE) explicit compression_dictionary(std::span<const std::byte> content);
+
+        ES_API(CPPESSENCE) compression_dictionary(const compression_dictionary&);
+        ES_API(CPPESSENCE) compression_dictionary(compression_dictionary&&) noexcept;
+        ES_API(CPPESSENCE) ~compression_dictionary();
+        ES_API(CPPESSENCE) compression_dictionary& operator=(const compression_dictionary&);
+        ES_API(CPPESSENCE) compression_dictionary& operator=(compression_dictionary&&) noexcept;
+
+        /**
+         * @brief Trains a dictionary from a set of samples.
+         * @param samples All samples concatenated one after another.
+         * @param sample_sizes The size of each sample.
+         * @param max_size The maximum size of the dictionary.
+         * @return The trained dictionary.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) static compression_dictionary train(std::span<const std::byte> samples,
+            std::span<const std::size_t> sample_sizes, std::size_t max_size = default_max_size);
+
+        /**
+         * @brief Loads a dictionary from a file.
+         * @param fs_operator The file system operator.
+         * @param path The path of the dictionary file.
+         * @return The dictionary.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) static compression_dictionary from_file(
+            const abstract::virtual_fs_operator& fs_operator, std::string_view path);
+
+        /**
+         * @brief Trains a dictionary from a set of samples.
+         * @tparam Range The type of the range of samples.
+         * @param samples The samples.
+         * @param max_size The maximum size of the dictionary.
+         * @return The trained dictionary.
+         */
+        template <std::ranges::input_range Range>
+            requires byte_like_contiguous_range<std::ranges::range_reference_t<Range>>
+        [[nodiscard]] static compression_dictionary train(Range&& samples, std::size_t max_size = default_max_size) {
+            abi::vector<std::byte> buffer;
+            abi::vector<std::size_t> sizes;
+
+            for (auto&& item : samples) {
+                const auto span = as_const_byte_span(item);
+
+                buffer.insert(buffer.end(), span.begin(), span.end());
+                sizes.emplace_back(span.size());
+            }
+
+            return train(buffer, sizes, max_size);
+        }
+
+        /**
+         * @brief Gets the ID of the dictionary.
+         * @return The ID of the dictionary, or zero if the content is a raw dictionary.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::uint32_t id() const noexcept;
+
+        /**
+         * @brief Gets the content of the dictionary.
+         * @return The content of the dictionary.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::span<const std::byte> content() const noexcept;
+
+        /**
+         * @brief Gets the internal blob of the prepared compression state at a compression level.
+         * @warning DO NOT USE this function unless you know what you are doing.
+         * @param level The compression level.
+         * @return The internal blob.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) void* to_compression_blob(std::int32_t level) const;
+
+        /**
+         * @brief Gets the internal blob of the prepared decompression state.
+         * @warning DO NOT USE this function unless you know what you are doing.
+         * @return The internal blob.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) void* to_decompression_blob() const noexcept;
+
+    private:
+        class impl;
+
+        std::shared_ptr<impl> impl_;
+    };
+} // namespace essence::io
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/string.hpp"
+#include "../abi/vector.hpp"
+#include "../compat.hpp"
+#include "abstract/virtual_fs_operator.hpp"
+#include "common_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace essence::io {
+    /**
+     * @brief An entry found by a directory scan.
+     */
+    struct scan_entry {
+        /**
+         * @brief The path of the entry, i.e. the root joined with the relative path by '/'.
+         */
+        abi::string path;
+
+        /**
+         * @brief The type of the entry.
+         */
+        directory_entry_type type{};
+
+        /**
+         * @brief The size of a file, which is only queried when a size filter is set or
+         *        directory_scan_options::query_size is true, and zero otherwise.
+         */
+        std::uint64_t size{};
+    };
+
+    /**
+     * @brief The options of a directory scan.
+     */
+    struct directory_scan_options {
+        /**
+         * @brief The number of worker threads, or zero to use the hardware concurrency.
+         */
+        std::uint32_t worker_count{};
+
+        /**
+         * @brief The accepted extensions of files including the dot, compared case-insensitively, or empty to accept
+         *        all files.
+         */
+        abi::vector<abi::string> extensions{};
+
+        /**
+         * @brief The minimum size in bytes of the accepted files.
+         */
+        std::uint64_t min_size{};
+
+        /**
+         * @brief The maximum size in bytes of the accepted files.
+         */
+        std::uint64_t max_size{std::numeric_limits<std::uint64_t>::max()};
+
+        /**
+         * @brief Whether to query the sizes of files without size filters.
+         */
+        bool query_size{};
+
+        /**
+         * @brief Whether to report directories besides files.
+         */
+        bool include_directories{};
+
+        /**
+         * @brief Whether to descend into symbolic links to directories, which may loop forever on cyclic links.
+         */
+        bool follow_symlinks{};
+
+        /**
+         * @brief Whether to skip the directories and files which fail to be accessed instead of stopping the scan.
+         */
+        bool skip_errors{true};
+
+        /**
+         * @brief Decides whether to descend into a directory by its path, or empty to descend into all.
+         */
+        std::function<bool(std::string_view path)> directory_filter{};
+
+        /**
+         * @brief Decides whether to report an entry which passed the other filters, or empty to report all.
+         */
+        std::function<bool(const scan_entry& entry)> filter{};
+    };
+
+    /**
+     * @brief Handles a batch of entries from one directory, and returns false to stop the scan.
+     */
+    using scan_batch_handler = std::function<bool(std::span<const scan_entry> entries)>;
+
+    /**
+     * @brief Scans a directory recursively, in which the subdirectories are distributed among the worker threads by
+     *        work stealing.
+     * @param fs_operator The file system operator, which must support list_directory().
+     * @param root The root directory.
+     * @param handler The handler of the found entries, which is invoked concurrently from the worker threads.
+     * @param options The options.
+     */
+    ES_API(CPPESSENCE)
+    void scan_directory(const abstract::virtual_fs_operator& fs_operator, std::string_view root,
+        const scan_batch_handler& handler, const directory_scan_options& options = {});
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+    /**
+     * @brief Scans a directory recursively in the background, and streams the found entries through a bounded queue,
+     *        so that the scan pauses while the consumer falls behind.
+     */
+    class directory_scanner {
+    public:
+        /**
+         * @brief The default capacity of the queue.
+         */
+        static constexpr std::size_t default_queue_capacity = 4096;
+
+        /**
+         * @brief Starts a scan.
+         * @param fs_operator The file system operator, which must support list_directory().
+         * @param root The root directory.
+         * @param options The options.
+         * @param queue_capacity The maximum number of the entries waiting to be consumed.
+         */
+        ES_API(CPPESSENCE)
+        directory_scanner(abstract::virtual_fs_operator fs_operator, std::string_view root,
+            const directory_scan_options& options = {}, std::size_t queue_capacity = default_queue_capacity);
+
+        ES_API(CPPESSENCE) directory_scanner(directory_scanner&&) noexcept;
+        ES_API(CPPESSENCE) ~directory_scanner();
+        ES_API(CPPESSENCE) directory_scanner& operator=(directory_scanner&&) noexcept;
+
+        /**
+         * @brief Waits for the next entry.
+         * @return The next entry, or std::nullopt if the scan has completed or has been cancelled.
+         * @remark The error which stopped the scan is rethrown once the queued entries are consumed.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::optional<scan_entry> next() const;
+
+        /**
+         * @brief Cancels the scan, after which next() returns std::nullopt.
+         */
+        ES_API(CPPESSENCE) void cancel() const;
+
+    private:
+        class impl;
+
+        std::unique_ptr<impl> impl_;
+    };
+#endif
+} // namespace essence::io
@@ -48,4 +48,10 @@ namespace essence::io {
      * @return The native file system operator.
      */
     ES_API(CPPESSENCE) const abstract::virtual_fs_operator& get_native_fs_operator();
+
+    /**
+     * @brief Gets the read-only file system operator which maps native files into memory.
+     * @return The memory-mapped file system operator.
+     */
+    ES_API(CPPESSENCE) const abstract::virtual_fs_operator& get_mmap_fs_operator();
 }
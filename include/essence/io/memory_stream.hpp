@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/vector.hpp"
+#include "vectorbuf.hpp"
+
+#include <cstddef>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <utility>
+
+namespace essence::io {
+    template <typename BaseStream, std::ios_base::openmode Mode>
+    class basic_memory_stream_impl : public BaseStream {
+    public:
+        explicit basic_memory_stream_impl(std::ios_base::openmode mode = Mode)
+            : BaseStream{&vectorbuf_}, vectorbuf_{mode | Mode} {}
+
+        explicit basic_memory_stream_impl(abi::vector<std::byte> buffer, std::ios_base::openmode mode = Mode)
+            : BaseStream{&vectorbuf_}, vectorbuf_{std::move(buffer), mode | Mode} {}
+
+        /**
+         * @brief Gets the size of the written data.
+         * @return The size of the written data.
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            return vectorbuf_.size();
+        }
+
+        /**
+         * @brief Gets the written data, which is invalidated by the next write.
+         * @return The written data.
+         */
+        [[nodiscard]] std::span<const typename BaseStream::char_type> span() const noexcept {
+            return vectorbuf_.span();
+        }
+
+        /**
+         * @brief Preallocates the storage to avoid reallocations while writing.
+         * @param capacity The capacity.
+         */
+        void reserve(std::size_t capacity) {
+            vectorbuf_.reserve(capacity);
+        }
+
+        /**
+         * @brief Releases the written data without copying, after which the stream is empty.
+         * @return The written data.
+         */
+        [[nodiscard]] abi::vector<std::byte> release() noexcept {
+            return vectorbuf_.release();
+        }
+
+    protected:
+        basic_vectorbuf<typename BaseStream::char_type, typename BaseStream::traits_type> vectorbuf_;
+    };
+
+    template <typename CharT, typename Traits = std::char_traits<CharT>>
+    using basic_memory_istream = basic_memory_stream_impl<std::basic_istream<CharT, Traits>, std::ios_base::in>;
+
+    template <typename CharT, typename Traits = std::char_traits<CharT>>
+    using basic_memory_ostream = basic_memory_stream_impl<std::basic_ostream<CharT, Traits>, std::ios_base::out>;
+
+    template <typename CharT, typename Traits = std::char_traits<CharT>>
+    using basic_memory_stream =
+        basic_memory_stream_impl<std::basic_iostream<CharT, Traits>, std::ios_base::in | std::ios_base::out>;
+
+    using memory_istream = basic_memory_istream<char>;
+    using memory_ostream = basic_memory_ostream<char>;
+    using memory_stream  = basic_memory_stream<char>;
+} // namespace essence::io
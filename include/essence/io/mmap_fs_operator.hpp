@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/vector.hpp"
+#include "../compat.hpp"
+#include "common_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string_view>
+
+namespace essence::io {
+    /**
+     * @brief A reference-counted read-only view of the content of a file, which is either mapped into memory or read
+     *        into a private buffer.
+     * @remark The content stays valid as long as any copy of the view is alive.
+     */
+    class mapped_buffer {
+    public:
+        mapped_buffer() noexcept = default;
+
+        /**
+         * @brief Gets the content.
+         * @return The content.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::span<const std::byte> span() const noexcept;
+
+        /**
+         * @brief Gets the pointer to the content.
+         * @return The pointer to the content.
+         */
+        [[nodiscard]] const std::byte* data() const noexcept {
+            return span().data();
+        }
+
+        /**
+         * @brief Gets the size of the content.
+         * @return The size of the content.
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            return span().size();
+        }
+
+        /**
+         * @brief Checks whether the content is empty.
+         * @return True if the content is empty; otherwise false.
+         */
+        [[nodiscard]] bool empty() const noexcept {
+            return span().empty();
+        }
+
+        operator std::span<const std::byte>() const noexcept { // NOLINT(*-explicit-constructor)
+            return span();
+        }
+
+    private:
+        friend class mmap_fs_operator;
+
+        class impl;
+
+        explicit mapped_buffer(std::shared_ptr<const impl> impl) noexcept;
+
+        std::shared_ptr<const impl> impl_;
+    };
+
+    /**
+     * @brief A read-only file system operator on the native file system, which maps files into memory instead of
+     *        copying them through the buffers of file streams.
+     */
+    class mmap_fs_operator {
+    public:
+        /**
+         * @brief The default size in bytes below which files are read directly rather than mapped.
+         */
+        static constexpr std::size_t default_small_file_threshold = 16 * 1024;
+
+        /**
+         * @brief Creates an instance.
+         * @param small_file_threshold The size in bytes below which files are read directly, since mapping costs more
+         *                             than copying for small files.
+         */
+        ES_API(CPPESSENCE) explicit mmap_fs_operator(std::size_t small_file_threshold = default_small_file_threshold);
+
+        [[nodiscard]] ES_API(CPPESSENCE) static bool exists(std::string_view path) noexcept;
+        [[nodiscard]] ES_API(CPPESSENCE) static bool is_file(std::string_view path) noexcept;
+        [[nodiscard]] ES_API(CPPESSENCE) static bool is_directory(std::string_view path) noexcept;
+
+        [[nodiscard]] ES_API(CPPESSENCE) static std::unique_ptr<std::iostream> open(
+            std::string_view path, std::ios_base::openmode mode);
+
+        /**
+         * @brief Opens a file as a stream over its mapped content.
+         * @param path The path of the file.
+         * @param mode The open mode.
+         * @return A stream to read the file.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::unique_ptr<std::istream> open_read(
+            std::string_view path, std::ios_base::openmode mode = std::ios_base::in) const;
+
+        [[nodiscard]] ES_API(CPPESSENCE) static std::unique_ptr<std::ostream> open_write(
+            std::string_view path, std::ios_base::openmode mode);
+
+        /**
+         * @brief Maps the content of a file into memory.
+         * @param path The path of the file.
+         * @return The view of the content.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) mapped_buffer map_read(std::string_view path) const;
+
+        [[nodiscard]] ES_API(CPPESSENCE) static abi::vector<std::byte> read_all(std::string_view path);
+
+        ES_API(CPPESSENCE)
+        static std::size_t read_range(std::string_view path, std::uint64_t offset, std::span<std::byte> result);
+
+        ES_API(CPPESSENCE) static void write_all(std::string_view path, std::span<const std::byte> buffer);
+
+        [[nodiscard]] ES_API(CPPESSENCE) static std::uint64_t file_size(std::string_view path);
+
+        [[nodiscard]] ES_API(CPPESSENCE) static std::filesystem::file_time_type last_write_time(
+            std::string_view path);
+
+        [[nodiscard]] ES_API(CPPESSENCE) static abi::vector<directory_entry> list_directory(std::string_view path);
+
+    private:
+        std::size_t small_file_threshold_;
+    };
+} // namespace essence::io
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../compat.hpp"
+#include "common_types.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace essence::io {
+    /**
+     * @brief A complete line received from a watched descriptor.
+     */
+    struct stdio_line {
+        /**
+         * @brief The descriptor the line was written to, i.e. the descriptor of stdout or stderr for the redirected
+         *        standard streams.
+         */
+        std::int32_t source{};
+
+        /**
+         * @brief The time when the end of the line was received.
+         */
+        std::chrono::system_clock::time_point timestamp;
+
+        /**
+         * @brief The content of the line without the line break, which is only valid during the callback.
+         */
+        std::string_view text;
+    };
+
+    using stdio_lines_handler = std::function<void(std::span<const stdio_line> lines)>;
+
+    /**
+     * @brief The options of a multiplexed stdio watcher.
+     */
+    struct multiplexed_stdio_options {
+        /**
+         * @brief The requested capacity in bytes of the pipes of the redirected standard streams, which is capped by
+         *        the system limit. Zero keeps the default capacity.
+         */
+        std::size_t pipe_size{1024 * 1024};
+
+        /**
+         * @brief The size in bytes beyond which a line is delivered in pieces, or zero for no limit.
+         */
+        std::size_t max_line_size{64 * 1024};
+    };
+
+    /**
+     * @brief Watches stdout, stderr and arbitrary readable descriptors from one single thread, reassembles the data
+     *        into complete lines and delivers all lines received in one wakeup in a single callback.
+     * @remark Only POSIX systems are supported, on which epoll is used on Linux and poll elsewhere. The descriptors to
+     *         watch must be added while the watcher is stopped.
+     */
+    class multiplexed_stdio_watcher {
+    public:
+        /**
+         * @brief Creates an instance.
+         * @param options The options.
+         */
+        ES_API(CPPESSENCE) explicit multiplexed_stdio_watcher(const multiplexed_stdio_options& options = {});
+
+        ES_API(CPPESSENCE) multiplexed_stdio_watcher(multiplexed_stdio_watcher&&) noexcept;
+        ES_API(CPPESSENCE) ~multiplexed_stdio_watcher();
+        ES_API(CPPESSENCE) multiplexed_stdio_watcher& operator=(multiplexed_stdio_watcher&&) noexcept;
+
+        /**
+         * @brief Redirects a standard stream into a pipe to watch when started.
+         * @param mode The standard stream.
+         */
+        ES_API(CPPESSENCE) void watch(stdio_watcher_mode mode) const;
+
+        /**
+         * @brief Watches a readable descriptor owned by the caller, e.g. the read end of a pipe from a child process.
+         * @param descriptor The descriptor.
+         */
+        ES_API(CPPESSENCE) void watch(std::int32_t descriptor) const;
+
+        /**
+         * @brief Starts watching.
+         */
+        ES_API(CPPESSENCE) void start() const;
+
+        /**
+         * @brief Restores the standard streams, delivers the remaining data and stops watching.
+         */
+        ES_API(CPPESSENCE) void stop() const;
+
+        /**
+         * @brief Adds a handler of the lines.
+         * @param handler The handler.
+         */
+        ES_API(CPPESSENCE) void on_lines(const stdio_lines_handler& handler) const;
+
+    private:
+        class impl;
+
+        std::unique_ptr<impl> impl_;
+    };
+} // namespace essence::io
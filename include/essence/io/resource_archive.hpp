@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/vector.hpp"
+#include "../compat.hpp"
+#include "abstract/virtual_fs_operator.hpp"
+#include "common_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string_view>
+
+namespace essence::io {
+    /**
+     * @brief The options of a resource archive writer.
+     */
+    struct resource_archive_writer_options {
+        /**
+         * @brief The zstd compression level of the entries.
+         */
+        std::int32_t level{19};
+
+        /**
+         * @brief Whether to compress the entries. Entries which do not shrink are stored as they are anyway.
+         */
+        bool compress{true};
+    };
+
+    /**
+     * @brief Packs files into a resource archive, which consists of a header, an index of the paths sorted in
+     *        byte order, and the entries aligned at 4 KiB boundaries, each of which is either compressed by zstd or
+     *        stored as it is.
+     * @remark The paths in the archive use '/' as the separator and have no leading separator.
+     */
+    class resource_archive_writer {
+    public:
+        /**
+         * @brief Creates an instance.
+         * @param options The options.
+         */
+        ES_API(CPPESSENCE) explicit resource_archive_writer(const resource_archive_writer_options& options = {});
+
+        ES_API(CPPESSENCE) resource_archive_writer(resource_archive_writer&&) noexcept;
+        ES_API(CPPESSENCE) ~resource_archive_writer();
+        ES_API(CPPESSENCE) resource_archive_writer& operator=(resource_archive_writer&&) noexcept;
+
+        /**
+         * @brief Gets the number of the added entries.
+         * @return The number of the entries.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::size_t entry_count() const noexcept;
+
+        /**
+         * @brief Adds an entry.
+         * @param path The path in the archive, which must be unique.
+         * @param content The content.
+         */
+        ES_API(CPPESSENCE) void add(std::string_view path, std::span<const std::byte> content) const;
+
+        /**
+         * @brief Adds a file as an entry.
+         * @param path The path in the archive, which must be unique.
+         * @param source_path The path of the file on the native file system.
+         */
+        ES_API(CPPESSENCE) void add_file(std::string_view path, std::string_view source_path) const;
+
+        /**
+         * @brief Adds all files in a directory recursively, keeping their relative paths.
+         * @param directory The directory on the native file system.
+         * @param prefix The directory in the archive to place the files under, or empty for the root.
+         */
+        ES_API(CPPESSENCE) void add_directory(std::string_view directory, std::string_view prefix = {}) const;
+
+        /**
+         * @brief Writes the archive to a file.
+         * @param path The path of the file.
+         */
+        ES_API(CPPESSENCE) void save(std::string_view path) const;
+
+    private:
+        class impl;
+
+        std::unique_ptr<impl> impl_;
+    };
+
+    /**
+     * @brief The options of a mounted resource archive.
+     */
+    struct resource_archive_options {
+        /**
+         * @brief The maximum total size in bytes of the decompressed entries kept in memory.
+         */
+        std::size_t cache_capacity{8 * 1024 * 1024};
+    };
+
+    /**
+     * @brief A read-only file system operator over a resource archive, which maps the archive into memory, serves
+     *        stored entries without copying and decompresses compressed entries on demand into a small cache.
+     * @remark Copies share the same mapping and cache.
+     */
+    class resource_archive_fs_operator {
+    public:
+        /**
+         * @brief Mounts a resource archive.
+         * @param path The path of the archive on the native file system.
+         * @param options The options.
+         */
+        ES_API(CPPESSENCE)
+        explicit resource_archive_fs_operator(std::string_view path, const resource_archive_options& options = {});
+
+        /**
+         * @brief Gets the number of the entries.
+         * @return The number of the entries.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::size_t entry_count() const noexcept;
+
+        [[nodiscard]] ES_API(CPPESSENCE) bool exists(std::string_view path) const;
+        [[nodiscard]] ES_API(CPPESSENCE) bool is_file(std::string_view path) const;
+        [[nodiscard]] ES_API(CPPESSENCE) bool is_directory(std::string_view path) const;
+
+        [[nodiscard]] ES_API(CPPESSENCE) static std::unique_ptr<std::iostream> open(
+            std::string_view path, std::ios_base::openmode mode);
+
+        /**
+         * @brief Opens an entry as a stream over its content.
+         * @param path The path of the entry.
+         * @param mode The open mode.
+         * @return A stream to read the entry.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::unique_ptr<std::istream> open_read(
+            std::string_view path, std::ios_base::openmode mode = std::ios_base::in) const;
+
+        [[nodiscard]] ES_API(CPPESSENCE) static std::unique_ptr<std::ostream> open_write(
+            std::string_view path, std::ios_base::openmode mode);
+
+        [[nodiscard]] ES_API(CPPESSENCE) abi::vector<std::byte> read_all(std::string_view path) const;
+
+        ES_API(CPPESSENCE)
+        std::size_t read_range(std::string_view path, std::uint64_t offset, std::span<std::byte> result) const;
+
+        ES_API(CPPESSENCE) static void write_all(std::string_view path, std::span<const std::byte> buffer);
+
+        [[nodiscard]] ES_API(CPPESSENCE) std::uint64_t file_size(std::string_view path) const;
+
+        /**
+         * @brief Gets the last modification time of an entry, which is that of the archive.
+         * @param path The path of the entry.
+         * @return The last modification time.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::filesystem::file_time_type last_write_time(std::string_view path) const;
+
+        /**
+         * @brief Lists the entries of a directory, which is implied by the paths of the entries under it.
+         * @param path The path of the directory.
+         * @return The entries in byte order of the names.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) abi::vector<directory_entry> list_directory(std::string_view path) const;
+
+    private:
+        class impl;
+
+        std::shared_ptr<impl> impl_;
+    };
+
+    /**
+     * @brief Mounts a resource archive as a file system operator.
+     * @param path The path of the archive on the native file system.
+     * @param options The options.
+     * @return The file system operator.
+     */
+    ES_API(CPPESSENCE)
+    abstract::virtual_fs_operator make_resource_archive_fs_operator(
+        std::string_view path, const resource_archive_options& options = {});
+} // namespace essence::io
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/vector.hpp"
+#include "../compat.hpp"
+#include "../range.hpp"
+#include "abstract/virtual_fs_operator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace essence::io {
+    /**
+     * @brief The options of the seekable zstd format.
+     */
+    struct seekable_compression_options {
+        /**
+         * @brief The uncompressed size of each independent frame, which must not exceed 1 GiB.
+         */
+        std::size_t block_size{1024 * 1024};
+
+        /**
+         * @brief The number of threads to compress the frames, or zero to use the calling thread.
+         */
+        std::uint32_t worker_count{};
+    };
+
+    /**
+     * @brief Compresses a byte buffer into the seekable zstd format.
+     * @param buffer The buffer.
+     * @param level The compression level.
+     * @param options The seekable options.
+     * @return The compressed data, which consists of independent zstd frames followed by a seek table in a skippable
+     *         frame. Any zstd decoder can decompress it as a whole.
+     */
+    ES_API(CPPESSENCE)
+    abi::vector<std::byte> compress_seekable(
+        std::span<const std::byte> buffer, std::int32_t level, const seekable_compression_options& options = {});
+
+    /**
+     * @brief Compresses a byte buffer into the seekable zstd format.
+     * @tparam Range The type of the range.
+     * @param range The range.
+     * @param level The compression level.
+     * @param options The seekable options.
+     * @return The compressed data.
+     */
+    template <byte_like_contiguous_range Range>
+    abi::vector<std::byte> compress_seekable(
+        Range&& range, std::int32_t level, const seekable_compression_options& options = {}) {
+        return compress_seekable(as_const_byte_span(range), level, options);
+    }
+
+    /**
+     * @brief Decompresses arbitrary ranges of data in the seekable zstd format, only touching the frames that overlap
+     *        the requested range.
+     * @remark Calls on the same instance are serialized.
+     */
+    class seekable_decompresser {
+    public:
+        /**
+         * @brief Creates an instance over a memory buffer.
+         * @param buffer The compressed data, which must outlive the instance.
+         */
+        ES_API(CPPESSENCE) explicit seekable_decompresser(std::span<const std::byte> buffer);
+
+        /**
+         * @brief Creates an instance over a file.
+         * @param fs_operator The file system operator.
+         * @param path The path of the file.
+         */
+        ES_API(CPPESSENCE)
+        seekable_decompresser(const abstract::virtual_fs_operator& fs_operator, std::string_view path);
+
+        ES_API(CPPESSENCE) seekable_decompresser(seekable_decompresser&&) noexcept;
+        ES_API(CPPESSENCE) ~seekable_decompresser();
+        ES_API(CPPESSENCE) seekable_decompresser& operator=(seekable_decompresser&&) noexcept;
+
+        /**
+         * @brief Gets the total size of the decompressed data.
+         * @return The total size.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::uint64_t size() const noexcept;
+
+        /**
+         * @brief Gets the number of the frames.
+         * @return The number of the frames.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) std::size_t frame_count() const noexcept;
+
+        /**
+         * @brief Decompresses a range of the data.
+         * @param offset The offset in the decompressed data.
+         * @param length The length of the range, which is truncated at the end of the data.
+         * @param worker_count The number of threads to decompress the frames, or zero to use the calling thread.
+         * @return The decompressed range.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) abi::vector<std::byte> read_range(
+            std::uint64_t offset, std::size_t length, std::uint32_t worker_count = 0) const;
+
+        /**
+         * @brief Decompresses a range of the data into a caller-provided buffer.
+         * @param offset The offset in the decompressed data.
+         * @param result The output buffer, whose size is the length of the range.
+         * @param worker_count The number of threads to decompress the frames, or zero to use the calling thread.
+         * @return The number of bytes written, which is less than the size of the output buffer only at the end of
+         *         the data.
+         */
+        ES_API(CPPESSENCE)
+        std::size_t read_range_into(
+            std::uint64_t offset, std::span<std::byte> result, std::uint32_t worker_count = 0) const;
+
+    private:
+        class impl;
+
+        std::unique_ptr<impl> impl_;
+    };
+} // namespace essence::io
@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <limits>
+#include <span>
+#include <streambuf>
+#include <utility>
+
+namespace essence::io {
+    /**
+     * @brief A stream buffer over a contiguous byte vector, which grows geometrically when written and can release
+     *        the written data without copying.
+     * @tparam CharT The character type, which must be of the size of a byte.
+     * @tparam Traits The traits of the character type.
+     */
+    template <typename CharT, typename Traits = std::char_traits<CharT>>
+    class basic_vectorbuf : public std::basic_streambuf<CharT, Traits> {
+    public:
+        static_assert(sizeof(CharT) == sizeof(std::byte), "The character type must be of the size of a byte.");
+
+        using char_type   = CharT;
+        using traits_type = Traits;
+        using int_type    = typename Traits::int_type;
+        using pos_type    = typename Traits::pos_type;
+        using off_type    = typename Traits::off_type;
+
+        /**
+         * @brief The capacity of the first allocation.
+         */
+        static constexpr std::size_t min_capacity = 256;
+
+        explicit basic_vectorbuf(std::ios_base::openmode mode = std::ios_base::in | std::ios_base::out) noexcept
+            : mode_{mode} {}
+
+        /**
+         * @brief Creates an instance over existing data.
+         * @param buffer The data, which becomes the initial content.
+         * @param mode The open mode. With std::ios_base::ate, writing starts at the end of the data.
+         */
+        explicit basic_vectorbuf(
+            abi::vector<std::byte> buffer, std::ios_base::openmode mode = std::ios_base::in | std::ios_base::out)
+            : mode_{mode}, buffer_{std::move(buffer)}, size_{buffer_.size()} {
+            reset_areas((mode_ & std::ios_base::ate) == std::ios_base::ate ? size_ : 0, 0);
+        }
+
+        basic_vectorbuf(const basic_vectorbuf&) = delete;
+
+        basic_vectorbuf(basic_vectorbuf&& other) noexcept
+            : std::basic_streambuf<CharT, Traits>{}, mode_{other.mode_} {
+            swap(other);
+        }
+
+        basic_vectorbuf& operator=(const basic_vectorbuf&) = delete;
+
+        basic_vectorbuf& operator=(basic_vectorbuf&& other) noexcept {
+            if (this != &other) {
+                basic_vectorbuf{std::move(other)}.swap(*this);
+            }
+
+            return *this;
+        }
+
+        void swap(basic_vectorbuf& other) noexcept {
+            // The positions are relative since the pointers of the areas are swapped along with the storage.
+            const auto put       = put_position();
+            const auto get       = get_position();
+            const auto other_put = other.put_position();
+            const auto other_get = other.get_position();
+
+            size_       = high_water_mark();
+            other.size_ = other.high_water_mark();
+
+            std::swap(mode_, other.mode_);
+            std::swap(buffer_, other.buffer_);
+            std::swap(size_, other.size_);
+
+            reset_areas(other_put, other_get);
+            other.reset_areas(put, get);
+        }
+
+        /**
+         * @brief Gets the size of the written data.
+         * @return The size of the written data.
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            return high_water_mark();
+        }
+
+        /**
+         * @brief Gets the allocated capacity.
+         * @return The capacity.
+         */
+        [[nodiscard]] std::size_t capacity() const noexcept {
+            return buffer_.size();
+        }
+
+        /**
+         * @brief Gets the written data, which is invalidated by the next write.
+         * @return The written data.
+         */
+        [[nodiscard]] std::span<const CharT> span() const noexcept {
+            return std::span{reinterpret_cast<const CharT*>(buffer_.data()), high_water_mark()};
+        }
+
+        /**
+         * @brief Preallocates the storage to avoid reallocations while writing.
+         * @param capacity The capacity.
+         */
+        void reserve(std::size_t capacity) {
+            if (capacity > buffer_.size()) {
+                grow(capacity);
+            }
+        }
+
+        /**
+         * @brief Discards the written data and rewinds the positions, keeping the storage.
+         */
+        void clear() noexcept {
+            size_ = 0;
+            reset_areas(0, 0);
+        }
+
+        /**
+         * @brief Releases the written data without copying, after which the buffer is empty.
+         * @return The written data.
+         */
+        [[nodiscard]] abi::vector<std::byte> release() noexcept {
+            // Shrinking the size never reallocates.
+            buffer_.resize(high_water_mark());
+
+            auto result = std::move(buffer_);
+
+            buffer_ = {};
+            size_   = 0;
+            reset_areas(0, 0);
+
+            return result;
+        }
+
+    protected:
+        std::streamsize xsputn(const CharT* buffer, std::streamsize count) override {
+            if (!has_mode(std::ios_base::out) || count <= 0) {
+                return 0;
+            }
+
+            const auto size = static_cast<std::size_t>(count);
+
+            if (static_cast<std::size_t>(this->epptr() - this->pptr()) < size) {
+                grow(next_capacity(put_position() + size));
+            }
+
+            std::memcpy(this->pptr(), buffer, size);
+            advance_put(size);
+
+            return count;
+        }
+
+        int_type overflow(int_type ch) override {
+            if (traits_type::eq_int_type(ch, traits_type::eof())) {
+                return traits_type::not_eof(ch);
+            }
+
+            if (!has_mode(std::ios_base::out)) {
+                return traits_type::eof();
+            }
+
+            if (this->pptr() == this->epptr()) {
+                grow(next_capacity(buffer_.size() + 1));
+            }
+
+            *this->pptr() = traits_type::to_char_type(ch);
+            this->pbump(1);
+
+            return ch;
+        }
+
+        std::streamsize xsgetn(CharT* buffer, std::streamsize count) override {
+            if (!has_mode(std::ios_base::in) || count <= 0) {
+                return 0;
+            }
+
+            extend_get_area();
+
+            const auto size = std::min(static_cast<std::size_t>(count), get_available());
+
+            if (size != 0) {
+                std::memcpy(buffer, this->gptr(), size);
+                this->setg(this->eback(), this->gptr() + size, this->egptr());
+            }
+
+            return static_cast<std::streamsize>(size);
+        }
+
+        int_type underflow() override {
+            if (!has_mode(std::ios_base::in)) {
+                return traits_type::eof();
+            }
+
+            extend_get_area();
+
+            return get_available() != 0 ? traits_type::to_int_type(*this->gptr()) : traits_type::eof();
+        }
+
+        std::streamsize showmanyc() override {
+            if (!has_mode(std::ios_base::in)) {
+                return -1;
+            }
+
+            extend_get_area();
+
+            const auto available = get_available();
+
+            return available != 0 ? static_cast<std::streamsize>(available) : -1;
+        }
+
+        pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) override {
+            const auto both = std::ios_base::in | std::ios_base::out;
+
+            switch (direction) {
+            case std::ios_base::beg:
+                return seekpos(pos_type{offset}, mode);
+            case std::ios_base::cur:
+                // Moving both positions relatively is ambiguous.
+                if ((mode & both) == both) {
+                    break;
+                }
+
+                if ((mode & std::ios_base::in) == std::ios_base::in) {
+                    return seekpos(pos_type{static_cast<off_type>(get_position()) + offset}, mode);
+                }
+
+                if ((mode & std::ios_base::out) == std::ios_base::out) {
+                    return seekpos(pos_type{static_cast<off_type>(put_position()) + offset}, mode);
+                }
+
+                break;
+            case std::ios_base::end:
+                return seekpos(pos_type{static_cast<off_type>(high_water_mark()) + offset}, mode);
+            default:
+                break;
+            }
+
+            return pos_type{off_type{-1}};
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode mode) override {
+            const auto in  = has_mode(std::ios_base::in) && (mode & std::ios_base::in) == std::ios_base::in;
+            const auto out = has_mode(std::ios_base::out) && (mode & std::ios_base::out) == std::ios_base::out;
+
+            size_ = high_water_mark();
+
+            if ((!in && !out) || pos < 0 || static_cast<std::size_t>(static_cast<off_type>(pos)) > size_) {
+                return pos_type{off_type{-1}};
+            }
+
+            const auto position = static_cast<std::size_t>(static_cast<off_type>(pos));
+
+            reset_areas(out ? position : put_position(), in ? position : get_position());
+
+            return pos;
+        }
+
+    private:
+        [[nodiscard]] bool has_mode(std::ios_base::openmode mode) const noexcept {
+            return (mode_ & mode) == mode;
+        }
+
+        [[nodiscard]] CharT* data() noexcept {
+            return reinterpret_cast<CharT*>(buffer_.data());
+        }
+
+        [[nodiscard]] std::size_t put_position() const noexcept {
+            return static_cast<std::size_t>(this->pptr() - this->pbase());
+        }
+
+        [[nodiscard]] std::size_t get_position() const noexcept {
+            return static_cast<std::size_t>(this->gptr() - this->eback());
+        }
+
+        [[nodiscard]] std::size_t get_available() const noexcept {
+            return static_cast<std::size_t>(this->egptr() - this->gptr());
+        }
+
+        /**
+         * @brief Gets the end of the written data, which the put position may have moved beyond since the last
+         *        update.
+         */
+        [[nodiscard]] std::size_t high_water_mark() const noexcept {
+            return std::max(size_, put_position());
+        }
+
+        [[nodiscard]] std::size_t next_capacity(std::size_t required) const noexcept {
+            return std::max({required, buffer_.size() * 2, min_capacity});
+        }
+
+        void grow(std::size_t capacity) {
+            const auto put = put_position();
+            const auto get = get_position();
+
+            size_ = high_water_mark();
+            buffer_.resize(capacity);
+            reset_areas(put, get);
+        }
+
+        /**
+         * @brief Makes the data written after the last read available to the get area.
+         */
+        void extend_get_area() noexcept {
+            size_ = high_water_mark();
+            this->setg(this->eback(), this->gptr(), data() + size_);
+        }
+
+        void reset_areas(std::size_t put, std::size_t get) noexcept {
+            const auto base = data();
+
+            if (has_mode(std::ios_base::in)) {
+                this->setg(base, base + get, base + size_);
+            } else {
+                this->setg(nullptr, nullptr, nullptr);
+            }
+
+            if (has_mode(std::ios_base::out)) {
+                this->setp(base, base + buffer_.size());
+                advance_put(put);
+            } else {
+                this->setp(nullptr, nullptr);
+            }
+        }
+
+        void advance_put(std::size_t offset) noexcept {
+            // std::basic_streambuf::pbump only accepts an int.
+            for (constexpr std::size_t step = std::numeric_limits<std::int32_t>::max(); offset != 0;) {
+                const auto size = std::min(offset, step);
+
+                this->pbump(static_cast<std::int32_t>(size));
+                offset -= size;
+            }
+        }
+
+        std::ios_base::openmode mode_;
+        abi::vector<std::byte> buffer_;
+        std::size_t size_{};
+    };
+
+    using vectorbuf = basic_vectorbuf<char>;
+} // namespace essence::io
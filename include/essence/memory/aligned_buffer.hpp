@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../compat.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace essence::memory {
+    /**
+     * @brief The default alignment of aligned buffers, which covers a cache line and the widest SIMD registers.
+     */
+    inline constexpr std::size_t default_buffer_alignment = 64;
+
+    /**
+     * @brief The size in bytes from which aligned buffers are aligned to huge pages and advised to be backed by them.
+     */
+    inline constexpr std::size_t huge_page_threshold = 2 * 1024 * 1024;
+
+    /**
+     * @brief Requests the elements of a buffer to be default-initialized, which leaves trivial types uninitialized.
+     */
+    struct for_overwrite_t {
+        explicit for_overwrite_t() = default;
+    };
+
+    inline constexpr for_overwrite_t for_overwrite{};
+
+    /**
+     * @brief Allocates storage for an aligned buffer by the ABI allocator, and advises the kernel to back large
+     *        storage by huge pages where supported.
+     * @param size The size in bytes.
+     * @param alignment The minimum alignment, which is raised for large storage.
+     * @return The storage.
+     * @throw std::bad_alloc If the allocation fails.
+     */
+    [[nodiscard]] ES_API(CPPESSENCE) void* allocate_buffer_storage(std::size_t size, std::size_t alignment);
+
+    /**
+     * @brief Releases the storage of an aligned buffer.
+     * @param ptr The storage.
+     * @param size The size in bytes passed to allocate_buffer_storage.
+     * @param alignment The alignment passed to allocate_buffer_storage.
+     */
+    ES_API(CPPESSENCE) void deallocate_buffer_storage(void* ptr, std::size_t size, std::size_t alignment) noexcept;
+
+    /**
+     * @brief A fixed-size heap array with a guaranteed alignment, which costs a pointer and a size.
+     * @tparam T The type of the elements.
+     * @tparam Align The alignment of the first element.
+     */
+    template <typename T, std::size_t Align = std::max(alignof(T), default_buffer_alignment)>
+        requires(std::has_single_bit(Align) && Align >= alignof(T))
+    class aligned_buffer {
+    public:
+        using value_type     = T;
+        using size_type      = std::size_t;
+        using iterator       = T*;
+        using const_iterator = const T*;
+
+        static constexpr std::size_t alignment = Align;
+
+        aligned_buffer() noexcept = default;
+
+        /**
+         * @brief Creates a buffer whose elements are value-initialized.
+         * @param size The number of the elements.
+         */
+        explicit aligned_buffer(std::size_t size) : aligned_buffer{size, [](T* data, std::size_t count) {
+            std::uninitialized_value_construct_n(data, count);
+        }} {}
+
+        /**
+         * @brief Creates a buffer whose elements are default-initialized, which skips zeroing trivial types.
+         * @param size The number of the elements.
+         */
+        aligned_buffer(std::size_t size, for_overwrite_t) : aligned_buffer{size, [](T* data, std::size_t count) {
+            std::uninitialized_default_construct_n(data, count);
+        }} {}
+
+        aligned_buffer(const aligned_buffer&) = delete;
+
+        aligned_buffer(aligned_buffer&& other) noexcept
+            : data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(other.size_, 0)} {}
+
+        ~aligned_buffer() {
+            reset();
+        }
+
+        aligned_buffer& operator=(const aligned_buffer&) = delete;
+
+        aligned_buffer& operator=(aligned_buffer&& other) noexcept {
+            if (this != &other) {
+                reset();
+                data_ = std::exchange(other.data_, nullptr);
+                size_ = std::exchange(other.size_, 0);
+            }
+
+            return *this;
+        }
+
+        [[nodiscard]] T* data() noexcept {
+            return data_;
+        }
+
+        [[nodiscard]] const T* data() const noexcept {
+            return data_;
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return size_;
+        }
+
+        [[nodiscard]] std::size_t size_bytes() const noexcept {
+            return size_ * sizeof(T);
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size_ == 0;
+        }
+
+        [[nodiscard]] T& operator[](std::size_t index) noexcept {
+            return data_[index];
+        }
+
+        [[nodiscard]] const T& operator[](std::size_t index) const noexcept {
+            return data_[index];
+        }
+
+        [[nodiscard]] iterator begin() noexcept {
+            return data_;
+        }
+
+        [[nodiscard]] const_iterator begin() const noexcept {
+            return data_;
+        }
+
+        [[nodiscard]] iterator end() noexcept {
+            return data_ + size_;
+        }
+
+        [[nodiscard]] const_iterator end() const noexcept {
+            return data_ + size_;
+        }
+
+        [[nodiscard]] std::span<T> span() noexcept {
+            return std::span{data_, size_};
+        }
+
+        [[nodiscard]] std::span<const T> span() const noexcept {
+            return std::span{static_cast<const T*>(data_), size_};
+        }
+
+        operator std::span<T>() noexcept { // NOLINT(*-explicit-constructor)
+            return span();
+        }
+
+        operator std::span<const T>() const noexcept { // NOLINT(*-explicit-constructor)
+            return span();
+        }
+
+        /**
+         * @brief Destroys the elements and releases the storage.
+         */
+        void reset() noexcept {
+            if (data_) {
+                std::destroy_n(data_, size_);
+                deallocate_buffer_storage(data_, size_bytes(), Align);
+                data_ = nullptr;
+                size_ = 0;
+            }
+        }
+
+    private:
+        template <typename Initializer>
+        aligned_buffer(std::size_t size, Initializer&& initializer) {
+            if (size == 0) {
+                return;
+            }
+
+            if (size > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length{};
+            }
+
+            const auto storage = static_cast<T*>(allocate_buffer_storage(size * sizeof(T), Align));
+
+            try {
+                std::forward<Initializer>(initializer)(storage, size);
+            } catch (...) {
+                deallocate_buffer_storage(storage, size * sizeof(T), Align);
+
+                throw;
+            }
+
+            data_ = storage;
+            size_ = size;
+        }
+
+        T* data_{};
+        std::size_t size_{};
+    };
+} // namespace essence::memory
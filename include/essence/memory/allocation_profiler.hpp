@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../abi/string.hpp"
+#include "../abi/vector.hpp"
+#include "../compat.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace essence::memory {
+    /**
+     * @brief The number of buckets of the size histogram. Bucket 0 counts sizes up to 16 bytes, bucket i counts sizes
+     *        in (2^(i + 3), 2^(i + 4)], and the last bucket counts everything larger.
+     */
+    inline constexpr std::size_t allocation_histogram_size = 18;
+
+    /**
+     * @brief The maximum number of distinct tags, beyond which allocations are attributed to the default tag.
+     */
+    inline constexpr std::size_t max_allocation_tags = 64;
+
+    /**
+     * @brief The counters of the allocations attributed to one tag.
+     */
+    struct allocation_tag_stats {
+        abi::string tag;
+        std::uint64_t allocations{};
+        std::uint64_t allocated_bytes{};
+        std::uint64_t deallocations{};
+        std::uint64_t deallocated_bytes{};
+        std::array<std::uint64_t, allocation_histogram_size> histogram{};
+    };
+
+    /**
+     * @brief The counters of all threads at a point in time.
+     */
+    struct allocation_snapshot {
+        /**
+         * @brief Whether the library is compiled with allocation profiling.
+         */
+        bool supported{};
+
+        /**
+         * @brief The counters of each tag, where the first one is the default tag.
+         */
+        abi::vector<allocation_tag_stats> tags;
+
+        /**
+         * @brief Serializes the snapshot to JSON.
+         * @return The JSON string.
+         */
+        [[nodiscard]] ES_API(CPPESSENCE) abi::string to_json() const;
+    };
+
+    /**
+     * @brief Enables or disables counting the allocations of the ABI allocator at runtime.
+     * @param enabled Whether to count the allocations.
+     * @remark The counters are kept per thread, so counting takes no lock and no atomic read-modify-write. It has no
+     *         effect unless the library is compiled with ES_WITH_ALLOCATION_PROFILING.
+     */
+    ES_API(CPPESSENCE) void set_allocation_profiling(bool enabled) noexcept;
+
+    /**
+     * @brief Checks whether the allocations are being counted.
+     * @return True if counting; otherwise false.
+     */
+    [[nodiscard]] ES_API(CPPESSENCE) bool is_allocation_profiling_enabled() noexcept;
+
+    /**
+     * @brief Collects the counters of all threads, including the exited ones.
+     * @return The snapshot.
+     */
+    [[nodiscard]] ES_API(CPPESSENCE) allocation_snapshot take_allocation_snapshot();
+
+    /**
+     * @brief Sets the tag of the allocations on the current thread.
+     * @param tag The tag.
+     * @return The index of the previous tag.
+     */
+    ES_API(CPPESSENCE) std::uint32_t enter_allocation_scope(std::string_view tag) noexcept;
+
+    /**
+     * @brief Restores the tag of the allocations on the current thread.
+     * @param previous The index of the previous tag.
+     */
+    ES_API(CPPESSENCE) void leave_allocation_scope(std::uint32_t previous) noexcept;
+
+    /**
+     * @brief Attributes the allocations on the current thread to a tag until the scope ends, e.g.
+     *        alloc_scope scope{"crypto"}. Scopes can be nested.
+     * @remark The scope compiles to nothing unless CPP_ESSENCE_HAS_ALLOCATION_PROFILING is defined.
+     */
+    class alloc_scope {
+    public:
+#ifdef CPP_ESSENCE_HAS_ALLOCATION_PROFILING
+        explicit alloc_scope(std::string_view tag) noexcept : previous_{enter_allocation_scope(tag)} {}
+
+        ~alloc_scope() {
+            leave_allocation_scope(previous_);
+        }
+#else
+        explicit constexpr alloc_scope([[maybe_unused]] std::string_view tag) noexcept {}
+#endif
+
+        alloc_scope(const alloc_scope&) = delete;
+
+        alloc_scope& operator=(const alloc_scope&) = delete;
+
+#ifdef CPP_ESSENCE_HAS_ALLOCATION_PROFILING
+    private:
+        std::uint32_t previous_;
+#endif
+    };
+} // namespace essence::memory
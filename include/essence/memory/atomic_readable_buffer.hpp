@@ -27,86 +27,408 @@
 #include <atomic>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <memory_resource>
+#include <mutex>
+#include <new>
 #include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 
-#if __has_include(<version> )
-#include <version>
-#endif
-
 namespace essence {
     /**
-     * @brief A safe buffer that can be atomically replaced and read.
+     * @brief A buffer that is read without locks and replaced atomically as a whole, in the manner of RCU.
      * @tparam T The element type of the buffer.
+     * @remark Every version of the buffer lives in one control block holding its size and elements, so readers
+     *         always observe a consistent pair. Readers register in striped counters for the duration of a read
+     *         view, and replaced versions are reclaimed by later writers after two grace periods have passed.
+     *         Writers are serialized.
      */
-    template <std::default_initializable T>
+    template <typename T>
+        requires std::is_nothrow_destructible_v<T>
     class atomic_readable_buffer {
+        struct block;
+
     public:
-        using allocator_traits_type = std::allocator_traits<std::pmr::polymorphic_allocator<T>>;
+        /**
+         * @brief A consistent view of one version of the buffer, which keeps the version alive while it exists.
+         * @remark Keep views short-lived, since a live view defers the reclamation of every version replaced after
+         *         it is created.
+         */
+        class read_view {
+        public:
+            read_view(const read_view&) = delete;
+
+            ~read_view() {
+                owner_.leave(stripe_, parity_);
+            }
+
+            read_view& operator=(const read_view&) = delete;
+
+            [[nodiscard]] std::span<const T> span() const noexcept {
+                return std::span{block_->data(), block_->size};
+            }
+
+            operator std::span<const T>() const noexcept { // NOLINT(*-explicit-constructor)
+                return span();
+            }
+
+            [[nodiscard]] const T* data() const noexcept {
+                return block_->data();
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept {
+                return block_->size;
+            }
+
+            [[nodiscard]] bool empty() const noexcept {
+                return block_->size == 0;
+            }
+
+            [[nodiscard]] const T& operator[](std::size_t index) const noexcept {
+                return block_->data()[index];
+            }
+
+            [[nodiscard]] const T* begin() const noexcept {
+                return block_->data();
+            }
+
+            [[nodiscard]] const T* end() const noexcept {
+                return block_->data() + block_->size;
+            }
+
+            /**
+             * @brief Gets the version, which is incremented by every update.
+             * @return The version.
+             */
+            [[nodiscard]] std::uint64_t version() const noexcept {
+                return block_->version;
+            }
+
+        private:
+            friend class atomic_readable_buffer;
+
+            explicit read_view(const atomic_readable_buffer& owner) noexcept
+                : owner_{owner}, stripe_{get_stripe()}, parity_{owner.enter(stripe_)},
+                  block_{owner.current_.load(std::memory_order::seq_cst)} {}
+
+            const atomic_readable_buffer& owner_;
+            std::size_t stripe_;
+            std::size_t parity_;
+            const block* block_;
+        };
+
+        /**
+         * @brief Constructs the elements of a new version in place.
+         */
+        class builder {
+        public:
+            builder(const builder&) = delete;
+
+            builder& operator=(const builder&) = delete;
+
+            /**
+             * @brief Constructs an element at the end.
+             * @param args The arguments of the constructor.
+             * @return The element.
+             */
+            template <typename... Args>
+                requires std::constructible_from<T, Args...>
+            T& emplace_back(Args&&... args) {
+                if (block_.size == block_.capacity) {
+                    throw std::length_error{"The capacity of the buffer is exhausted."};
+                }
+
+                const auto result = std::construct_at(block_.data() + block_.size, std::forward<Args>(args)...);
+
+                block_.size++;
+
+                return *result;
+            }
+
+            /**
+             * @brief Copies a range to the end.
+             * @param range The range.
+             */
+            template <std::ranges::input_range Range>
+                requires std::constructible_from<T, std::ranges::range_reference_t<Range>>
+            void append_range(Range&& range) {
+                for (auto&& item : range) {
+                    emplace_back(std::forward<decltype(item)>(item));
+                }
+            }
+
+            /**
+             * @brief Gets the elements constructed so far.
+             * @return The elements.
+             */
+            [[nodiscard]] std::span<T> span() const noexcept {
+                return std::span{block_.data(), block_.size};
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept {
+                return block_.size;
+            }
+
+            [[nodiscard]] std::size_t capacity() const noexcept {
+                return block_.capacity;
+            }
+
+        private:
+            friend class atomic_readable_buffer;
+
+            explicit builder(block& block) noexcept : block_{block} {}
+
+            block& block_;
+        };
 
         /**
          * @brief Constructs the object with a PMR resource.
          * @param resource The PMR resource.
          */
         explicit atomic_readable_buffer(std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
-            : size_{}, allocator_{resource ? resource : std::pmr::new_delete_resource()} {
-            reset();
+            : resource_{resource ? resource : std::pmr::new_delete_resource()}, current_{create_block(0, 0)} {}
+
+        atomic_readable_buffer(const atomic_readable_buffer&) = delete;
+
+        /**
+         * @brief Destroys all versions.
+         * @remark No read view may outlive the object.
+         */
+        ~atomic_readable_buffer() {
+            destroy_block(current_.load(std::memory_order::relaxed));
+
+            for (auto&& item : retired_) {
+                for (auto iter = item; iter;) {
+                    destroy_block(std::exchange(iter, iter->next_retired));
+                }
+            }
         }
 
+        atomic_readable_buffer& operator=(const atomic_readable_buffer&) = delete;
+
         /**
          * @brief Resets the buffer.
          */
         void reset() {
-            update(std::array<T, 0>{});
+            update(std::span<const T>{});
         }
 
         /**
-         * @brief Updated the entire buffer.
+         * @brief Updates the entire buffer.
          * @tparam Range The type of the input range.
          * @param range The input range.
          */
         template <std::ranges::forward_range Range>
-            requires(std::convertible_to<std::ranges::range_value_t<Range>, T> && std::ranges::sized_range<Range>)
+            requires(std::constructible_from<T, std::ranges::range_reference_t<Range>>
+                     && std::ranges::sized_range<Range>)
         void update(Range&& range) {
-            auto size = std::ranges::size(range);
+            update(std::ranges::size(range), [&](builder& target) { target.append_range(range); });
+        }
 
-            auto storage = allocator_traits_type::allocate(allocator_, size);
+        /**
+         * @brief Builds a new version in place and publishes it.
+         * @param capacity The maximum number of the elements.
+         * @param handler Constructs the elements through the builder, whose elements become the new version.
+         */
+        template <std::invocable<builder&> Handler>
+        void update(std::size_t capacity, Handler&& handler) {
+            std::scoped_lock lock{mutex_};
 
-            for (auto ptr = storage, ptr_end = storage + size; ptr < ptr_end; ++ptr) {
-                std::construct_at(ptr);
-            }
+            update_locked(capacity, std::forward<Handler>(handler));
+        }
 
-            std::shared_ptr<T> buffer{storage, [size, allocator = allocator_](T* inner) mutable {
-                                          std::destroy(inner, inner + size);
-                                          allocator_traits_type::deallocate(allocator, inner, size);
-                                      }};
+        /**
+         * @brief Builds a new version from a copy of the current one and publishes it.
+         * @param extra_capacity The maximum number of the elements added by the handler.
+         * @param handler Modifies the copied elements through the builder.
+         */
+        template <std::invocable<builder&> Handler>
+            requires std::copy_constructible<T>
+        void modify(std::size_t extra_capacity, Handler&& handler) {
+            std::scoped_lock lock{mutex_};
 
-            std::ranges::copy(range, buffer.get());
-            size_ = size;
+            // The current version is loaded under the lock, so no concurrent modification can be lost, and it
+            // cannot be reclaimed before the copy is made.
+            const auto current = current_.load(std::memory_order::relaxed);
+
+            update_locked(current->size + extra_capacity, [&](builder& target) {
+                target.append_range(std::span<const T>{current->data(), current->size});
+                std::forward<Handler>(handler)(target);
+            });
+        }
 
-            std::atomic_store_explicit(&buffer_, buffer, std::memory_order::release);
+        /**
+         * @brief Reads the current version.
+         * @return The consistent view of the current version.
+         */
+        [[nodiscard]] read_view read() const noexcept {
+            return read_view{*this};
         }
 
         /**
-         * @brief Retrieves the current buffer.
-         * @return The current buffer.
+         * @brief Reclaims the replaced versions which are no longer readable, which updates also do.
+         * @return The number of the replaced versions still waiting for reclamation.
          */
-        std::pair<std::shared_ptr<T>, std::size_t> get() const {
-            auto buffer = std::atomic_load_explicit(&buffer_, std::memory_order::acquire);
+        std::size_t reclaim() {
+            std::scoped_lock lock{mutex_};
 
-            return {buffer, size_};
+            return reclaim_locked();
         }
 
     private:
-        std::size_t size_;
-        std::pmr::polymorphic_allocator<T> allocator_;
-
-#if __cpp_lib_atomic_shared_ptr >= 201711L
-        std::atomic<std::shared_ptr<T>> buffer_;
-#else
-        std::shared_ptr<T> buffer_;
-#endif
+        static constexpr std::size_t stripe_count = 16;
+
+        struct block {
+            std::uint64_t version;
+            std::size_t size;
+            std::size_t capacity;
+            std::size_t allocated_size;
+            block* next_retired;
+
+            /**
+             * @brief Gets the offset of the elements, which follow the header in the same allocation.
+             * @return The offset.
+             */
+            static constexpr std::size_t data_offset() noexcept {
+                return (sizeof(block) + alignof(T) - 1) / alignof(T) * alignof(T);
+            }
+
+            static constexpr std::size_t alignment() noexcept {
+                return std::max(alignof(block), alignof(T));
+            }
+
+            [[nodiscard]] T* data() noexcept {
+                return std::launder(reinterpret_cast<T*>(reinterpret_cast<std::byte*>(this) + data_offset()));
+            }
+
+            [[nodiscard]] const T* data() const noexcept {
+                return std::launder(
+                    reinterpret_cast<const T*>(reinterpret_cast<const std::byte*>(this) + data_offset()));
+            }
+        };
+
+        /**
+         * @brief The numbers of the readers in each parity, padded to avoid false sharing between stripes.
+         */
+        struct alignas(64) reader_stripe {
+            std::array<std::atomic<std::size_t>, 2> counts{};
+        };
+
+        static std::size_t get_stripe() noexcept {
+            static constinit std::atomic<std::size_t> next_stripe{};
+            thread_local const auto stripe = next_stripe.fetch_add(1, std::memory_order::relaxed) % stripe_count;
+
+            return stripe;
+        }
+
+        block* create_block(std::size_t capacity, std::uint64_t version) {
+            if (capacity > (std::numeric_limits<std::size_t>::max() - block::data_offset()) / sizeof(T)) {
+                throw std::bad_array_new_length{};
+            }
+
+            const auto allocated_size = block::data_offset() + capacity * sizeof(T);
+            const auto result = static_cast<block*>(resource_->allocate(allocated_size, block::alignment()));
+
+            return std::construct_at(result, block{.version = version,
+                                                 .size           = 0,
+                                                 .capacity       = capacity,
+                                                 .allocated_size = allocated_size,
+                                                 .next_retired   = nullptr});
+        }
+
+        void destroy_block(block* target) noexcept {
+            std::destroy_n(target->data(), target->size);
+            resource_->deallocate(target, target->allocated_size, block::alignment());
+        }
+
+        template <typename Handler>
+        void update_locked(std::size_t capacity, Handler&& handler) {
+            const auto version = current_.load(std::memory_order::relaxed)->version + 1;
+            const auto target  = create_block(capacity, version);
+
+            try {
+                builder target_builder{*target};
+
+                std::forward<Handler>(handler)(target_builder);
+            } catch (...) {
+                destroy_block(target);
+
+                throw;
+            }
+
+            retire(current_.exchange(target, std::memory_order::seq_cst));
+            reclaim_locked();
+        }
+
+        std::size_t enter(std::size_t stripe) const noexcept {
+            const auto parity = static_cast<std::size_t>(epoch_.load(std::memory_order::seq_cst) & 1);
+
+            stripes_[stripe].counts[parity].fetch_add(1, std::memory_order::seq_cst);
+
+            return parity;
+        }
+
+        void leave(std::size_t stripe, std::size_t parity) const noexcept {
+            stripes_[stripe].counts[parity].fetch_sub(1, std::memory_order::release);
+        }
+
+        void retire(block* target) noexcept {
+            auto&& list = retired_[epoch_.load(std::memory_order::relaxed) & 1];
+
+            target->next_retired = std::exchange(list, target);
+            retired_count_++;
+        }
+
+        /**
+         * @brief Advances the epoch if no reader has registered with the parity of the next one, i.e. the previous
+         *        one. A version replaced at epoch e may only be held by readers registered with either parity, so
+         *        it is unreachable once two advances have succeeded after the replacement.
+         * @return True if advanced; otherwise false.
+         */
+        bool try_advance_epoch() noexcept {
+            const auto epoch  = epoch_.load(std::memory_order::relaxed);
+            const auto parity = static_cast<std::size_t>((epoch + 1) & 1);
+
+            for (auto&& item : stripes_) {
+                if (item.counts[parity].load(std::memory_order::seq_cst) != 0) {
+                    return false;
+                }
+            }
+
+            epoch_.store(epoch + 1, std::memory_order::seq_cst);
+
+            return true;
+        }
+
+        std::size_t reclaim_locked() noexcept {
+            if (retired_count_ == 0) {
+                return 0;
+            }
+
+            for (std::size_t i = 0; i < 2 && try_advance_epoch(); i++) {
+                // The list of the new parity holds the versions replaced two epochs ago, which are unreachable now.
+                auto iter = std::exchange(retired_[epoch_.load(std::memory_order::relaxed) & 1], nullptr);
+
+                while (iter) {
+                    destroy_block(std::exchange(iter, iter->next_retired));
+                    retired_count_--;
+                }
+            }
+
+            return retired_count_;
+        }
+
+        std::pmr::memory_resource* resource_;
+        std::atomic<block*> current_;
+        std::atomic<std::uint64_t> epoch_{};
+        mutable std::array<reader_stripe, stripe_count> stripes_{};
+        std::mutex mutex_;
+        std::array<block*, 2> retired_{};
+        std::size_t retired_count_{};
     };
 } // namespace essence
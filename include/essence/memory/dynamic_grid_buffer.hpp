@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../char8_t_remediation.hpp"
+#include "../error_extensions.hpp"
+#include "aligned_buffer.hpp"
+#include "interleave.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace essence::memory {
+    /**
+     * @brief The layout options of a dynamic grid buffer.
+     */
+    struct grid_layout_options {
+        /**
+         * @brief The alignment in bytes of the first cell of every row, which must be a power of two.
+         */
+        std::size_t row_alignment{default_buffer_alignment};
+
+        /**
+         * @brief The minimum distance in bytes between the starts of two rows, or zero to only pad the rows to the
+         *        alignment.
+         */
+        std::size_t min_row_stride{};
+    };
+
+    /**
+     * @brief A runtime-shaped counterpart of essence::nonuniform_grid_buffer, in which data are arranged within
+     *        nonuniform grid cells, and every row starts at an aligned address followed by padding.
+     * @tparam T The type of one single cell.
+     */
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    class dynamic_grid_buffer {
+    public:
+        dynamic_grid_buffer() noexcept = default;
+
+        /**
+         * @brief Creates a zero-filled buffer.
+         * @param rows The number of rows.
+         * @param component_cells The numbers of the cells of all components across one single row.
+         * @param options The layout options.
+         */
+        dynamic_grid_buffer(
+            std::size_t rows, std::span<const std::size_t> component_cells, const grid_layout_options& options = {})
+            : rows_{rows}, component_offsets_(component_cells.size() + 1) {
+            if (!std::has_single_bit(options.row_alignment)) {
+                throw source_code_aware_runtime_error{U8("Row Alignment"), options.row_alignment, U8("Message"),
+                    U8("The alignment must be a power of two.")};
+            }
+
+            std::inclusive_scan(component_cells.begin(), component_cells.end(), component_offsets_.begin() + 1);
+
+            alignment_  = std::max(options.row_alignment, alignof(T));
+            row_stride_ = (std::max(row_cell_count() * sizeof(T), options.min_row_stride) + alignment_ - 1)
+                        & ~(alignment_ - 1);
+
+            allocate();
+
+            if (data_) {
+                std::memset(data_, 0, size_bytes());
+            }
+        }
+
+        /**
+         * @brief Creates a zero-filled buffer.
+         * @param rows The number of rows.
+         * @param component_cells The numbers of the cells of all components across one single row.
+         * @param options The layout options.
+         */
+        dynamic_grid_buffer(std::size_t rows, std::initializer_list<std::size_t> component_cells,
+            const grid_layout_options& options = {})
+            : dynamic_grid_buffer{rows, std::span{component_cells.begin(), component_cells.size()}, options} {}
+
+        dynamic_grid_buffer(const dynamic_grid_buffer& other)
+            : rows_{other.rows_}, component_offsets_{other.component_offsets_}, row_stride_{other.row_stride_},
+              alignment_{other.alignment_} {
+            allocate();
+
+            if (data_) {
+                std::memcpy(data_, other.data_, size_bytes());
+            }
+        }
+
+        dynamic_grid_buffer(dynamic_grid_buffer&& other) noexcept
+            : rows_{std::exchange(other.rows_, 0)}, component_offsets_{std::move(other.component_offsets_)},
+              row_stride_{std::exchange(other.row_stride_, 0)}, alignment_{other.alignment_},
+              data_{std::exchange(other.data_, nullptr)} {}
+
+        ~dynamic_grid_buffer() {
+            deallocate();
+        }
+
+        dynamic_grid_buffer& operator=(const dynamic_grid_buffer& other) {
+            if (this != &other) {
+                *this = dynamic_grid_buffer{other};
+            }
+
+            return *this;
+        }
+
+        dynamic_grid_buffer& operator=(dynamic_grid_buffer&& other) noexcept {
+            if (this != &other) {
+                deallocate();
+                rows_              = std::exchange(other.rows_, 0);
+                component_offsets_ = std::move(other.component_offsets_);
+                row_stride_        = std::exchange(other.row_stride_, 0);
+                alignment_         = other.alignment_;
+                data_              = std::exchange(other.data_, nullptr);
+            }
+
+            return *this;
+        }
+
+        [[nodiscard]] std::size_t rows() const noexcept {
+            return rows_;
+        }
+
+        [[nodiscard]] std::size_t component_count() const noexcept {
+            return component_offsets_.empty() ? 0 : component_offsets_.size() - 1;
+        }
+
+        /**
+         * @brief Gets the number of the cells of a component across one single row.
+         * @param index The index of the component.
+         * @return The number of the cells.
+         */
+        [[nodiscard]] std::size_t component_cells(std::size_t index) const noexcept {
+            return component_offsets_[index + 1] - component_offsets_[index];
+        }
+
+        [[nodiscard]] std::size_t row_cell_count() const noexcept {
+            return component_offsets_.empty() ? 0 : component_offsets_.back();
+        }
+
+        /**
+         * @brief Gets the distance in bytes between the starts of two rows, including the padding.
+         * @return The distance in bytes.
+         */
+        [[nodiscard]] std::size_t row_stride() const noexcept {
+            return row_stride_;
+        }
+
+        [[nodiscard]] std::size_t size_bytes() const noexcept {
+            return rows_ * row_stride_;
+        }
+
+        /**
+         * @brief Gets the cells of a row, excluding the padding.
+         * @param row The index of the row.
+         * @return The mutable cell span.
+         */
+        [[nodiscard]] std::span<T> get_row(std::size_t row) noexcept {
+            return std::span{row_data(row), row_cell_count()};
+        }
+
+        /**
+         * @brief Gets the cells of a row, excluding the padding.
+         * @param row The index of the row.
+         * @return The const cell span.
+         */
+        [[nodiscard]] std::span<const T> get_row(std::size_t row) const noexcept {
+            return std::span{row_data(row), row_cell_count()};
+        }
+
+        /**
+         * @brief Gets the component as a mutable cell span.
+         * @param row The index of the row.
+         * @param index The index of the component.
+         * @return The mutable cell span.
+         */
+        [[nodiscard]] std::span<T> get_component(std::size_t row, std::size_t index) noexcept {
+            return get_row(row).subspan(component_offsets_[index], component_cells(index));
+        }
+
+        /**
+         * @brief Gets the component as a const cell span.
+         * @param row The index of the row.
+         * @param index The index of the component.
+         * @return The const cell span.
+         */
+        [[nodiscard]] std::span<const T> get_component(std::size_t row, std::size_t index) const noexcept {
+            return get_row(row).subspan(component_offsets_[index], component_cells(index));
+        }
+
+        /**
+         * @brief Sets the data of a component.
+         * @param row The index of the row.
+         * @param index The index of the component.
+         * @param data The byte data to assign, whose size must match the component.
+         */
+        void set_component(std::size_t row, std::size_t index, std::span<const std::byte> data) {
+            const auto target = std::as_writable_bytes(get_component(row, index));
+
+            if (data.size() != target.size()) {
+                throw source_code_aware_runtime_error{U8("Expected Size"), target.size(), U8("Actual Size"),
+                    data.size(), U8("Message"), U8("The size of the data does not match the component.")};
+            }
+
+            std::memcpy(target.data(), data.data(), data.size());
+        }
+
+        /**
+         * @brief Sets the data of a component.
+         * @param row The index of the row.
+         * @param index The index of the component.
+         * @param data The data in T units to assign, whose size must match the component.
+         */
+        void set_component(std::size_t row, std::size_t index, std::span<const T> data) {
+            set_component(row, index, std::as_bytes(data));
+        }
+
+        /**
+         * @brief Copies the cells of the same rows from another buffer of the same shape, which is a single memcpy
+         *        if the strides are equal.
+         * @param source The other buffer.
+         */
+        void copy_from(const dynamic_grid_buffer& source) {
+            check_same_shape(source);
+
+            if (row_stride_ == source.row_stride_) {
+                std::memcpy(data_, source.data_, size_bytes());
+            } else {
+                for (std::size_t i = 0; i < rows_; i++) {
+                    std::memcpy(row_data(i), source.row_data(i), row_cell_count() * sizeof(T));
+                }
+            }
+        }
+
+        /**
+         * @brief Copies a component of all rows from another buffer of the same shape.
+         * @param source The other buffer.
+         * @param index The index of the component.
+         */
+        void copy_component_from(const dynamic_grid_buffer& source, std::size_t index) {
+            check_same_shape(source);
+
+            for (std::size_t i = 0; i < rows_; i++) {
+                std::memcpy(get_component(i, index).data(), source.get_component(i, index).data(),
+                    component_cells(index) * sizeof(T));
+            }
+        }
+
+        /**
+         * @brief Splits a tightly packed interleaved frame into the components, which must have the same number of
+         *        cells, i.e. the components of a row become the planes of the corresponding interleaved row.
+         * @param interleaved The interleaved frame, whose size is the number of the cells in all rows.
+         */
+        void load_interleaved(std::span<const T> interleaved) {
+            check_interleaved_size(interleaved.size());
+
+            std::array<std::span<std::byte>, max_interleaved_channels> planes;
+
+            for (std::size_t i = 0; i < rows_; i++) {
+                for (std::size_t j = 0; j < component_count(); j++) {
+                    planes[j] = std::as_writable_bytes(get_component(i, j));
+                }
+
+                deinterleave(std::as_bytes(interleaved.subspan(i * row_cell_count(), row_cell_count())),
+                    std::span{planes}.first(component_count()), sizeof(T));
+            }
+        }
+
+        /**
+         * @brief Merges the components into a tightly packed interleaved frame, which must have the same number of
+         *        cells.
+         * @param interleaved The interleaved frame, whose size is the number of the cells in all rows.
+         */
+        void store_interleaved(std::span<T> interleaved) const {
+            check_interleaved_size(interleaved.size());
+
+            std::array<std::span<const std::byte>, max_interleaved_channels> planes;
+
+            for (std::size_t i = 0; i < rows_; i++) {
+                for (std::size_t j = 0; j < component_count(); j++) {
+                    planes[j] = std::as_bytes(get_component(i, j));
+                }
+
+                interleave(std::span{planes}.first(component_count()),
+                    std::as_writable_bytes(interleaved.subspan(i * row_cell_count(), row_cell_count())), sizeof(T));
+            }
+        }
+
+        /**
+         * @brief Gets the underlying buffer as a mutable byte span, including the padding.
+         * @return The mutable byte span.
+         */
+        [[nodiscard]] std::span<std::byte> underlying_buffer() noexcept {
+            return std::span{data_, size_bytes()};
+        }
+
+        /**
+         * @brief Gets the underlying buffer as a const byte span, including the padding.
+         * @return The const byte span.
+         */
+        [[nodiscard]] std::span<const std::byte> underlying_buffer() const noexcept {
+            return std::span{static_cast<const std::byte*>(data_), size_bytes()};
+        }
+
+    private:
+        T* row_data(std::size_t row) const noexcept {
+            return std::launder(reinterpret_cast<T*>(data_ + row * row_stride_));
+        }
+
+        void allocate() {
+            if (size_bytes() != 0) {
+                data_ = static_cast<std::byte*>(allocate_buffer_storage(size_bytes(), alignment_));
+            }
+        }
+
+        void deallocate() noexcept {
+            if (data_) {
+                deallocate_buffer_storage(data_, size_bytes(), alignment_);
+                data_ = nullptr;
+            }
+        }
+
+        void check_same_shape(const dynamic_grid_buffer& other) const {
+            if (rows_ != other.rows_ || component_offsets_ != other.component_offsets_) {
+                throw source_code_aware_runtime_error{U8("The shapes of the grid buffers differ.")};
+            }
+        }
+
+        void check_interleaved_size(std::size_t size) const {
+            auto matched = size == rows_ * row_cell_count() && component_count() != 0
+                        && component_count() <= max_interleaved_channels;
+
+            for (std::size_t i = 1; matched && i < component_count(); i++) {
+                matched = component_cells(i) == component_cells(0);
+            }
+
+            if (!matched) {
+                throw source_code_aware_runtime_error{U8("Size"), size, U8("Message"),
+                    U8("The interleaved frame does not match the components, which must have the same size.")};
+            }
+        }
+
+        std::size_t rows_{};
+        std::vector<std::size_t> component_offsets_;
+        std::size_t row_stride_{};
+        std::size_t alignment_{default_buffer_alignment};
+        std::byte* data_{};
+    };
+} // namespace essence::memory
@@ -22,6 +22,440 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
 namespace essence {
+    /**
+     * @brief The options of a resource pool.
+     */
+    struct resource_pool_options {
+        /**
+         * @brief The maximum number of idle objects kept in the shared free list, beyond which released objects are
+         *        destroyed.
+         */
+        std::size_t max_size{64};
+
+        /**
+         * @brief The maximum number of idle objects kept by each thread, which are reused without any atomic
+         *        operation.
+         */
+        std::size_t thread_cache_size{4};
+    };
+
+    /**
+     * @brief The counters of a resource pool.
+     */
+    struct resource_pool_stats {
+        /**
+         * @brief The number of objects created by the factory.
+         */
+        std::uint64_t created{};
+
+        /**
+         * @brief The number of acquisitions served from the thread caches.
+         */
+        std::uint64_t thread_cache_hits{};
+
+        /**
+         * @brief The number of acquisitions served from the shared free list.
+         */
+        std::uint64_t shared_hits{};
+
+        /**
+         * @brief The number of released objects destroyed because the reset hook rejected them or the pool was full.
+         */
+        std::uint64_t discarded{};
+
+        /**
+         * @brief The number of idle objects in the shared free list.
+         */
+        std::size_t idle{};
+    };
+
+    /**
+     * @brief A pool of expensive reusable objects, which serves acquisitions from a per-thread cache first, then from
+     *        a lock-free shared free list, and creates new objects only when both are empty.
+     * @tparam T The type of the objects.
+     * @remark The pool is safe to use concurrently. Leases must not outlive the pool, while objects cached by other
+     *         threads are destroyed at the exits of the threads if the pool is gone by then.
+     */
+    template <std::move_constructible T>
+    class generic_resource_pool {
+    public:
+        using factory_type = std::function<T()>;
+
+        /**
+         * @brief Prepares a released object for reuse, and returns false to destroy it instead.
+         */
+        using reset_type = std::function<bool(T& value)>;
+
+    private:
+        class state;
+
+    public:
+        /**
+         * @brief An exclusive lease of a pooled object, which returns the object to the pool when destroyed.
+         */
+        class lease {
+        public:
+            lease() noexcept = default;
+
+            lease(const lease&) = delete;
+
+            lease(lease&& other) noexcept
+                : state_{std::exchange(other.state_, nullptr)}, value_{std::move(other.value_)} {}
+
+            ~lease() {
+                reset();
+            }
+
+            lease& operator=(const lease&) = delete;
+
+            lease& operator=(lease&& other) noexcept {
+                if (this != &other) {
+                    reset();
+                    state_ = std::exchange(other.state_, nullptr);
+                    value_ = std::move(other.value_);
+                }
+
+                return *this;
+            }
+
+            explicit operator bool() const noexcept {
+                return static_cast<bool>(value_);
+            }
+
+            [[nodiscard]] T& operator*() const noexcept {
+                return *value_;
+            }
+
+            [[nodiscard]] T* operator->() const noexcept {
+                return value_.get();
+            }
+
+            [[nodiscard]] T* get() const noexcept {
+                return value_.get();
+            }
+
+            /**
+             * @brief Returns the object to the pool before the lease is destroyed.
+             */
+            void reset() noexcept {
+                if (value_) {
+                    state_->release(std::move(value_));
+                    state_ = nullptr;
+                }
+            }
+
+            /**
+             * @brief Takes the object out of the pool permanently.
+             * @return The object.
+             */
+            [[nodiscard]] std::unique_ptr<T> detach() noexcept {
+                state_ = nullptr;
+
+                return std::move(value_);
+            }
+
+        private:
+            friend class generic_resource_pool;
+
+            lease(state* state, std::unique_ptr<T> value) noexcept : state_{state}, value_{std::move(value)} {}
+
+            state* state_{};
+            std::unique_ptr<T> value_;
+        };
+
+        /**
+         * @brief Creates an instance.
+         * @param factory Creates a new object.
+         * @param reset Prepares a released object for reuse, or empty to reuse objects as they are.
+         * @param options The options.
+         */
+        explicit generic_resource_pool(
+            factory_type factory, reset_type reset = {}, const resource_pool_options& options = {})
+            : state_{std::make_shared<state>(std::move(factory), std::move(reset), options)} {}
+
+        generic_resource_pool()
+            requires std::default_initializable<T>
+            : generic_resource_pool{[] { return T{}; }} {}
+
+        generic_resource_pool(const generic_resource_pool&) = delete;
+
+        generic_resource_pool(generic_resource_pool&&) noexcept = default;
+
+        generic_resource_pool& operator=(const generic_resource_pool&) = delete;
+
+        generic_resource_pool& operator=(generic_resource_pool&&) noexcept = default;
+
+        /**
+         * @brief Acquires an object.
+         * @return The lease of the object.
+         */
+        [[nodiscard]] lease acquire() const {
+            return lease{state_.get(), state_->acquire()};
+        }
+
+        /**
+         * @brief Gets the counters.
+         * @return The counters.
+         */
+        [[nodiscard]] resource_pool_stats stats() const noexcept {
+            return state_->stats();
+        }
+
+        /**
+         * @brief Destroys the idle objects in the shared free list.
+         */
+        void trim() const noexcept {
+            state_->trim();
+        }
+
+    private:
+        /**
+         * @brief A lock-free stack of slot indices, whose head carries a tag incremented by every update to avoid the
+         *        ABA problem. The slots are never freed, so a stale read of a link is harmless.
+         */
+        class index_stack {
+        public:
+            static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+            explicit index_stack(std::size_t capacity)
+                : links_{std::make_unique<std::atomic<std::uint32_t>[]>(capacity)} {}
+
+            void push(std::uint32_t index) noexcept {
+                auto head = head_.load(std::memory_order::relaxed);
+
+                do {
+                    links_[index].store(index_of(head), std::memory_order::relaxed);
+                } while (!head_.compare_exchange_weak(
+                    head, pack(index, tag_of(head) + 1), std::memory_order::release, std::memory_order::relaxed));
+            }
+
+            [[nodiscard]] std::optional<std::uint32_t> pop() noexcept {
+                auto head = head_.load(std::memory_order::acquire);
+
+                while (index_of(head) != npos) {
+                    const auto next = links_[index_of(head)].load(std::memory_order::relaxed);
+
+                    if (head_.compare_exchange_weak(head, pack(next, tag_of(head) + 1), std::memory_order::acquire,
+                            std::memory_order::acquire)) {
+                        return index_of(head);
+                    }
+                }
+
+                return std::nullopt;
+            }
+
+        private:
+            static std::uint64_t pack(std::uint32_t index, std::uint32_t tag) noexcept {
+                return static_cast<std::uint64_t>(tag) << 32 | index;
+            }
+
+            static std::uint32_t index_of(std::uint64_t head) noexcept {
+                return static_cast<std::uint32_t>(head);
+            }
+
+            static std::uint32_t tag_of(std::uint64_t head) noexcept {
+                return static_cast<std::uint32_t>(head >> 32);
+            }
+
+            std::atomic<std::uint64_t> head_{pack(npos, 0)};
+            std::unique_ptr<std::atomic<std::uint32_t>[]> links_;
+        };
+
+        /**
+         * @brief The idle objects kept by one thread for each live pool of the same type.
+         */
+        class thread_cache {
+        public:
+            struct entry {
+                const state* owner;
+                std::weak_ptr<state> weak_owner;
+                std::vector<std::unique_ptr<T>> objects;
+            };
+
+            thread_cache() = default;
+
+            thread_cache(const thread_cache&) = delete;
+
+            ~thread_cache() {
+                for (auto&& item : entries_) {
+                    if (const auto owner = item.weak_owner.lock()) {
+                        for (auto&& object : item.objects) {
+                            owner->release_shared(std::move(object));
+                        }
+                    }
+                }
+            }
+
+            thread_cache& operator=(const thread_cache&) = delete;
+
+            static thread_cache& current() {
+                thread_local thread_cache cache;
+
+                return cache;
+            }
+
+            [[nodiscard]] entry* find(const state* owner) noexcept {
+                const auto iter = std::ranges::find(entries_, owner, &entry::owner);
+
+                if (iter == entries_.end()) {
+                    return nullptr;
+                }
+
+                // A destroyed pool may have left an entry at the same address as a new one.
+                if (iter->weak_owner.expired()) {
+                    entries_.erase(iter);
+
+                    return nullptr;
+                }
+
+                return &*iter;
+            }
+
+            entry& emplace(const std::shared_ptr<state>& owner) {
+                // Drops the objects of the pools which have been destroyed.
+                std::erase_if(entries_, [](const entry& item) { return item.weak_owner.expired(); });
+
+                return entries_.emplace_back(entry{owner.get(), owner, {}});
+            }
+
+        private:
+            std::vector<entry> entries_;
+        };
+
+        class state : public std::enable_shared_from_this<state> {
+        public:
+            state(factory_type factory, reset_type reset, const resource_pool_options& options)
+                : factory_{std::move(factory)}, reset_{std::move(reset)},
+                  capacity_{static_cast<std::uint32_t>(
+                      std::min<std::size_t>(options.max_size, index_stack::npos - 1))},
+                  thread_cache_size_{options.thread_cache_size},
+                  objects_{std::make_unique<std::unique_ptr<T>[]>(capacity_)}, idle_slots_{capacity_},
+                  free_slots_{capacity_} {
+                for (std::uint32_t i = 0; i < capacity_; i++) {
+                    free_slots_.push(i);
+                }
+            }
+
+            state(const state&) = delete;
+
+            state& operator=(const state&) = delete;
+
+            [[nodiscard]] std::unique_ptr<T> acquire() {
+                if (thread_cache_size_ != 0) {
+                    if (const auto entry = thread_cache::current().find(this); entry && !entry->objects.empty()) {
+                        auto result = std::move(entry->objects.back());
+
+                        entry->objects.pop_back();
+                        thread_cache_hits_.fetch_add(1, std::memory_order::relaxed);
+
+                        return result;
+                    }
+                }
+
+                if (const auto index = idle_slots_.pop()) {
+                    auto result = std::move(objects_[*index]);
+
+                    free_slots_.push(*index);
+                    idle_.fetch_sub(1, std::memory_order::relaxed);
+                    shared_hits_.fetch_add(1, std::memory_order::relaxed);
+
+                    return result;
+                }
+
+                auto result = std::make_unique<T>(factory_());
+
+                created_.fetch_add(1, std::memory_order::relaxed);
+
+                return result;
+            }
+
+            void release(std::unique_ptr<T> value) noexcept {
+                try {
+                    if (reset_ && !reset_(*value)) {
+                        discarded_.fetch_add(1, std::memory_order::relaxed);
+
+                        return;
+                    }
+
+                    if (thread_cache_size_ != 0) {
+                        auto&& cache = thread_cache::current();
+                        auto entry   = cache.find(this);
+
+                        if (!entry) {
+                            entry = &cache.emplace(this->shared_from_this());
+                        }
+
+                        if (entry->objects.size() < thread_cache_size_) {
+                            entry->objects.emplace_back(std::move(value));
+
+                            return;
+                        }
+                    }
+                } catch (...) {
+                    discarded_.fetch_add(1, std::memory_order::relaxed);
+
+                    return;
+                }
+
+                release_shared(std::move(value));
+            }
+
+            void release_shared(std::unique_ptr<T> value) noexcept {
+                if (const auto index = free_slots_.pop()) {
+                    objects_[*index] = std::move(value);
+                    idle_.fetch_add(1, std::memory_order::relaxed);
+                    idle_slots_.push(*index);
+                } else {
+                    discarded_.fetch_add(1, std::memory_order::relaxed);
+                }
+            }
+
+            void trim() noexcept {
+                for (auto index = idle_slots_.pop(); index; index = idle_slots_.pop()) {
+                    objects_[*index].reset();
+                    idle_.fetch_sub(1, std::memory_order::relaxed);
+                    free_slots_.push(*index);
+                }
+            }
+
+            [[nodiscard]] resource_pool_stats stats() const noexcept {
+                return resource_pool_stats{
+                    .created           = created_.load(std::memory_order::relaxed),
+                    .thread_cache_hits = thread_cache_hits_.load(std::memory_order::relaxed),
+                    .shared_hits       = shared_hits_.load(std::memory_order::relaxed),
+                    .discarded         = discarded_.load(std::memory_order::relaxed),
+                    .idle              = idle_.load(std::memory_order::relaxed),
+                };
+            }
+
+        private:
+            factory_type factory_;
+            reset_type reset_;
+            std::uint32_t capacity_;
+            std::size_t thread_cache_size_;
+            std::unique_ptr<std::unique_ptr<T>[]> objects_;
+            index_stack idle_slots_;
+            index_stack free_slots_;
+            std::atomic<std::uint64_t> created_;
+            std::atomic<std::uint64_t> thread_cache_hits_;
+            std::atomic<std::uint64_t> shared_hits_;
+            std::atomic<std::uint64_t> discarded_;
+            std::atomic<std::size_t> idle_;
+        };
 
-}
+        std::shared_ptr<state> state_;
+    };
+} // namespace essence
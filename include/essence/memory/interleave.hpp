@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../compat.hpp"
+
+#include <cstddef>
+#include <span>
+
+namespace essence::memory {
+    /**
+     * @brief The maximum number of the channels supported by the interleaving kernels.
+     */
+    inline constexpr std::size_t max_interleaved_channels = 16;
+
+    /**
+     * @brief Splits interleaved elements into one plane per channel, i.e. converts an array of structures into a
+     *        structure of arrays.
+     * @param interleaved The interleaved elements, whose size is the size of a plane times the number of the planes.
+     * @param planes The output planes, which must have the same size.
+     * @param element_size The size in bytes of one element. 8-bit elements of 2 and 4 channels (3 and 4 on NEON)
+     *                     are handled by SIMD kernels.
+     */
+    ES_API(CPPESSENCE)
+    void deinterleave(
+        std::span<const std::byte> interleaved, std::span<const std::span<std::byte>> planes, std::size_t element_size);
+
+    /**
+     * @brief Merges one plane per channel into interleaved elements, i.e. converts a structure of arrays into an
+     *        array of structures.
+     * @param planes The input planes, which must have the same size.
+     * @param interleaved The output elements, whose size is the size of a plane times the number of the planes.
+     * @param element_size The size in bytes of one element.
+     */
+    ES_API(CPPESSENCE)
+    void interleave(
+        std::span<const std::span<const std::byte>> planes, std::span<std::byte> interleaved, std::size_t element_size);
+} // namespace essence::memory
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../compat.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace essence::memory {
+    /**
+     * @brief The size in bytes from which the page resources map pages directly rather than using the heap.
+     */
+    inline constexpr std::size_t page_resource_threshold = 64 * 1024;
+
+    /**
+     * @brief Gets the resource which maps large allocations to their own pages backed by huge pages where supported,
+     *        trying explicit huge pages (MAP_HUGETLB) before transparent ones (MADV_HUGEPAGE).
+     * @return The resource, which is thread-safe and lives until the process exits.
+     * @remark Allocations smaller than page_resource_threshold are served by std::pmr::new_delete_resource().
+     */
+    [[nodiscard]] ES_API(CPPESSENCE) std::pmr::memory_resource* get_huge_page_resource() noexcept;
+
+    /**
+     * @brief Gets the resource which maps large allocations to their own pages on the NUMA node of the allocating
+     *        thread (mbind with a preference for the node), which also uses transparent huge pages where supported.
+     * @return The resource, which is thread-safe and lives until the process exits.
+     * @remark Allocations smaller than page_resource_threshold are served by std::pmr::new_delete_resource(). Without
+     *         NUMA support, it behaves like a plain page resource.
+     */
+    [[nodiscard]] ES_API(CPPESSENCE) std::pmr::memory_resource* get_numa_local_resource() noexcept;
+
+    /**
+     * @brief Gets the NUMA node of the CPU on which the calling thread is running.
+     * @return The node, or -1 if unknown.
+     */
+    [[nodiscard]] ES_API(CPPESSENCE) std::int32_t get_current_numa_node() noexcept;
+
+    /**
+     * @brief A monotonic arena for the allocations of a single request, which carves them from chunks of an upstream
+     *        resource and releases them all at once.
+     * @remark Unlike std::pmr::monotonic_buffer_resource, resetting the arena keeps its largest chunk, so an arena
+     *         reused across requests stops touching the upstream resource once warmed up. The arena is not
+     *         thread-safe.
+     */
+    class monotonic_arena_resource : public std::pmr::memory_resource {
+    public:
+        /**
+         * @brief The default size in bytes of the first chunk.
+         */
+        static constexpr std::size_t default_chunk_size = page_resource_threshold;
+
+        /**
+         * @brief Creates an instance.
+         * @param upstream The resource of the chunks, e.g. get_huge_page_resource() or get_numa_local_resource().
+         * @param chunk_size The size in bytes of the first chunk, which doubles for each following chunk.
+         */
+        explicit monotonic_arena_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource(),
+            std::size_t chunk_size                                            = default_chunk_size) noexcept
+            : upstream_{upstream}, next_chunk_size_{std::max(chunk_size, sizeof(chunk) * 2)} {}
+
+        monotonic_arena_resource(const monotonic_arena_resource&) = delete;
+
+        ~monotonic_arena_resource() override {
+            release();
+        }
+
+        monotonic_arena_resource& operator=(const monotonic_arena_resource&) = delete;
+
+        /**
+         * @brief Gets the upstream resource.
+         * @return The upstream resource.
+         */
+        [[nodiscard]] std::pmr::memory_resource* upstream_resource() const noexcept {
+            return upstream_;
+        }
+
+        /**
+         * @brief Gets the number of the bytes handed out since the last reset, including the alignment padding.
+         * @return The number of the bytes.
+         */
+        [[nodiscard]] std::size_t bytes_used() const noexcept {
+            return bytes_used_;
+        }
+
+        /**
+         * @brief Frees all allocations but keeps the largest chunk for the next request.
+         */
+        void reset() noexcept {
+            chunk* largest{};
+
+            for (auto iter = head_; iter;) {
+                const auto next = iter->next;
+
+                if (!largest || iter->size > largest->size) {
+                    std::swap(iter, largest);
+                }
+
+                if (iter) {
+                    deallocate_chunk(iter);
+                }
+
+                iter = next;
+            }
+
+            head_       = largest;
+            current_    = largest ? reinterpret_cast<std::byte*>(largest + 1) : nullptr;
+            end_        = largest ? reinterpret_cast<std::byte*>(largest) + largest->size : nullptr;
+            bytes_used_ = 0;
+
+            if (largest) {
+                largest->next = nullptr;
+            }
+        }
+
+        /**
+         * @brief Frees all allocations and returns all chunks to the upstream resource.
+         */
+        void release() noexcept {
+            while (head_) {
+                deallocate_chunk(std::exchange(head_, head_->next));
+            }
+
+            current_    = nullptr;
+            end_        = nullptr;
+            bytes_used_ = 0;
+        }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            if (auto result = try_carve(bytes, alignment)) {
+                return result;
+            }
+
+            constexpr auto max_size = std::numeric_limits<std::size_t>::max();
+
+            if (alignment > max_size - sizeof(chunk) || bytes > max_size - sizeof(chunk) - alignment) {
+                throw std::bad_alloc{};
+            }
+
+            // The new chunk is large enough for the allocation at any alignment. The growth stops at the required
+            // size once doubling would overflow.
+            const auto required_size = sizeof(chunk) + bytes + alignment;
+
+            while (next_chunk_size_ < required_size) {
+                next_chunk_size_ = next_chunk_size_ > max_size / 2 ? required_size : next_chunk_size_ * 2;
+            }
+
+            const auto target = static_cast<chunk*>(upstream_->allocate(next_chunk_size_, alignof(std::max_align_t)));
+
+            head_           = new (target) chunk{.next = head_, .size = next_chunk_size_};
+            current_        = reinterpret_cast<std::byte*>(target + 1);
+            end_            = reinterpret_cast<std::byte*>(target) + target->size;
+            next_chunk_size_ = std::min(next_chunk_size_, max_size / 2) * 2;
+
+            return try_carve(bytes, alignment);
+        }
+
+        void do_deallocate([[maybe_unused]] void* ptr, [[maybe_unused]] std::size_t bytes,
+            [[maybe_unused]] std::size_t alignment) override {}
+
+        [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        struct chunk {
+            chunk* next;
+            std::size_t size;
+        };
+
+        void deallocate_chunk(chunk* target) noexcept {
+            upstream_->deallocate(target, target->size, alignof(std::max_align_t));
+        }
+
+        void* try_carve(std::size_t bytes, std::size_t alignment) noexcept {
+            if (!current_) {
+                return nullptr;
+            }
+
+            const auto address = reinterpret_cast<std::uintptr_t>(current_);
+            const auto padding = (alignment - address % alignment) % alignment;
+
+            if (const auto available = static_cast<std::size_t>(end_ - current_);
+                available < padding || available - padding < bytes) {
+                return nullptr;
+            }
+
+            const auto result = current_ + padding;
+
+            current_ = result + bytes;
+            bytes_used_ += padding + bytes;
+
+            return result;
+        }
+
+        std::pmr::memory_resource* upstream_;
+        std::size_t next_chunk_size_;
+        chunk* head_{};
+        std::byte* current_{};
+        std::byte* end_{};
+        std::size_t bytes_used_{};
+    };
+} // namespace essence::memory
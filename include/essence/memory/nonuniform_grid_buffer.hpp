@@ -22,10 +22,10 @@
 
 #pragma once
 
-#include <algorithm>
 #include <array>
 #include <concepts>
 #include <cstddef>
+#include <cstring>
 #include <numeric>
 #include <span>
 #include <type_traits>
@@ -96,7 +96,7 @@ namespace essence {
         void set_component(component_byte_span<I, std::add_const> data) noexcept {
             auto iter = get_component_iter<Row, I, true>(*this);
 
-            std::ranges::copy(data.data(), data.data() + data.size(), iter);
+            std::memcpy(iter, data.data(), data.size());
         }
 
         /**
@@ -0,0 +1,794 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace essence::memory {
+    /**
+     * @brief The size in bytes to which the shared indices of the ring queues are padded to avoid false sharing.
+     */
+    inline constexpr std::size_t queue_padding_size = 64;
+
+    /**
+     * @brief Rounds the capacity of a ring queue up to a power of two.
+     * @param capacity The requested capacity.
+     * @return The actual capacity.
+     */
+    inline std::size_t round_ring_capacity(std::size_t capacity) {
+        if (capacity == 0 || capacity > (std::numeric_limits<std::size_t>::max() >> 2)) {
+            throw std::length_error{"The capacity of the ring queue is out of range."};
+        }
+
+        return std::bit_ceil(capacity);
+    }
+
+    /**
+     * @brief A bounded lock-free ring queue for exactly one producer thread and one consumer thread.
+     * @tparam T The type of the elements.
+     * @remark Each side keeps a cached copy of the index of the other side, so the shared cache lines are only
+     *         touched when the queue looks full or empty. The blocking operations sleep on the indices through
+     *         atomic waiting.
+     */
+    template <typename T>
+        requires std::is_nothrow_destructible_v<T>
+    class spsc_ring_queue {
+    public:
+        /**
+         * @brief Creates an instance.
+         * @param capacity The minimum capacity, which is rounded up to a power of two.
+         */
+        explicit spsc_ring_queue(std::size_t capacity)
+            : mask_{round_ring_capacity(capacity) - 1}, slots_{std::make_unique_for_overwrite<slot[]>(mask_ + 1)} {}
+
+        spsc_ring_queue(const spsc_ring_queue&) = delete;
+
+        ~spsc_ring_queue() {
+            for (auto i = consumer_.head.load(std::memory_order::relaxed);
+                i != producer_.tail.load(std::memory_order::relaxed); i++) {
+                std::destroy_at(get(i));
+            }
+        }
+
+        spsc_ring_queue& operator=(const spsc_ring_queue&) = delete;
+
+        [[nodiscard]] std::size_t capacity() const noexcept {
+            return mask_ + 1;
+        }
+
+        /**
+         * @brief Gets the number of the elements, which is only a snapshot while the queue is in use.
+         * @return The number of the elements.
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            const auto head = consumer_.head.load(std::memory_order::acquire);
+
+            return producer_.tail.load(std::memory_order::acquire) - head;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /**
+         * @brief Constructs an element at the back if the queue is not full.
+         * @param args The arguments of the constructor.
+         * @return True if pushed; otherwise false.
+         */
+        template <typename... Args>
+            requires std::constructible_from<T, Args...>
+        bool try_emplace(Args&&... args) {
+            const auto tail = producer_.tail.load(std::memory_order::relaxed);
+
+            if (free_space(tail, 1) == 0) {
+                return false;
+            }
+
+            std::construct_at(get(tail), std::forward<Args>(args)...);
+            publish_tail(tail + 1);
+
+            return true;
+        }
+
+        bool try_push(const T& value) {
+            return try_emplace(value);
+        }
+
+        bool try_push(T&& value) {
+            return try_emplace(std::move(value));
+        }
+
+        /**
+         * @brief Constructs an element at the back, waiting while the queue is full.
+         * @param args The arguments of the constructor.
+         */
+        template <typename... Args>
+            requires std::constructible_from<T, Args...>
+        void emplace(Args&&... args) {
+            const auto tail = producer_.tail.load(std::memory_order::relaxed);
+
+            wait_for_space(tail);
+            std::construct_at(get(tail), std::forward<Args>(args)...);
+            publish_tail(tail + 1);
+        }
+
+        void push(const T& value) {
+            emplace(value);
+        }
+
+        void push(T&& value) {
+            emplace(std::move(value));
+        }
+
+        /**
+         * @brief Moves as many elements as fit to the back and publishes them at once.
+         * @param items The elements, of which the pushed ones are left moved-from.
+         * @return The number of the pushed elements.
+         */
+        std::size_t try_push_n(std::span<T> items)
+            requires std::is_nothrow_move_constructible_v<T>
+        {
+            const auto tail  = producer_.tail.load(std::memory_order::relaxed);
+            const auto count = std::min(items.size(), free_space(tail, items.size()));
+
+            for (std::size_t i = 0; i < count; i++) {
+                std::construct_at(get(tail + i), std::move(items[i]));
+            }
+
+            if (count != 0) {
+                publish_tail(tail + count);
+            }
+
+            return count;
+        }
+
+        /**
+         * @brief Moves the front element out if the queue is not empty.
+         * @return The element if popped; otherwise std::nullopt.
+         */
+        std::optional<T> try_pop() {
+            const auto head = consumer_.head.load(std::memory_order::relaxed);
+
+            if (ready_count(head, 1) == 0) {
+                return std::nullopt;
+            }
+
+            return take(head);
+        }
+
+        /**
+         * @brief Moves the front element out, waiting while the queue is empty.
+         * @return The element.
+         */
+        T pop() {
+            const auto head = consumer_.head.load(std::memory_order::relaxed);
+
+            wait_for_items(head);
+
+            return take(head);
+        }
+
+        /**
+         * @brief Moves as many elements as available from the front.
+         * @param result The output buffer.
+         * @return The number of the popped elements.
+         */
+        std::size_t try_pop_n(std::span<T> result)
+            requires std::is_nothrow_move_assignable_v<T>
+        {
+            const auto head  = consumer_.head.load(std::memory_order::relaxed);
+            const auto count = std::min(result.size(), ready_count(head, result.size()));
+
+            return take_n(head, result.first(count));
+        }
+
+        /**
+         * @brief Moves as many elements as available from the front, waiting until there is at least one.
+         * @param result The output buffer.
+         * @return The number of the popped elements, which is zero only if the buffer is empty.
+         */
+        std::size_t pop_n(std::span<T> result)
+            requires std::is_nothrow_move_assignable_v<T>
+        {
+            if (result.empty()) {
+                return 0;
+            }
+
+            const auto head = consumer_.head.load(std::memory_order::relaxed);
+
+            wait_for_items(head);
+
+            return take_n(head, result.first(std::min(result.size(), ready_count(head, result.size()))));
+        }
+
+    private:
+        struct slot {
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        struct alignas(queue_padding_size) producer_state {
+            std::atomic<std::size_t> tail{};
+            std::size_t cached_head{};
+        };
+
+        struct alignas(queue_padding_size) consumer_state {
+            std::atomic<std::size_t> head{};
+            std::size_t cached_tail{};
+        };
+
+        T* get(std::size_t index) const noexcept {
+            return std::launder(reinterpret_cast<T*>(slots_[index & mask_].storage));
+        }
+
+        /**
+         * @brief Gets the free space, which only reloads the index of the consumer if the cached one falls short.
+         */
+        std::size_t free_space(std::size_t tail, std::size_t wanted) noexcept {
+            if (mask_ + 1 - (tail - producer_.cached_head) < wanted) {
+                producer_.cached_head = consumer_.head.load(std::memory_order::acquire);
+            }
+
+            return mask_ + 1 - (tail - producer_.cached_head);
+        }
+
+        /**
+         * @brief Gets the number of the ready elements, which only reloads the index of the producer if the cached
+         *        one falls short.
+         */
+        std::size_t ready_count(std::size_t head, std::size_t wanted) noexcept {
+            if (consumer_.cached_tail - head < wanted) {
+                consumer_.cached_tail = producer_.tail.load(std::memory_order::acquire);
+            }
+
+            return consumer_.cached_tail - head;
+        }
+
+        void wait_for_space(std::size_t tail) noexcept {
+            while (free_space(tail, 1) == 0) {
+                consumer_.head.wait(producer_.cached_head, std::memory_order::acquire);
+            }
+        }
+
+        void wait_for_items(std::size_t head) noexcept {
+            while (ready_count(head, 1) == 0) {
+                producer_.tail.wait(head, std::memory_order::acquire);
+            }
+        }
+
+        void publish_tail(std::size_t tail) noexcept {
+            producer_.tail.store(tail, std::memory_order::release);
+            producer_.tail.notify_one();
+        }
+
+        void publish_head(std::size_t head) noexcept {
+            consumer_.head.store(head, std::memory_order::release);
+            consumer_.head.notify_one();
+        }
+
+        T take(std::size_t head) {
+            const auto target = get(head);
+            T result{std::move(*target)};
+
+            std::destroy_at(target);
+            publish_head(head + 1);
+
+            return result;
+        }
+
+        std::size_t take_n(std::size_t head, std::span<T> result) noexcept {
+            for (std::size_t i = 0; i < result.size(); i++) {
+                const auto target = get(head + i);
+
+                result[i] = std::move(*target);
+                std::destroy_at(target);
+            }
+
+            if (!result.empty()) {
+                publish_head(head + result.size());
+            }
+
+            return result.size();
+        }
+
+        std::size_t mask_;
+        std::unique_ptr<slot[]> slots_;
+        producer_state producer_;
+        consumer_state consumer_;
+    };
+
+    /**
+     * @brief A bounded lock-free ring queue for any number of producer and consumer threads.
+     * @tparam T The type of the elements, which must be movable without throwing, since a claimed slot can not be
+     *         given back.
+     * @remark Every slot carries a sequence number telling which lap of the ring it is ready for, so producers and
+     *         consumers only contend on their own index and on the slots they claim. The slots are padded to
+     *         cache lines. The blocking operations sleep on the sequence number of the awaited slot.
+     */
+    template <typename T>
+        requires(std::is_nothrow_destructible_v<T> && std::is_nothrow_move_constructible_v<T>)
+    class mpmc_ring_queue {
+    public:
+        /**
+         * @brief Creates an instance.
+         * @param capacity The minimum capacity, which is rounded up to a power of two.
+         */
+        explicit mpmc_ring_queue(std::size_t capacity)
+            : mask_{round_ring_capacity(capacity) - 1}, slots_{std::make_unique<slot[]>(mask_ + 1)} {
+            for (std::size_t i = 0; i <= mask_; i++) {
+                slots_[i].sequence.store(i, std::memory_order::relaxed);
+            }
+        }
+
+        mpmc_ring_queue(const mpmc_ring_queue&) = delete;
+
+        ~mpmc_ring_queue() {
+            for (auto i = dequeue_.index.load(std::memory_order::relaxed);
+                i != enqueue_.index.load(std::memory_order::relaxed); i++) {
+                std::destroy_at(get(slots_[i & mask_]));
+            }
+        }
+
+        mpmc_ring_queue& operator=(const mpmc_ring_queue&) = delete;
+
+        [[nodiscard]] std::size_t capacity() const noexcept {
+            return mask_ + 1;
+        }
+
+        /**
+         * @brief Gets the number of the claimed elements, which is only a snapshot while the queue is in use.
+         * @return The number of the elements.
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            const auto head = dequeue_.index.load(std::memory_order::acquire);
+            const auto tail = enqueue_.index.load(std::memory_order::acquire);
+
+            return tail > head ? tail - head : 0;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /**
+         * @brief Constructs an element at the back if the queue is not full.
+         * @param args The arguments of the constructor, which must not throw.
+         * @return True if pushed; otherwise false.
+         */
+        template <typename... Args>
+            requires std::is_nothrow_constructible_v<T, Args...>
+        bool try_emplace(Args&&... args) noexcept {
+            return emplace_impl<false>(std::forward<Args>(args)...);
+        }
+
+        bool try_push(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>) {
+            if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+                return try_emplace(value);
+            } else {
+                return try_emplace(T(value));
+            }
+        }
+
+        bool try_push(T&& value) noexcept {
+            return try_emplace(std::move(value));
+        }
+
+        /**
+         * @brief Constructs an element at the back, waiting while the queue is full.
+         * @param args The arguments of the constructor, which must not throw.
+         */
+        template <typename... Args>
+            requires std::is_nothrow_constructible_v<T, Args...>
+        void emplace(Args&&... args) noexcept {
+            emplace_impl<true>(std::forward<Args>(args)...);
+        }
+
+        void push(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>) {
+            if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+                emplace(value);
+            } else {
+                emplace(T(value));
+            }
+        }
+
+        void push(T&& value) noexcept {
+            emplace(std::move(value));
+        }
+
+        /**
+         * @brief Moves as many elements as fit to the back, claiming their slots at once.
+         * @param items The elements, of which the pushed ones are left moved-from.
+         * @return The number of the pushed elements.
+         */
+        std::size_t try_push_n(std::span<T> items) noexcept {
+            const auto [first, count] = claim_n(enqueue_.index, items.size(), 0);
+
+            for (std::size_t i = 0; i < count; i++) {
+                auto&& target = slots_[(first + i) & mask_];
+
+                std::construct_at(get(target), std::move(items[i]));
+                publish(target, first + i + 1);
+            }
+
+            return count;
+        }
+
+        /**
+         * @brief Moves the front element out if the queue is not empty.
+         * @return The element if popped; otherwise std::nullopt.
+         */
+        std::optional<T> try_pop() noexcept {
+            std::optional<T> result;
+
+            pop_impl<false>([&](T& item) noexcept { result.emplace(std::move(item)); });
+
+            return result;
+        }
+
+        /**
+         * @brief Moves the front element out, waiting while the queue is empty.
+         * @return The element.
+         */
+        T pop() noexcept {
+            std::optional<T> result;
+
+            pop_impl<true>([&](T& item) noexcept { result.emplace(std::move(item)); });
+
+            return std::move(*result);
+        }
+
+        /**
+         * @brief Moves as many elements as available from the front, claiming their slots at once.
+         * @param result The output buffer.
+         * @return The number of the popped elements.
+         */
+        std::size_t try_pop_n(std::span<T> result) noexcept
+            requires std::is_nothrow_move_assignable_v<T>
+        {
+            const auto [first, count] = claim_n(dequeue_.index, result.size(), 1);
+
+            for (std::size_t i = 0; i < count; i++) {
+                auto&& target = slots_[(first + i) & mask_];
+                const auto item = get(target);
+
+                result[i] = std::move(*item);
+                std::destroy_at(item);
+                publish(target, first + i + mask_ + 1);
+            }
+
+            return count;
+        }
+
+        /**
+         * @brief Moves as many elements as available from the front, waiting until there is at least one.
+         * @param result The output buffer.
+         * @return The number of the popped elements, which is zero only if the buffer is empty.
+         */
+        std::size_t pop_n(std::span<T> result) noexcept
+            requires std::is_nothrow_move_assignable_v<T>
+        {
+            if (result.empty()) {
+                return 0;
+            }
+
+            for (;;) {
+                if (const auto count = try_pop_n(result); count != 0) {
+                    return count;
+                }
+
+                const auto index    = dequeue_.index.load(std::memory_order::relaxed);
+                auto&& target       = slots_[index & mask_];
+                const auto sequence = target.sequence.load(std::memory_order::acquire);
+
+                // Sleeps until the producer of the awaited slot publishes it.
+                if (static_cast<std::ptrdiff_t>(sequence - (index + 1)) < 0) {
+                    target.sequence.wait(sequence, std::memory_order::acquire);
+                }
+            }
+        }
+
+    private:
+        struct alignas(queue_padding_size) slot {
+            std::atomic<std::size_t> sequence;
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        struct alignas(queue_padding_size) padded_index {
+            std::atomic<std::size_t> index{};
+        };
+
+        struct claim_result {
+            std::size_t first;
+            std::size_t count;
+        };
+
+        static T* get(slot& target) noexcept {
+            return std::launder(reinterpret_cast<T*>(target.storage));
+        }
+
+        static void publish(slot& target, std::size_t sequence) noexcept {
+            target.sequence.store(sequence, std::memory_order::release);
+            target.sequence.notify_all();
+        }
+
+        /**
+         * @brief Claims up to a number of consecutive slots at an index.
+         * @param index The index of the producers or the consumers.
+         * @param max_count The maximum number of the slots.
+         * @param offset The difference between the sequence of a ready slot and its position, i.e. 0 for the
+         *               producers and 1 for the consumers.
+         * @return The position of the first claimed slot and the number of the claimed slots.
+         */
+        claim_result claim_n(std::atomic<std::size_t>& index, std::size_t max_count, std::size_t offset) noexcept {
+            auto position = index.load(std::memory_order::relaxed);
+
+            while (max_count != 0) {
+                std::size_t count{};
+
+                while (count < max_count && count <= mask_
+                       && slots_[(position + count) & mask_].sequence.load(std::memory_order::acquire)
+                              == position + count + offset) {
+                    count++;
+                }
+
+                if (count == 0) {
+                    const auto sequence = slots_[position & mask_].sequence.load(std::memory_order::acquire);
+
+                    // The slot is still held by the previous lap, so the queue is full or empty.
+                    if (static_cast<std::ptrdiff_t>(sequence - (position + offset)) < 0) {
+                        break;
+                    }
+
+                    position = index.load(std::memory_order::relaxed);
+                } else if (index.compare_exchange_weak(position, position + count, std::memory_order::relaxed)) {
+                    return claim_result{position, count};
+                }
+            }
+
+            return claim_result{position, 0};
+        }
+
+        template <bool Wait, typename... Args>
+        bool emplace_impl(Args&&... args) noexcept {
+            auto position = enqueue_.index.load(std::memory_order::relaxed);
+
+            for (;;) {
+                auto&& target       = slots_[position & mask_];
+                const auto sequence = target.sequence.load(std::memory_order::acquire);
+                const auto diff     = static_cast<std::ptrdiff_t>(sequence - position);
+
+                if (diff == 0) {
+                    if (enqueue_.index.compare_exchange_weak(position, position + 1, std::memory_order::relaxed)) {
+                        std::construct_at(get(target), std::forward<Args>(args)...);
+                        publish(target, position + 1);
+
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    if constexpr (!Wait) {
+                        return false;
+                    } else {
+                        // Sleeps until the consumer of the previous lap releases the slot.
+                        target.sequence.wait(sequence, std::memory_order::acquire);
+                        position = enqueue_.index.load(std::memory_order::relaxed);
+                    }
+                } else {
+                    position = enqueue_.index.load(std::memory_order::relaxed);
+                }
+            }
+        }
+
+        template <bool Wait, typename Handler>
+        bool pop_impl(Handler&& handler) noexcept {
+            auto position = dequeue_.index.load(std::memory_order::relaxed);
+
+            for (;;) {
+                auto&& target       = slots_[position & mask_];
+                const auto sequence = target.sequence.load(std::memory_order::acquire);
+                const auto diff     = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+                if (diff == 0) {
+                    if (dequeue_.index.compare_exchange_weak(position, position + 1, std::memory_order::relaxed)) {
+                        const auto item = get(target);
+
+                        handler(*item);
+                        std::destroy_at(item);
+                        publish(target, position + mask_ + 1);
+
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    if constexpr (!Wait) {
+                        return false;
+                    } else {
+                        // Sleeps until the producer of this lap publishes the slot.
+                        target.sequence.wait(sequence, std::memory_order::acquire);
+                        position = dequeue_.index.load(std::memory_order::relaxed);
+                    }
+                } else {
+                    position = dequeue_.index.load(std::memory_order::relaxed);
+                }
+            }
+        }
+
+        std::size_t mask_;
+        std::unique_ptr<slot[]> slots_;
+        padded_index enqueue_;
+        padded_index dequeue_;
+    };
+
+    /**
+     * @brief A bounded lock-free ring of bytes for exactly one writer thread and one reader thread, which copies
+     *        whole spans with at most two memcpy calls per side.
+     */
+    class byte_ring {
+    public:
+        /**
+         * @brief Creates an instance.
+         * @param capacity The minimum capacity in bytes, which is rounded up to a power of two.
+         */
+        explicit byte_ring(std::size_t capacity)
+            : mask_{round_ring_capacity(capacity) - 1},
+              buffer_{std::make_unique_for_overwrite<std::byte[]>(mask_ + 1)} {}
+
+        byte_ring(const byte_ring&) = delete;
+
+        byte_ring& operator=(const byte_ring&) = delete;
+
+        [[nodiscard]] std::size_t capacity() const noexcept {
+            return mask_ + 1;
+        }
+
+        /**
+         * @brief Gets the number of the readable bytes, which is only a snapshot while the ring is in use.
+         * @return The number of the readable bytes.
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            const auto head = reader_.index.load(std::memory_order::acquire);
+
+            return writer_.index.load(std::memory_order::acquire) - head;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /**
+         * @brief Writes as many bytes as fit.
+         * @param buffer The bytes.
+         * @return The number of the written bytes.
+         */
+        std::size_t try_write(std::span<const std::byte> buffer) noexcept {
+            const auto tail  = writer_.index.load(std::memory_order::relaxed);
+            const auto count = std::min(buffer.size(), writable_size(tail, buffer.size()));
+
+            if (count != 0) {
+                const auto offset = tail & mask_;
+                const auto first  = std::min(count, mask_ + 1 - offset);
+
+                std::memcpy(buffer_.get() + offset, buffer.data(), first);
+                std::memcpy(buffer_.get(), buffer.data() + first, count - first);
+                writer_.index.store(tail + count, std::memory_order::release);
+                writer_.index.notify_one();
+            }
+
+            return count;
+        }
+
+        /**
+         * @brief Writes all bytes, waiting while the ring is full.
+         * @param buffer The bytes.
+         */
+        void write(std::span<const std::byte> buffer) noexcept {
+            while (!buffer.empty()) {
+                const auto tail = writer_.index.load(std::memory_order::relaxed);
+
+                while (writable_size(tail, 1) == 0) {
+                    reader_.index.wait(writer_.cached_index, std::memory_order::acquire);
+                }
+
+                buffer = buffer.subspan(try_write(buffer));
+            }
+        }
+
+        /**
+         * @brief Reads as many bytes as available.
+         * @param buffer The output buffer.
+         * @return The number of the read bytes.
+         */
+        std::size_t try_read(std::span<std::byte> buffer) noexcept {
+            const auto head  = reader_.index.load(std::memory_order::relaxed);
+            const auto count = std::min(buffer.size(), readable_size(head, buffer.size()));
+
+            if (count != 0) {
+                const auto offset = head & mask_;
+                const auto first  = std::min(count, mask_ + 1 - offset);
+
+                std::memcpy(buffer.data(), buffer_.get() + offset, first);
+                std::memcpy(buffer.data() + first, buffer_.get(), count - first);
+                reader_.index.store(head + count, std::memory_order::release);
+                reader_.index.notify_one();
+            }
+
+            return count;
+        }
+
+        /**
+         * @brief Reads as many bytes as available, waiting until there is at least one.
+         * @param buffer The output buffer.
+         * @return The number of the read bytes, which is zero only if the buffer is empty.
+         */
+        std::size_t read(std::span<std::byte> buffer) noexcept {
+            if (buffer.empty()) {
+                return 0;
+            }
+
+            const auto head = reader_.index.load(std::memory_order::relaxed);
+
+            while (readable_size(head, 1) == 0) {
+                writer_.index.wait(head, std::memory_order::acquire);
+            }
+
+            return try_read(buffer);
+        }
+
+    private:
+        struct alignas(queue_padding_size) side_state {
+            std::atomic<std::size_t> index{};
+            std::size_t cached_index{};
+        };
+
+        std::size_t writable_size(std::size_t tail, std::size_t wanted) noexcept {
+            if (mask_ + 1 - (tail - writer_.cached_index) < wanted) {
+                writer_.cached_index = reader_.index.load(std::memory_order::acquire);
+            }
+
+            return mask_ + 1 - (tail - writer_.cached_index);
+        }
+
+        std::size_t readable_size(std::size_t head, std::size_t wanted) noexcept {
+            if (reader_.cached_index - head < wanted) {
+                reader_.cached_index = writer_.index.load(std::memory_order::acquire);
+            }
+
+            return reader_.cached_index - head;
+        }
+
+        std::size_t mask_;
+        std::unique_ptr<std::byte[]> buffer_;
+        side_state writer_;
+        side_state reader_;
+    };
+} // namespace essence::memory
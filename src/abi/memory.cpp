@@ -22,28 +22,155 @@
 
 #include "abi/memory.hpp"
 
+#include "allocator_backends.hpp"
+#include "memory/allocation_recorder.hpp"
+#include "memory/memory_resources.hpp"
+
+#include <atomic>
+#include <memory_resource>
+#include <new>
+
+namespace essence::abi {
+    namespace {
+        void* allocate_from_operator_new(
+            [[maybe_unused]] void* context, std::size_t size, std::size_t alignment) noexcept {
+            return alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                     ? ::operator new(size, std::align_val_t{alignment}, std::nothrow)
+                     : ::operator new(size, std::nothrow);
+        }
+
+        void deallocate_to_operator_delete([[maybe_unused]] void* context, void* ptr,
+            [[maybe_unused]] std::size_t size, std::size_t alignment) noexcept {
+            if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+#if __cpp_sized_deallocation >= 201309L
+                ::operator delete(ptr, size, std::align_val_t{alignment});
+#else
+                ::operator delete(ptr, std::align_val_t{alignment});
+#endif
+            } else {
+#if __cpp_sized_deallocation >= 201309L
+                ::operator delete(ptr, size);
+#else
+                ::operator delete(ptr);
+#endif
+            }
+        }
+
+        void* allocate_from_resource(void* context, std::size_t size, std::size_t alignment) noexcept {
+            try {
+                return static_cast<std::pmr::memory_resource*>(context)->allocate(size, alignment);
+            } catch (...) {
+                return nullptr;
+            }
+        }
+
+        void deallocate_to_resource(void* context, void* ptr, std::size_t size, std::size_t alignment) noexcept {
+            static_cast<std::pmr::memory_resource*>(context)->deallocate(ptr, size, alignment);
+        }
+
+#ifdef ES_DEFAULT_SIZE_CLASS_ALLOCATOR
+        constinit std::atomic<const es_allocator_backend*> current_backend{&size_class_allocator_backend};
+#else
+        constinit std::atomic<const es_allocator_backend*> current_backend{&operator_new_allocator_backend};
+#endif
+
+        // Set by the first allocation, after which switching the backend would release memory to the wrong one.
+        constinit std::atomic<bool> backend_used{};
+
+        const es_allocator_backend& acquire_backend() noexcept {
+            if (!backend_used.load(std::memory_order::relaxed)) {
+                backend_used.store(true, std::memory_order::relaxed);
+            }
+
+            return *current_backend.load(std::memory_order::acquire);
+        }
+    } // namespace
+
+    constinit const es_allocator_backend operator_new_allocator_backend{
+        .allocate   = &allocate_from_operator_new,
+        .deallocate = &deallocate_to_operator_delete,
+        .context    = nullptr,
+    };
+
+    es_allocator_backend make_allocator_backend(std::pmr::memory_resource& resource) noexcept {
+        return es_allocator_backend{
+            .allocate   = &allocate_from_resource,
+            .deallocate = &deallocate_to_resource,
+            .context    = &resource,
+        };
+    }
+} // namespace essence::abi
+
 void* es_alloc(std::size_t size) noexcept {
-    return ::operator new(size);
+#ifdef CPP_ESSENCE_HAS_ALLOCATION_PROFILING
+    essence::memory::record_allocation(size);
+#endif
+
+    const auto& backend = essence::abi::acquire_backend();
+
+    return backend.allocate(backend.context, size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
 }
 
 void* es_aligned_alloc(std::size_t size, std::size_t alignment) noexcept {
-    return ::operator new(size, std::align_val_t{alignment});
+#ifdef CPP_ESSENCE_HAS_ALLOCATION_PROFILING
+    essence::memory::record_allocation(size);
+#endif
+
+    const auto& backend = essence::abi::acquire_backend();
+
+    return backend.allocate(backend.context, size, alignment);
 }
 
 void es_dealloc(void* ptr, std::size_t size) noexcept {
-#if __cpp_sized_deallocation >= 201309L
-    ::operator delete(ptr, size);
-#else
-    ::operator delete(ptr);
+#ifdef CPP_ESSENCE_HAS_ALLOCATION_PROFILING
+    essence::memory::record_deallocation(size);
 #endif
+
+    const auto backend = essence::abi::current_backend.load(std::memory_order::acquire);
+
+    backend->deallocate(backend->context, ptr, size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
 }
 
 void es_aligned_dealloc(void* ptr, std::size_t size, std::size_t alignment) noexcept {
-#if __cpp_sized_deallocation >= 201309L
-    ::operator delete(ptr, size, std::align_val_t{alignment});
-#else
-    ::operator delete(ptr, std::align_val_t{alignment});
+#ifdef CPP_ESSENCE_HAS_ALLOCATION_PROFILING
+    essence::memory::record_deallocation(size);
 #endif
+
+    const auto backend = essence::abi::current_backend.load(std::memory_order::acquire);
+
+    backend->deallocate(backend->context, ptr, size, alignment);
+}
+
+const es_allocator_backend* es_get_allocator_backend() noexcept {
+    return essence::abi::current_backend.load(std::memory_order::acquire);
+}
+
+bool es_set_allocator_backend(const es_allocator_backend* backend) noexcept {
+    using namespace essence::abi;
+
+    if (backend_used.load(std::memory_order::acquire)) {
+        return false;
+    }
+
+    current_backend.store(backend ? backend : &operator_new_allocator_backend, std::memory_order::release);
+
+    return true;
+}
+
+const es_allocator_backend* es_get_size_class_allocator_backend() noexcept {
+    return &essence::abi::size_class_allocator_backend;
+}
+
+const es_allocator_backend* es_get_huge_page_allocator_backend() noexcept {
+    static const auto backend = essence::abi::make_allocator_backend(*essence::memory::get_huge_page_resource());
+
+    return &backend;
+}
+
+const es_allocator_backend* es_get_numa_local_allocator_backend() noexcept {
+    static const auto backend = essence::abi::make_allocator_backend(*essence::memory::get_numa_local_resource());
+
+    return &backend;
 }
 
 namespace essence::abi {
@@ -60,14 +187,14 @@ namespace essence::abi {
     uniform_allocator_base::~uniform_allocator_base() = default;
 
     void* uniform_allocator_base::allocate(std::size_t size, std::size_t alignment) noexcept {
-        return alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? es_alloc(size) : es_aligned_alloc(size, alignment);
+        return alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? es_aligned_alloc(size, alignment) : es_alloc(size);
     }
 
     void uniform_allocator_base::deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept {
         if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
-            es_dealloc(ptr, size);
-        } else {
             es_aligned_dealloc(ptr, size, alignment);
+        } else {
+            es_dealloc(ptr, size);
         }
     }
 } // namespace essence::abi
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "allocator_backends.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+namespace essence::abi {
+    namespace {
+        constexpr std::size_t granularity    = 16;
+        constexpr std::size_t max_small_size = 4096;
+        constexpr std::size_t span_size      = 64 * 1024;
+
+        // Spans are aligned to this boundary, so a class serves any alignment up to it dividing its size.
+        constexpr std::size_t span_alignment = 64;
+
+        /**
+         * @brief Computes the sizes of the classes: every 16 bytes up to 128 bytes, then four classes between two
+         *        successive powers of two, which bounds the internal fragmentation by 25%.
+         */
+        constexpr auto class_sizes = [] {
+            std::array<std::size_t, 28> result{};
+            std::size_t count{};
+
+            for (std::size_t size = granularity; size <= 128; size += granularity) {
+                result[count++] = size;
+            }
+
+            for (std::size_t base = 128; base < max_small_size; base *= 2) {
+                for (std::size_t i = 1; i <= 4; i++) {
+                    result[count++] = base + base / 4 * i;
+                }
+            }
+
+            return result;
+        }();
+
+        constexpr std::size_t class_count = class_sizes.size();
+
+        static_assert(class_sizes.back() == max_small_size);
+
+        /**
+         * @brief Maps the size rounded up to the granularity to the index of the smallest class holding it.
+         */
+        constexpr auto class_indices = [] {
+            std::array<std::uint8_t, max_small_size / granularity + 1> result{};
+            std::size_t index{};
+
+            for (std::size_t i = 0; i < result.size(); i++) {
+                while (class_sizes[index] < i * granularity) {
+                    index++;
+                }
+
+                result[i] = static_cast<std::uint8_t>(index);
+            }
+
+            return result;
+        }();
+
+        constexpr std::size_t npos = class_count;
+
+        /**
+         * @brief Selects the class of an allocation.
+         * @param size The size of the allocation.
+         * @param alignment The alignment of the allocation.
+         * @return The index of the class, or npos if the allocation is served by the global operator new.
+         */
+        constexpr std::size_t select_class(std::size_t size, std::size_t alignment) noexcept {
+            if (size > max_small_size) {
+                return npos;
+            }
+
+            const std::size_t index = class_indices[(size + granularity - 1) / granularity];
+
+            if (alignment <= granularity) {
+                return index;
+            }
+
+            return alignment <= span_alignment && class_sizes[index] % alignment == 0 ? index : npos;
+        }
+
+        /**
+         * @brief Gets the number of blocks moved between a thread cache and the central lists at a time.
+         * @param index The index of the class.
+         * @return The number of blocks.
+         */
+        constexpr std::size_t batch_size(std::size_t index) noexcept {
+            return std::clamp<std::size_t>(16 * 1024 / class_sizes[index], 4, 64);
+        }
+
+        struct free_block {
+            free_block* next;
+        };
+
+        struct free_list {
+            free_block* head;
+            std::size_t count;
+
+            void push(void* ptr) noexcept {
+                const auto block = static_cast<free_block*>(ptr);
+
+                block->next = head;
+                head        = block;
+                count++;
+            }
+
+            void* pop() noexcept {
+                const auto block = head;
+
+                head = block->next;
+                count--;
+
+                return block;
+            }
+        };
+
+        /**
+         * @brief The free blocks of one class shared by all threads, and the span where new blocks are carved.
+         */
+        struct central_list {
+            std::mutex mutex;
+            free_list blocks{};
+            std::byte* cursor{};
+            std::byte* end{};
+        };
+
+        /**
+         * @brief Gets the central lists, which are never destroyed so that threads exiting after the static
+         *        destructors can still return their blocks.
+         * @return The central lists.
+         */
+        std::array<central_list, class_count>& get_central_lists() {
+            static const auto lists = new std::array<central_list, class_count>{};
+
+            return *lists;
+        }
+
+        enum class cache_state : std::uint8_t { unregistered, active, retired };
+
+        /**
+         * @brief The free blocks owned by one thread, which are popped and pushed without any synchronization.
+         * @remark The cache is trivially destructible so that it stays accessible during the thread exit.
+         */
+        struct thread_cache {
+            std::array<free_list, class_count> lists;
+            cache_state state;
+        };
+
+        constinit thread_local thread_cache cache{};
+
+        /**
+         * @brief Moves some blocks from a thread cache to the central list.
+         * @param index The index of the class.
+         * @param list The list in the thread cache.
+         * @param count The number of the blocks.
+         */
+        void flush(std::size_t index, free_list& list, std::size_t count) noexcept {
+            if (count == 0) {
+                return;
+            }
+
+            const auto first = list.head;
+            auto last        = first;
+
+            for (std::size_t i = 1; i < count; i++) {
+                last = last->next;
+            }
+
+            list.head  = last->next;
+            list.count -= count;
+
+            auto&& central = get_central_lists()[index];
+            std::scoped_lock lock{central.mutex};
+
+            last->next           = central.blocks.head;
+            central.blocks.head  = first;
+            central.blocks.count += count;
+        }
+
+        /**
+         * @brief Returns the blocks of a thread cache to the central lists when the thread exits.
+         */
+        struct thread_cache_guard {
+            thread_cache_guard() noexcept = default;
+
+            thread_cache_guard(const thread_cache_guard&) = delete;
+
+            ~thread_cache_guard() {
+                for (std::size_t i = 0; i < class_count; i++) {
+                    flush(i, cache.lists[i], cache.lists[i].count);
+                }
+
+                cache.state = cache_state::retired;
+            }
+
+            thread_cache_guard& operator=(const thread_cache_guard&) = delete;
+
+            void touch() noexcept {}
+        };
+
+        thread_local thread_cache_guard guard;
+
+        /**
+         * @brief Moves some blocks from the central list to a list, carving new blocks from the span if needed.
+         * @param index The index of the class.
+         * @param list The list.
+         * @param count The maximum number of the blocks.
+         * @return True if any block is moved; otherwise false.
+         */
+        bool refill(std::size_t index, free_list& list, std::size_t count) noexcept {
+            const auto size = class_sizes[index];
+            auto&& central  = get_central_lists()[index];
+            std::scoped_lock lock{central.mutex};
+
+            while (count != 0 && central.blocks.head) {
+                list.push(central.blocks.pop());
+                count--;
+            }
+
+            for (; count != 0; count--) {
+                if (central.cursor == nullptr || static_cast<std::size_t>(central.end - central.cursor) < size) {
+                    // The tail of the previous span is abandoned, which is less than one block.
+                    const auto span = static_cast<std::byte*>(
+                        ::operator new(span_size, std::align_val_t{span_alignment}, std::nothrow));
+
+                    if (!span) {
+                        break;
+                    }
+
+                    central.cursor = span;
+                    central.end    = span + span_size;
+                }
+
+                list.push(central.cursor);
+                central.cursor += size;
+            }
+
+            return list.head != nullptr;
+        }
+
+        /**
+         * @brief Makes the thread cache usable.
+         * @return True if the thread cache is active; false if the thread is exiting.
+         */
+        bool activate_cache() noexcept {
+            if (cache.state == cache_state::unregistered) {
+                // Constructs the guard of this thread, whose destructor runs at the thread exit.
+                guard.touch();
+                cache.state = cache_state::active;
+            }
+
+            return cache.state == cache_state::active;
+        }
+
+        void* allocate([[maybe_unused]] void* context, std::size_t size, std::size_t alignment) noexcept {
+            const auto index = select_class(size, alignment);
+
+            if (index == npos) {
+                return operator_new_allocator_backend.allocate(nullptr, size, alignment);
+            }
+
+            auto&& list = cache.lists[index];
+
+            if (!list.head) [[unlikely]] {
+                if (!activate_cache()) {
+                    free_list single{};
+
+                    return refill(index, single, 1) ? single.pop() : nullptr;
+                }
+
+                if (!refill(index, list, batch_size(index))) {
+                    return nullptr;
+                }
+            }
+
+            return list.pop();
+        }
+
+        void deallocate([[maybe_unused]] void* context, void* ptr, std::size_t size, std::size_t alignment) noexcept {
+            if (!ptr) {
+                return;
+            }
+
+            const auto index = select_class(size, alignment);
+
+            if (index == npos) {
+                return operator_new_allocator_backend.deallocate(nullptr, ptr, size, alignment);
+            }
+
+            auto&& list = cache.lists[index];
+
+            if (cache.state != cache_state::active) [[unlikely]] {
+                if (!activate_cache()) {
+                    free_list single{};
+
+                    single.push(ptr);
+
+                    return flush(index, single, 1);
+                }
+            }
+
+            list.push(ptr);
+
+            // Keeps at most two batches, so that a thread releasing what others allocate does not hoard the blocks.
+            if (const auto batch = batch_size(index); list.count > batch * 2) {
+                flush(index, list, batch);
+            }
+        }
+    } // namespace
+
+    constinit const es_allocator_backend size_class_allocator_backend{
+        .allocate   = &allocate,
+        .deallocate = &deallocate,
+        .context    = nullptr,
+    };
+} // namespace essence::abi
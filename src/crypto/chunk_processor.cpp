@@ -25,7 +25,7 @@
 #include "char8_t_remediation.hpp"
 #include "error_extensions.hpp"
 #include "inout_buffer_pair.hpp"
-#include "memory.hpp"
+#include "memory/aligned_buffer.hpp"
 #include "memory/swapping_buffer.hpp"
 #include "rational.hpp"
 
@@ -52,7 +52,7 @@ namespace essence::crypto {
                                    ? throw source_code_aware_runtime_error{U8(
                                          "At least two processors are required to be chained together.")}
                                    : calculate_max_buffer_size(processors)},
-                  finalization_buffer_{make_unique_array<std::byte>(buffer_pair_.buffer->size())},
+                  finalization_buffer_{buffer_pair_.buffer.size(), memory::for_overwrite},
                   swapper_{buffer_pair_.in, buffer_pair_.out} {
                 if (std::ranges::adjacent_find(
                         processors, std::not_equal_to{}, [](const auto& inner) { return inner.transformer(); })
@@ -109,7 +109,7 @@ namespace essence::crypto {
             }
 
             [[maybe_unused]] void finalize(std::span<std::byte>& output) {
-                const auto scope = swapper_.set_temporary_out(*finalization_buffer_, *buffer_pair_.buffer);
+                const auto scope = swapper_.set_temporary_out(finalization_buffer_.span(), buffer_pair_.buffer.span());
 
                 // The first iteration.
                 processors_.front().finalize(swapper_.out());
@@ -144,7 +144,7 @@ namespace essence::crypto {
 
         private:
             inout_buffer_pair buffer_pair_;
-            unique_array<std::byte> finalization_buffer_;
+            memory::aligned_buffer<std::byte> finalization_buffer_;
             memory::swapping_buffer<std::byte> swapper_;
             std::vector<abstract::chunk_processor> processors_;
         };
@@ -24,6 +24,7 @@
 #include "chunk_processing_helper.hpp"
 #include "cipher_error_builder.hpp"
 #include "crypto/chunk_processor.hpp"
+#include "memory/generic_resource_pool.hpp"
 
 #include <cstdint>
 #include <memory>
@@ -37,6 +38,21 @@ namespace essence::crypto {
     namespace {
         constexpr auto encode_ctx_deleter = [](EVP_ENCODE_CTX* inner) { EVP_ENCODE_CTX_free(inner); };
 
+        using encode_context_ptr = std::unique_ptr<EVP_ENCODE_CTX, decltype(encode_ctx_deleter)>;
+
+        const generic_resource_pool<encode_context_ptr>& get_encode_context_pool() {
+            // No reset hook is needed since init() always reinitializes the context.
+            static const generic_resource_pool<encode_context_ptr> pool{[] {
+                if (encode_context_ptr context{EVP_ENCODE_CTX_new()}) {
+                    return context;
+                }
+
+                throw source_code_aware_runtime_error{U8("Failed to allocate the base64 encoding context.")};
+            }};
+
+            return pool;
+        }
+
         const cipher_error_builder encoding_builder{
             .cipher_name  = U8("base64"),
             .routine_name = U8("Encoding"),
@@ -67,13 +83,7 @@ namespace essence::crypto {
             using finalize_result_type = std::conditional_t<Encoder, void, std::int32_t>;
 
             explicit base64_processor(bool newlines)
-                : flags_{newlines ? 0U : 1U}, context_{[] {
-                      if (auto context = EVP_ENCODE_CTX_new()) {
-                          return context;
-                      }
-
-                      throw source_code_aware_runtime_error{U8("Failed to allocate the base64 encoding context.")};
-                  }()},
+                : flags_{newlines ? 0U : 1U}, context_{get_encode_context_pool().acquire()},
                   helper_{[]() -> const auto& {
                       if constexpr (Encoder) {
                           return base64_encoding_helper;
@@ -112,24 +122,24 @@ namespace essence::crypto {
 
             void init() const {
                 if constexpr (Encoder) {
-                    EVP_EncodeInit(context_.get());
-                    evp_encode_ctx_set_flags(context_.get(), flags_);
+                    EVP_EncodeInit(context_->get());
+                    evp_encode_ctx_set_flags(context_->get(), flags_);
                 } else {
-                    EVP_DecodeInit(context_.get());
+                    EVP_DecodeInit(context_->get());
                 }
             }
 
             void update(std::span<const std::byte> input, std::span<std::byte>& output) const {
-                helper_.update(context_.get(), input, output);
+                helper_.update(context_->get(), input, output);
             }
 
             void finalize(std::span<std::byte>& output) const {
-                helper_.finalize(context_.get(), output);
+                helper_.finalize(context_->get(), output);
             }
 
         private:
             std::uint32_t flags_;
-            std::unique_ptr<EVP_ENCODE_CTX, decltype(encode_ctx_deleter)> context_;
+            generic_resource_pool<encode_context_ptr>::lease context_;
             const chunk_processing_helper<EVP_ENCODE_CTX, finalize_result_type>& helper_;
         };
     } // namespace
@@ -25,6 +25,8 @@
 #include "cipher_error_builder.hpp"
 #include "crypto/chunk_processor.hpp"
 #include "crypto/symmetric_cipher_util.hpp"
+#include "error_extensions.hpp"
+#include "memory/generic_resource_pool.hpp"
 
 #include <cstdint>
 #include <memory>
@@ -36,6 +38,22 @@ namespace essence::crypto {
         constexpr std::array padding_modes{0, EVP_PADDING_PKCS7};
         constexpr auto cipher_ctx_deleter = [](EVP_CIPHER_CTX* inner) { EVP_CIPHER_CTX_free(inner); };
 
+        using cipher_context_ptr = std::unique_ptr<EVP_CIPHER_CTX, decltype(cipher_ctx_deleter)>;
+
+        const generic_resource_pool<cipher_context_ptr>& get_cipher_context_pool() {
+            static const generic_resource_pool<cipher_context_ptr> pool{
+                [] {
+                    if (cipher_context_ptr context{EVP_CIPHER_CTX_new()}) {
+                        return context;
+                    }
+
+                    throw source_code_aware_runtime_error{U8("Failed to allocate the cipher context.")};
+                },
+                [](cipher_context_ptr& context) { return EVP_CIPHER_CTX_reset(context.get()) == 1; }};
+
+            return pool;
+        }
+
         class symmetric_cipher_processor {
         public:
             symmetric_cipher_processor(zstring_view cipher_name, cipher_padding_mode padding_mode,
@@ -51,7 +69,7 @@ namespace essence::crypto {
                       .check_error  = [this](std::int32_t code,
                                          std::string_view message) { builder_.check_error(code, message); },
                   },
-                  context_{EVP_CIPHER_CTX_new()} {
+                  context_{get_cipher_context_pool().acquire()} {
 
                 if (builder_.cipher_name.empty()) {
                     builder_.raise_error(U8("The cipher name must be non-empty."));
@@ -75,7 +93,7 @@ namespace essence::crypto {
                         U8("The actual IV length must be equal to the expected IV length of the cipher."));
                 }
 
-                builder_.check_error(EVP_CipherInit_ex(context_.get(), static_cast<const EVP_CIPHER*>(cipher_info->id),
+                builder_.check_error(EVP_CipherInit_ex(context_->get(), static_cast<const EVP_CIPHER*>(cipher_info->id),
                                          nullptr, reinterpret_cast<const std::uint8_t*>(key.data()),
                                          reinterpret_cast<const std::uint8_t*>(iv.data()), encryption),
                     U8("An error occurred during the initialization."));
@@ -102,21 +120,23 @@ namespace essence::crypto {
             }
 
             [[maybe_unused]] void init() const {
-                builder_.check_error(EVP_CipherInit_ex(context_.get(), nullptr, nullptr, nullptr, nullptr, encryption_),
+                const auto context = context_->get();
+
+                builder_.check_error(EVP_CipherInit_ex(context, nullptr, nullptr, nullptr, nullptr, encryption_),
                     U8("An error occurred during the re-initialization."));
 
                 // Always succeeds.
                 // https://www.openssl.org/docs/man1.0.2/man3/EVP_CIPHER_CTX_set_padding.html
                 static_cast<void>(
-                    EVP_CIPHER_CTX_set_padding(context_.get(), padding_modes[static_cast<std::size_t>(padding_mode_)]));
+                    EVP_CIPHER_CTX_set_padding(context, padding_modes[static_cast<std::size_t>(padding_mode_)]));
             }
 
             [[maybe_unused]] void update(std::span<const std::byte> input, std::span<std::byte>& output) const {
-                helper_.update(context_.get(), input, output);
+                helper_.update(context_->get(), input, output);
             }
 
             [[maybe_unused]] void finalize(std::span<std::byte>& output) const {
-                helper_.finalize(context_.get(), output);
+                helper_.finalize(context_->get(), output);
             }
 
         private:
@@ -124,7 +144,7 @@ namespace essence::crypto {
             cipher_padding_mode padding_mode_;
             const cipher_error_builder builder_;
             const chunk_processing_helper<EVP_CIPHER_CTX> helper_;
-            std::unique_ptr<EVP_CIPHER_CTX, decltype(cipher_ctx_deleter)> context_;
+            generic_resource_pool<cipher_context_ptr>::lease context_;
         };
     } // namespace
 
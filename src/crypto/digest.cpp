@@ -24,14 +24,19 @@
 
 #include "char8_t_remediation.hpp"
 #include "error_extensions.hpp"
+#include "memory/generic_resource_pool.hpp"
 #include "util.hpp"
 
 #include <algorithm>
 #include <array>
 #include <concepts>
 #include <cstdint>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 
 #include <openssl/crypto.h>
@@ -114,26 +119,99 @@ namespace essence::crypto {
             return result;
         }
 
-        template <std::invocable<EVP_MD_CTX*> Callable>
-        abi::string make_digest_impl(digest_mode mode, Callable&& update_handler) {
-            std::unique_ptr<EVP_MD_CTX, decltype([](EVP_MD_CTX* inner) { EVP_MD_CTX_free(inner); })> context{
-                EVP_MD_CTX_new()};
+        using md_context_ptr = std::unique_ptr<EVP_MD_CTX, decltype([](EVP_MD_CTX* inner) { EVP_MD_CTX_free(inner); })>;
+        using digest_context_ptr = generic_resource_pool<md_context_ptr>::lease;
+
+        const generic_resource_pool<md_context_ptr>& get_digest_context_pool() {
+            // EVP_MD_CTX_reset frees the digest state (md_data) and the EVP_PKEY_CTX, so reusing a context only
+            // saves allocating the EVP_MD_CTX itself; the state is allocated again by every EVP_DigestInit_ex.
+            static const generic_resource_pool<md_context_ptr> pool{
+                [] {
+                    if (md_context_ptr context{EVP_MD_CTX_new()}) {
+                        return context;
+                    }
+
+                    throw source_code_aware_runtime_error{U8("Failed to create the digest context.")};
+                },
+                [](md_context_ptr& context) { return EVP_MD_CTX_reset(context.get()) == 1; }};
 
-            if (!EVP_DigestInit_ex2(context.get(), make_digest_routine(mode), nullptr)) {
+            return pool;
+        }
+
+        digest_context_ptr make_digest_context(digest_mode mode) {
+            auto context = get_digest_context_pool().acquire();
+
+            if (!EVP_DigestInit_ex2(context->get(), make_digest_routine(mode), nullptr)) {
                 throw source_code_aware_runtime_error{U8("Failed to initialize the digest.")};
             }
 
-            std::forward<Callable>(update_handler)(context.get());
+            return context;
+        }
 
+        abi::string finalize_digest(EVP_MD_CTX* context) {
             std::uint32_t hash_size{};
             thread_local std::array<std::byte, EVP_MAX_MD_SIZE> hash{};
 
-            if (!EVP_DigestFinal_ex(context.get(), reinterpret_cast<std::uint8_t*>(hash.data()), &hash_size)) {
+            if (!EVP_DigestFinal_ex(context, reinterpret_cast<std::uint8_t*>(hash.data()), &hash_size)) {
                 throw source_code_aware_runtime_error{U8("Failed to finalize the digest.")};
             }
 
             return hex_encode(std::span<const std::byte>{hash.data(), hash_size});
         }
+
+        template <std::invocable<EVP_MD_CTX*> Callable>
+        abi::string make_digest_impl(digest_mode mode, Callable&& update_handler) {
+            const auto context = make_digest_context(mode);
+
+            std::forward<Callable>(update_handler)(context->get());
+
+            return finalize_digest(context->get());
+        }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+        /**
+         * @brief The state of digesting a file asynchronously, which reads the next chunk when the previous one has
+         *        been digested so that at most one chunk of each file is in memory. The file is opened once, so a
+         *        file replaced on the path meanwhile is never mixed into the digest.
+         */
+        struct file_digest_state {
+            static constexpr std::size_t chunk_size = 1024 * 1024;
+
+            const io::async_file_engine& engine;
+            std::optional<io::async_read_file> file{};
+            digest_context_ptr context;
+            std::uint64_t offset{};
+            std::promise<abi::string> promise{};
+
+            static void read_next(const std::shared_ptr<file_digest_state>& state) {
+                const io::async_read_request request{.offset = state->offset, .length = chunk_size};
+                const auto& file = *state->file;
+
+                state->engine.read(file, request, [state](io::async_read_result result, std::exception_ptr error) {
+                    try {
+                        if (error) {
+                            std::rethrow_exception(error);
+                        }
+
+                        if (!EVP_DigestUpdate(state->context->get(), result.data.data(), result.data.size())) {
+                            throw source_code_aware_runtime_error{U8("Chunk size"), result.data.size(),
+                                U8("Message"), U8("Failed to update the digest by the current chunk.")};
+                        }
+
+                        state->offset += result.data.size();
+
+                        if (result.data.empty() || state->offset >= result.file_size) {
+                            state->promise.set_value(finalize_digest(state->context->get()));
+                        } else {
+                            read_next(state);
+                        }
+                    } catch (...) {
+                        state->promise.set_exception(std::current_exception());
+                    }
+                });
+            }
+        };
+#endif
     } // namespace
 
     abi::string hex_encode(std::span<const std::byte> buffer, std::optional<char> delimiter) {
@@ -253,4 +331,32 @@ namespace essence::crypto {
             }
         });
     }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+    abi::vector<std::future<abi::string>> make_file_digests_async(
+        digest_mode mode, std::span<const std::string_view> paths, const io::async_file_engine& engine) {
+        abi::vector<std::future<abi::string>> result;
+
+        result.reserve(paths.size());
+
+        for (auto&& item : paths) {
+            auto state = std::make_shared<file_digest_state>(
+                file_digest_state{.engine = engine, .context = make_digest_context(mode)});
+
+            result.emplace_back(state->promise.get_future());
+
+            try {
+                state->file.emplace(item);
+            } catch (...) {
+                state->promise.set_exception(std::current_exception());
+
+                continue;
+            }
+
+            file_digest_state::read_next(state);
+        }
+
+        return result;
+    }
+#endif
 } // namespace essence::crypto
@@ -35,8 +35,8 @@ namespace essence::crypto {
         : inout_buffer_pair{processor.buffer_size(), calculate_output_buffer_size(processor)} {}
 
     inout_buffer_pair::inout_buffer_pair(std::size_t input_size, std::size_t output_size)
-        : buffer{make_unique_array<std::byte>(input_size + output_size)}, in{buffer->data(), input_size},
-          out{buffer->data() + in.size(), buffer->size() - in.size()} {}
+        : buffer{input_size + output_size, memory::for_overwrite}, in{buffer.data(), input_size},
+          out{buffer.data() + in.size(), buffer.size() - in.size()} {}
 
     inout_buffer_pair::inout_buffer_pair(inout_buffer_pair&&) noexcept = default;
 
@@ -22,7 +22,7 @@
 
 #pragma once
 
-#include "memory.hpp"
+#include "memory/aligned_buffer.hpp"
 
 #include <cstddef>
 #include <memory>
@@ -34,7 +34,7 @@ namespace essence::crypto::abstract {
 
 namespace essence::crypto {
     struct inout_buffer_pair {
-        unique_array<std::byte> buffer;
+        memory::aligned_buffer<std::byte> buffer;
         std::span<std::byte> in;
         std::span<std::byte> out;
 
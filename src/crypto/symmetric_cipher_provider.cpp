@@ -22,7 +22,9 @@
 
 #include "crypto/symmetric_cipher_provider.hpp"
 
+#include "char8_t_remediation.hpp"
 #include "crypto/digest.hpp"
+#include "memory/allocation_profiler.hpp"
 
 #include <algorithm>
 #include <array>
@@ -75,6 +77,7 @@ namespace essence::crypto {
             static constexpr std::size_t intermediate_size = 4096;
             thread_local std::array<std::byte, intermediate_size + EVP_MAX_BLOCK_LENGTH> intermediate;
 
+            const memory::alloc_scope scope{U8("crypto")};
             Container result;
 
             auto intermediate_data =
@@ -29,15 +29,15 @@
 #include "common_constants.hpp"
 #include "crypto/digest.hpp"
 #include "error_extensions.hpp"
+#include "io/memory_stream.hpp"
 
-#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <ostream>
 #include <ranges>
-#include <span>
 #include <string_view>
 #include <utility>
 
@@ -50,6 +50,24 @@ namespace essence::globalization {
                    });
         }
 
+        void write_language_file(const abi::json& json, std::ostream& stream) {
+            // Writes the header.
+            stream.write(common_constants::language_file_magic_flag.data(),
+                static_cast<std::streamsize>(common_constants::language_file_magic_flag.size()));
+
+            stream.write(reinterpret_cast<const char*>(common_constants::language_file_version.data()),
+                static_cast<std::streamsize>(common_constants::language_file_version.size()));
+
+            // Writes translated texts.
+
+            for (const auto items = json.items(); auto&& [key, value] : get_key_value_pairs(items)) {
+                stream.write(key.data(), static_cast<std::streamsize>(key.size()));
+                stream.put(common_constants::language_key_value_delimiter);
+                stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+                stream.put(common_constants::language_key_value_terminator);
+            }
+        }
+
         struct default_compiler {
             [[maybe_unused]] static std::uint32_t version() noexcept {
                 return common_constants::language_file_version_number;
@@ -66,43 +84,15 @@ namespace essence::globalization {
                         U8("Failed to create the language file."), U8("Internal"), ex.what()};
                 }
 
-                // Writes the header.
-                stream.write(common_constants::language_file_magic_flag.data(),
-                    static_cast<std::streamsize>(common_constants::language_file_magic_flag.size()));
-
-                stream.write(reinterpret_cast<const char*>(common_constants::language_file_version.data()),
-                    static_cast<std::streamsize>(common_constants::language_file_version.size()));
-
-                // Writes translated texts.
-
-                for (const auto items = json.items(); auto&& [key, value] : get_key_value_pairs(items)) {
-                    stream.write(key.data(), static_cast<std::streamsize>(key.size()));
-                    stream.put(common_constants::language_key_value_delimiter);
-                    stream.write(value.data(), static_cast<std::streamsize>(value.size()));
-                    stream.put(common_constants::language_key_value_terminator);
-                }
+                write_language_file(json, stream);
             }
 
             static abi::vector<std::byte> to_bytes(const abi::json& json) {
-                abi::vector<std::byte> result;
-
-                // Writes the header.
-                std::ranges::copy(
-                    std::as_bytes(std::span{common_constants::language_file_magic_flag}), std::back_inserter(result));
+                io::memory_ostream stream;
 
-                std::ranges::copy(
-                    std::as_bytes(std::span{common_constants::language_file_version}), std::back_inserter(result));
-
-                // Writes translated texts.
-
-                for (const auto items = json.items(); auto&& [key, value] : get_key_value_pairs(items)) {
-                    std::ranges::copy(std::as_bytes(std::span{key}), std::back_inserter(result));
-                    result.emplace_back(static_cast<std::byte>(common_constants::language_key_value_delimiter));
-                    std::ranges::copy(std::as_bytes(std::span{value}), std::back_inserter(result));
-                    result.emplace_back(static_cast<std::byte>(common_constants::language_key_value_terminator));
-                }
+                write_language_file(json, stream);
 
-                return result;
+                return stream.release();
             }
 
             [[maybe_unused]] static abi::string to_base64(const abi::json& json) {
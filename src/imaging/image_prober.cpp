@@ -33,6 +33,7 @@
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <ranges>
 #include <type_traits>
 #include <unordered_map>
@@ -107,6 +108,37 @@ namespace essence::imaging {
             return header;
         }
 
+#ifdef CPP_ESSENCE_HAS_THREADS
+        [[nodiscard]] abi::vector<std::future<std::optional<image_general_header>>> extract_header_async(
+            std::span<const std::string_view> paths, const io::async_file_engine& engine) const {
+            abi::vector<std::future<std::optional<image_general_header>>> result;
+
+            result.reserve(paths.size());
+
+            for (auto&& item : paths) {
+                auto promise = std::make_shared<std::promise<std::optional<image_general_header>>>();
+
+                result.emplace_back(promise->get_future());
+
+                // The extractors may look anywhere in the file, so the whole file is read.
+                engine.read(io::async_read_request{.path = item},
+                    [this, promise](io::async_read_result file, std::exception_ptr error) {
+                        try {
+                            if (error) {
+                                std::rethrow_exception(error);
+                            }
+
+                            promise->set_value(extract_header(std::span<const std::byte>{file.data}));
+                        } catch (...) {
+                            promise->set_exception(std::current_exception());
+                        }
+                    });
+            }
+
+            return result;
+        }
+#endif
+
     private:
         template <typename T>
             requires((std::same_as<std::decay_t<T>, std::istream> && std::is_lvalue_reference_v<T>)
@@ -150,4 +182,11 @@ namespace essence::imaging {
     std::optional<image_general_header> image_prober::extract_header(std::span<const std::byte> buffer) const {
         return impl_->extract_header(buffer);
     }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+    abi::vector<std::future<std::optional<image_general_header>>> image_prober::extract_header_async(
+        std::span<const std::string_view> paths, const io::async_file_engine& engine) const {
+        return impl_->extract_header_async(paths, engine);
+    }
+#endif
 } // namespace essence::imaging
@@ -0,0 +1,762 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "io/async_file_io.hpp"
+
+#include "char8_t_remediation.hpp"
+#include "error_extensions.hpp"
+#include "native_file.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ES_HAS_IO_URING 1
+#endif
+
+#ifdef ES_HAS_IO_URING
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace essence::io {
+    namespace {
+        /**
+         * @brief An operation in flight, which owns the file and the buffer until it completes.
+         */
+        struct operation {
+            operation(std::shared_ptr<const native_file> file, std::string_view path, bool writing)
+                : file{std::move(file)}, path{path}, writing{writing} {}
+
+            std::shared_ptr<const native_file> file;
+            std::string path;
+            bool writing;
+            std::uint64_t offset{};
+            std::uint64_t file_size{};
+            abi::vector<std::byte> buffer;
+            std::size_t transferred{};
+            async_read_callback on_read;
+            async_write_callback on_write;
+
+#ifdef ES_HAS_IO_URING
+            iovec vector{};
+#endif
+
+            void complete(std::exception_ptr error) noexcept {
+                // An exception escaping from a callback would terminate the internal thread.
+                try {
+                    if (writing) {
+                        on_write(error);
+                    } else {
+                        buffer.resize(transferred);
+                        on_read(async_read_result{std::move(buffer), file_size}, error);
+                    }
+                } catch (...) {
+                }
+            }
+
+            /**
+             * @brief Performs the remaining transfer synchronously.
+             */
+            void run() noexcept {
+                try {
+                    if (writing) {
+                        file->write(std::span{buffer}.subspan(transferred));
+                        transferred = buffer.size();
+                    } else {
+                        transferred += file->read_at(offset + transferred, std::span{buffer}.subspan(transferred));
+                    }
+
+                    complete(nullptr);
+                } catch (...) {
+                    complete(std::current_exception());
+                }
+            }
+        };
+
+        std::unique_ptr<operation> make_read_operation(
+            std::shared_ptr<const native_file> file, std::string_view path, const async_read_request& request) {
+            auto result       = std::make_unique<operation>(std::move(file), path, false);
+            result->file_size = result->file->size();
+
+            // Clamps the range to the file.
+            const auto offset = std::min(request.offset, result->file_size);
+            const auto length = std::min<std::uint64_t>(request.length, result->file_size - offset);
+
+            result->offset = request.origin == std::ios_base::end ? result->file_size - offset - length : offset;
+            result->buffer.resize(static_cast<std::size_t>(length));
+
+            return result;
+        }
+
+        std::unique_ptr<operation> make_write_operation(std::string_view path, std::span<const std::byte> buffer) {
+            auto result = std::make_unique<operation>(
+                std::make_shared<const native_file>(native_file::open_write(path)), path, true);
+
+            result->buffer.assign(buffer.begin(), buffer.end());
+
+            return result;
+        }
+
+        class async_io_engine_base {
+        public:
+            virtual ~async_io_engine_base() = default;
+
+            [[nodiscard]] virtual async_io_backend backend() const noexcept = 0;
+
+            virtual void submit(std::unique_ptr<operation> op) = 0;
+        };
+
+        class thread_pool_engine final : public async_io_engine_base {
+        public:
+            explicit thread_pool_engine(std::uint32_t worker_count) {
+                const auto count = worker_count == 0 ? std::max(std::thread::hardware_concurrency(), 1U) : worker_count;
+
+                for (std::uint32_t i = 0; i < count; i++) {
+                    workers_.emplace_back([this] { run(); });
+                }
+            }
+
+            ~thread_pool_engine() override {
+                {
+                    std::scoped_lock lock{mutex_};
+
+                    stopping_ = true;
+                }
+
+                condition_.notify_all();
+
+                for (auto&& item : workers_) {
+                    item.join();
+                }
+            }
+
+            [[nodiscard]] async_io_backend backend() const noexcept override {
+                return async_io_backend::thread_pool;
+            }
+
+            void submit(std::unique_ptr<operation> op) override {
+                {
+                    std::scoped_lock lock{mutex_};
+
+                    queue_.emplace_back(std::move(op));
+                }
+
+                condition_.notify_one();
+            }
+
+        private:
+            void run() {
+                for (;;) {
+                    std::unique_lock lock{mutex_};
+
+                    // Drains the queue before stopping.
+                    condition_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+
+                    if (queue_.empty()) {
+                        return;
+                    }
+
+                    const auto op = std::move(queue_.front());
+
+                    queue_.pop_front();
+                    lock.unlock();
+                    op->run();
+                }
+            }
+
+            std::mutex mutex_;
+            std::condition_variable condition_;
+            std::deque<std::unique_ptr<operation>> queue_;
+            std::vector<std::thread> workers_;
+            bool stopping_{};
+        };
+
+#ifdef ES_HAS_IO_URING
+        [[noreturn]] void throw_uring_error(const char* message, std::int32_t code) {
+            throw source_code_aware_runtime_error{
+                U8("Message"), message, U8("Internal"), std::system_category().message(code)};
+        }
+
+        template <typename T>
+        T* offset_pointer(void* base, std::uint32_t offset) noexcept {
+            return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+        }
+
+        /**
+         * @brief An engine on io_uring, which talks to the kernel through the raw system calls. A single thread reaps
+         *        the completions and resubmits short transfers.
+         */
+        class io_uring_engine final : public async_io_engine_base {
+        public:
+            explicit io_uring_engine(std::uint32_t queue_depth) {
+                io_uring_params params{};
+
+                fd_ = static_cast<std::int32_t>(
+                    syscall(__NR_io_uring_setup, std::bit_ceil(std::clamp(queue_depth, 1U, 4096U)), &params));
+
+                if (fd_ < 0) {
+                    throw_uring_error(U8("Failed to set up io_uring."), errno);
+                }
+
+                try {
+                    map_rings(params);
+                    submitting_.reserve(sq_entries_);
+                } catch (...) {
+                    unmap_rings();
+                    close(fd_);
+                    throw;
+                }
+
+                reaper_ = std::thread{[this] { reap(); }};
+            }
+
+            ~io_uring_engine() override {
+                std::int32_t code{};
+
+                {
+                    std::unique_lock lock{mutex_};
+
+                    idle_condition_.wait(lock, [this] { return outstanding_ == 0; });
+
+                    // A no-op without an operation tells the reaper to exit.
+                    prepare_sqe(IORING_OP_NOP, -1, nullptr, 0);
+
+                    while ((code = enter(1, 0, 0)) == 0 || is_transient_error(code)) {
+                        std::this_thread::yield();
+                    }
+                }
+
+                // Nothing can wake the reaper up then, so it is left blocked with the ring instead of freeing the
+                // ring under it.
+                if (code < 0) {
+                    reaper_.detach();
+
+                    return;
+                }
+
+                reaper_.join();
+                unmap_rings();
+                close(fd_);
+            }
+
+            [[nodiscard]] async_io_backend backend() const noexcept override {
+                return async_io_backend::io_uring;
+            }
+
+            void submit(std::unique_ptr<operation> op) override {
+                std::vector<completion> failed;
+
+                {
+                    std::scoped_lock lock{mutex_};
+
+                    pending_.emplace_back(op.get());
+                    static_cast<void>(op.release());
+                    ++outstanding_;
+                    flush();
+                    failed.swap(failed_);
+                }
+
+                // The operations refused by the kernel are owned by the engine already, so they fail through their
+                // callbacks rather than by an exception.
+                finish(failed);
+            }
+
+        private:
+            /**
+             * @brief A finished operation along with the error code, or zero on success.
+             */
+            using completion = std::pair<operation*, std::int32_t>;
+
+            static bool is_transient_error(std::int32_t code) noexcept {
+                return code == -EAGAIN || code == -EBUSY;
+            }
+
+            void map_rings(const io_uring_params& params) {
+                sq_size_ = params.sq_off.array + params.sq_entries * sizeof(std::uint32_t);
+                cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+                if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+                    sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+                }
+
+                sq_ring_ = map(sq_size_, IORING_OFF_SQ_RING);
+                cq_ring_  = (params.features & IORING_FEAT_SINGLE_MMAP) != 0 ? sq_ring_
+                                                                             : map(cq_size_, IORING_OFF_CQ_RING);
+                sqe_size_ = params.sq_entries * sizeof(io_uring_sqe);
+                sqes_     = static_cast<io_uring_sqe*>(map(sqe_size_, IORING_OFF_SQES));
+
+                sq_tail_    = offset_pointer<std::uint32_t>(sq_ring_, params.sq_off.tail);
+                sq_mask_    = *offset_pointer<std::uint32_t>(sq_ring_, params.sq_off.ring_mask);
+                sq_array_   = offset_pointer<std::uint32_t>(sq_ring_, params.sq_off.array);
+                sq_entries_ = params.sq_entries;
+                cq_head_    = offset_pointer<std::uint32_t>(cq_ring_, params.cq_off.head);
+                cq_tail_    = offset_pointer<std::uint32_t>(cq_ring_, params.cq_off.tail);
+                cq_mask_    = *offset_pointer<std::uint32_t>(cq_ring_, params.cq_off.ring_mask);
+                cqes_       = offset_pointer<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+            }
+
+            void* map(std::size_t size, std::uint64_t offset) const {
+                const auto result = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                    static_cast<off_t>(offset));
+
+                if (result == MAP_FAILED) {
+                    throw_uring_error(U8("Failed to map the rings of io_uring."), errno);
+                }
+
+                return result;
+            }
+
+            void unmap_rings() noexcept {
+                if (sqes_) {
+                    munmap(sqes_, sqe_size_);
+                }
+
+                if (cq_ring_ && cq_ring_ != sq_ring_) {
+                    munmap(cq_ring_, cq_size_);
+                }
+
+                if (sq_ring_) {
+                    munmap(sq_ring_, sq_size_);
+                }
+            }
+
+            /**
+             * @brief Enters io_uring, retrying on interruptions.
+             * @return The result of the system call, or the negated error code.
+             */
+            std::int32_t enter(
+                std::uint32_t to_submit, std::uint32_t min_complete, std::uint32_t flags) const noexcept {
+                for (;;) {
+                    const auto result = static_cast<std::int32_t>(
+                        syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags, nullptr, 0));
+
+                    if (result >= 0 || errno != EINTR) {
+                        return result >= 0 ? result : -errno;
+                    }
+                }
+            }
+
+            void prepare_sqe(std::uint8_t opcode, std::int32_t fd, operation* op, std::uint64_t offset) noexcept {
+                const auto tail  = *sq_tail_;
+                const auto index = tail & sq_mask_;
+                auto&& sqe       = sqes_[index];
+
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode    = opcode;
+                sqe.fd        = fd;
+                sqe.off       = offset;
+                sqe.user_data = reinterpret_cast<std::uint64_t>(op);
+
+                if (op) {
+                    sqe.addr = reinterpret_cast<std::uint64_t>(&op->vector);
+                    sqe.len  = 1;
+                }
+
+                sq_array_[index] = index;
+                std::atomic_ref{*sq_tail_}.store(tail + 1, std::memory_order::release);
+            }
+
+            /**
+             * @brief Moves the pending operations into the submission queue as far as the queue depth allows.
+             *        The operations refused by the kernel are moved to failed_, unless the error is transient and
+             *        the reaper will retry them after the next completion.
+             */
+            void flush() {
+                submitting_.clear();
+
+                for (; in_flight_ < sq_entries_ && !pending_.empty(); ++in_flight_) {
+                    const auto op = pending_.front();
+
+                    pending_.pop_front();
+                    op->vector = iovec{.iov_base = op->buffer.data() + op->transferred,
+                        .iov_len                 = op->buffer.size() - op->transferred};
+                    prepare_sqe(op->writing ? IORING_OP_WRITEV : IORING_OP_READV,
+                        static_cast<std::int32_t>(op->file->handle().get()), op, op->offset + op->transferred);
+                    submitting_.emplace_back(op);
+                }
+
+                for (std::size_t submitted{}; submitted < submitting_.size();) {
+                    const auto result = enter(static_cast<std::uint32_t>(submitting_.size() - submitted), 0, 0);
+
+                    if (result <= 0) {
+                        return roll_back(submitted, result == 0 ? -EAGAIN : result);
+                    }
+
+                    submitted += static_cast<std::size_t>(result);
+                }
+            }
+
+            /**
+             * @brief Takes back the entries the kernel has not consumed, which is safe since the kernel only reads the
+             *        submission queue while entering.
+             * @param submitted The number of the submitted operations in submitting_.
+             * @param code The negated error code.
+             */
+            void roll_back(std::size_t submitted, std::int32_t code) {
+                const auto remaining = submitting_.size() - submitted;
+
+                std::atomic_ref{*sq_tail_}.store(
+                    *sq_tail_ - static_cast<std::uint32_t>(remaining), std::memory_order::release);
+                in_flight_ -= static_cast<std::uint32_t>(remaining);
+
+                if (is_transient_error(code) && in_flight_ != 0) {
+                    for (auto iter = submitting_.rbegin(); iter != submitting_.rend() - submitted; ++iter) {
+                        pending_.push_front(*iter);
+                    }
+
+                    return;
+                }
+
+                for (auto iter = submitting_.begin() + submitted; iter != submitting_.end(); ++iter) {
+                    failed_.emplace_back(*iter, -code);
+                }
+
+                // Without an operation in flight no completion would wake the reaper up for a retry.
+                if (in_flight_ == 0) {
+                    fail_pending(code);
+                }
+            }
+
+            void fail_pending(std::int32_t code) {
+                for (const auto op : pending_) {
+                    failed_.emplace_back(op, -code);
+                }
+
+                pending_.clear();
+            }
+
+            /**
+             * @brief Invokes the callbacks of finished operations and destroys them, without holding the lock.
+             * @param completed The finished operations.
+             */
+            void finish(std::span<const completion> completed) {
+                if (completed.empty()) {
+                    return;
+                }
+
+                for (auto&& [op, code] : completed) {
+                    const std::unique_ptr<operation> holder{op};
+
+                    if (code == 0) {
+                        op->complete(nullptr);
+                    } else {
+                        const auto message =
+                            op->writing ? U8("Failed to write the file.") : U8("Failed to read the file.");
+
+                        op->complete(std::make_exception_ptr(source_code_aware_runtime_error{U8("File"), op->path,
+                            U8("Message"), message, U8("Internal"), std::system_category().message(code)}));
+                    }
+                }
+
+                std::scoped_lock lock{mutex_};
+
+                outstanding_ -= completed.size();
+
+                if (outstanding_ == 0) {
+                    idle_condition_.notify_all();
+                }
+            }
+
+            void reap() {
+                std::vector<completion> completed;
+
+                for (bool stopping{}; !stopping;) {
+                    const auto code = enter(0, 1, IORING_ENTER_GETEVENTS);
+
+                    completed.clear();
+
+                    {
+                        std::scoped_lock lock{mutex_};
+
+                        auto head       = *cq_head_;
+                        const auto tail = std::atomic_ref{*cq_tail_}.load(std::memory_order::acquire);
+
+                        for (; head != tail; ++head) {
+                            const auto& cqe = cqes_[head & cq_mask_];
+                            const auto op   = reinterpret_cast<operation*>(cqe.user_data);
+
+                            if (!op) {
+                                stopping = true;
+                                continue;
+                            }
+
+                            --in_flight_;
+
+                            if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                                pending_.push_front(op);
+                            } else if (cqe.res < 0) {
+                                completed.emplace_back(op, -cqe.res);
+                            } else if (op->transferred += static_cast<std::size_t>(cqe.res);
+                                       cqe.res == 0 || op->transferred == op->buffer.size()) {
+                                completed.emplace_back(op, 0);
+                            } else {
+                                // Resubmits the remaining part of a short transfer.
+                                pending_.push_front(op);
+                            }
+                        }
+
+                        std::atomic_ref{*cq_head_}.store(head, std::memory_order::release);
+
+                        // Transient errors are retried once the queue is drained; otherwise the operations not
+                        // submitted yet are failed, while those in flight still complete.
+                        if (code < 0 && !is_transient_error(code)) {
+                            fail_pending(code);
+                        } else {
+                            flush();
+                        }
+
+                        completed.insert(completed.end(), failed_.begin(), failed_.end());
+                        failed_.clear();
+                    }
+
+                    finish(completed);
+                }
+            }
+
+            std::int32_t fd_{-1};
+            void* sq_ring_{};
+            void* cq_ring_{};
+            io_uring_sqe* sqes_{};
+            std::size_t sq_size_{};
+            std::size_t cq_size_{};
+            std::size_t sqe_size_{};
+            std::uint32_t* sq_tail_{};
+            std::uint32_t* sq_array_{};
+            std::uint32_t sq_mask_{};
+            std::uint32_t sq_entries_{};
+            std::uint32_t* cq_head_{};
+            std::uint32_t* cq_tail_{};
+            std::uint32_t cq_mask_{};
+            io_uring_cqe* cqes_{};
+            std::mutex mutex_;
+            std::condition_variable idle_condition_;
+            std::deque<operation*> pending_;
+            std::vector<operation*> submitting_;
+            std::vector<completion> failed_;
+            std::uint32_t in_flight_{};
+            std::size_t outstanding_{};
+            std::thread reaper_;
+        };
+#endif
+
+        std::unique_ptr<async_io_engine_base> make_engine(const async_io_options& options) {
+#ifdef ES_HAS_IO_URING
+            if (options.backend == async_io_backend::io_uring) {
+                return std::make_unique<io_uring_engine>(options.queue_depth);
+            }
+
+            if (options.backend == async_io_backend::automatic) {
+                // io_uring may be unavailable because of the kernel version or a seccomp policy.
+                try {
+                    return std::make_unique<io_uring_engine>(options.queue_depth);
+                } catch (const std::exception&) {
+                }
+            }
+#else
+            if (options.backend == async_io_backend::io_uring) {
+                throw source_code_aware_runtime_error{
+                    U8("io_uring is only available on Linux with the kernel headers declaring it.")};
+            }
+#endif
+
+            return std::make_unique<thread_pool_engine>(options.worker_count);
+        }
+    } // namespace
+
+    class async_read_file::impl {
+    public:
+        explicit impl(std::string_view path)
+            : file_{std::make_shared<const native_file>(native_file::open_read(path))}, path_{path} {}
+
+        [[nodiscard]] const std::shared_ptr<const native_file>& file() const noexcept {
+            return file_;
+        }
+
+        [[nodiscard]] std::string_view path() const noexcept {
+            return path_;
+        }
+
+    private:
+        std::shared_ptr<const native_file> file_;
+        std::string path_;
+    };
+
+    class async_file_engine::impl {
+    public:
+        explicit impl(const async_io_options& options) : engine_{make_engine(options)} {}
+
+        [[nodiscard]] async_io_backend backend() const noexcept {
+            return engine_->backend();
+        }
+
+        void read(const async_read_request& request, async_read_callback callback) const {
+            std::unique_ptr<operation> op;
+
+            try {
+                op = make_read_operation(
+                    std::make_shared<const native_file>(native_file::open_read(request.path)), request.path, request);
+            } catch (...) {
+                callback(async_read_result{}, std::current_exception());
+
+                return;
+            }
+
+            op->on_read = std::move(callback);
+            engine_->submit(std::move(op));
+        }
+
+        void read(
+            const async_read_file::impl& file, const async_read_request& request, async_read_callback callback) const {
+            std::unique_ptr<operation> op;
+
+            try {
+                op = make_read_operation(file.file(), file.path(), request);
+            } catch (...) {
+                callback(async_read_result{}, std::current_exception());
+
+                return;
+            }
+
+            op->on_read = std::move(callback);
+            engine_->submit(std::move(op));
+        }
+
+        void write(std::string_view path, std::span<const std::byte> buffer, async_write_callback callback) const {
+            std::unique_ptr<operation> op;
+
+            try {
+                op = make_write_operation(path, buffer);
+            } catch (...) {
+                callback(std::current_exception());
+
+                return;
+            }
+
+            op->on_write = std::move(callback);
+            engine_->submit(std::move(op));
+        }
+
+    private:
+        std::unique_ptr<async_io_engine_base> engine_;
+    };
+
+    async_read_file::async_read_file(std::string_view path) : impl_{std::make_unique<impl>(path)} {}
+
+    async_read_file::async_read_file(async_read_file&&) noexcept = default;
+
+    async_read_file::~async_read_file() = default;
+
+    async_read_file& async_read_file::operator=(async_read_file&&) noexcept = default;
+
+    std::uint64_t async_read_file::size() const {
+        return impl_->file()->size();
+    }
+
+    async_file_engine::async_file_engine(const async_io_options& options)
+        : impl_{std::make_unique<impl>(options)} {}
+
+    async_file_engine::async_file_engine(async_file_engine&&) noexcept = default;
+
+    async_file_engine::~async_file_engine() = default;
+
+    async_file_engine& async_file_engine::operator=(async_file_engine&&) noexcept = default;
+
+    async_io_backend async_file_engine::backend() const noexcept {
+        return impl_->backend();
+    }
+
+    void async_file_engine::read(const async_read_request& request, async_read_callback callback) const {
+        impl_->read(request, std::move(callback));
+    }
+
+    void async_file_engine::read(std::span<const async_read_request> requests,
+        const std::function<void(std::size_t index, async_read_result result, std::exception_ptr error)>& callback)
+        const {
+        for (std::size_t i = 0; i < requests.size(); i++) {
+            impl_->read(requests[i], [i, callback](async_read_result result, std::exception_ptr error) {
+                callback(i, std::move(result), std::move(error));
+            });
+        }
+    }
+
+    void async_file_engine::read(
+        const async_read_file& file, const async_read_request& request, async_read_callback callback) const {
+        impl_->read(*file.impl_, request, std::move(callback));
+    }
+
+    std::future<async_read_result> async_file_engine::read(const async_read_request& request) const {
+        auto promise = std::make_shared<std::promise<async_read_result>>();
+        auto result  = promise->get_future();
+
+        impl_->read(request, [promise](async_read_result result, std::exception_ptr error) {
+            if (error) {
+                promise->set_exception(std::move(error));
+            } else {
+                promise->set_value(std::move(result));
+            }
+        });
+
+        return result;
+    }
+
+    void async_file_engine::write(
+        std::string_view path, std::span<const std::byte> buffer, async_write_callback callback) const {
+        impl_->write(path, buffer, std::move(callback));
+    }
+
+    std::future<void> async_file_engine::write(std::string_view path, std::span<const std::byte> buffer) const {
+        auto promise = std::make_shared<std::promise<void>>();
+        auto result  = promise->get_future();
+
+        impl_->write(path, buffer, [promise](std::exception_ptr error) {
+            if (error) {
+                promise->set_exception(std::move(error));
+            } else {
+                promise->set_value();
+            }
+        });
+
+        return result;
+    }
+
+    const async_file_engine& get_async_file_engine() {
+        static const async_file_engine engine;
+
+        return engine;
+    }
+} // namespace essence::io
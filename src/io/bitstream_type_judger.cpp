@@ -24,18 +24,26 @@
 
 #include "char8_t_remediation.hpp"
 #include "error_extensions.hpp"
-#include "string.hpp"
+#include "native_file.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <exception>
-#include <filesystem>
-#include <fstream>
+#include <functional>
+#include <istream>
 #include <numeric>
-#include <ranges>
-#include <unordered_map>
+#include <optional>
 #include <utility>
 #include <vector>
 
+#ifdef CPP_ESSENCE_HAS_THREADS
+#include "thread.hpp"
+
+#include <atomic>
+#endif
+
 namespace essence::io {
     namespace {
         template <bool Leading>
@@ -47,7 +55,13 @@ namespace essence::io {
             }
         }
 
-        void read_trailing_bytes(std::istream& stream, std::span<std::byte> buffer) {
+        /**
+         * @brief Reads the last bytes of the stream which follow the current position, and restores the position.
+         * @param stream The stream.
+         * @param buffer The output buffer.
+         * @return The number of the read bytes.
+         */
+        std::size_t read_trailing_bytes(std::istream& stream, std::span<std::byte> buffer) {
             const auto origin = stream.tellg();
 
             stream.seekg(0, std::ios::end);
@@ -55,23 +69,192 @@ namespace essence::io {
             const auto max_rollback_size =
                 std::min(stream.tellg() - origin, static_cast<std::streamoff>(buffer.size()));
 
-            if (max_rollback_size > 0) {
-                stream.seekg(-max_rollback_size, std::ios::end)
-                    .read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(max_rollback_size))
-                    .seekg(origin);
+            if (max_rollback_size <= 0) {
+                return 0;
             }
 
-            std::fill(buffer.begin() + max_rollback_size, buffer.end(), std::byte{});
+            stream.seekg(-max_rollback_size, std::ios::end)
+                .read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(max_rollback_size))
+                .seekg(origin);
+
+            return static_cast<std::size_t>(max_rollback_size);
         }
+
+        /**
+         * @brief Lays out the bytes to identify: the leading bytes followed by the trailing bytes not overlapping
+         *        them, so that data shorter than the combined size of the signatures is identified as a whole.
+         * @param buffer The buffer which starts with the leading bytes and can hold the trailing bytes after them.
+         * @param leading_size The number of the leading bytes.
+         * @param trailing The last bytes of the data, which may also live in the buffer.
+         * @param remaining_size The number of the bytes following the leading bytes in the data.
+         * @return The bytes to identify, in the front of the buffer.
+         */
+        std::span<const std::byte> join_signature_bytes(std::span<std::byte> buffer, std::size_t leading_size,
+            std::span<const std::byte> trailing, std::uint64_t remaining_size) noexcept {
+            const auto rollback_size =
+                static_cast<std::size_t>(std::min<std::uint64_t>(remaining_size, trailing.size()));
+
+            std::memmove(buffer.data() + leading_size, trailing.data() + (trailing.size() - rollback_size),
+                rollback_size);
+
+            return buffer.first(leading_size + rollback_size);
+        }
+
+        /**
+         * @brief A prefix trie over the leading signatures, whose nodes carry the candidate hints ending there along
+         *        with their trailing signatures. All the data lives in flat arrays built once, so that matching a
+         *        buffer walks at most the length of the longest leading signature without allocating.
+         */
+        class signature_trie {
+        public:
+            struct candidate {
+                std::size_t hint_index;
+                std::size_t leading_size;
+                std::size_t trailing_offset;
+                std::size_t trailing_size;
+            };
+
+            explicit signature_trie(std::span<const abstract::bitstream_type_hint> hints) : nodes_(1) {
+                std::vector<std::vector<candidate>> node_candidates(1);
+
+                for (std::size_t i = 0; i < hints.size(); i++) {
+                    const auto leading  = hints[i].leading_signature();
+                    const auto trailing = hints[i].trailing_signature();
+
+                    // Hints without any signature never match.
+                    if (leading.empty() && trailing.empty()) {
+                        continue;
+                    }
+
+                    std::size_t node{};
+
+                    for (const auto byte : leading) {
+                        node = find_or_add_child(node, byte);
+                    }
+
+                    node_candidates.resize(nodes_.size());
+                    node_candidates[node].emplace_back(
+                        candidate{i, leading.size(), trailing_signatures_.size(), trailing.size()});
+                    trailing_signatures_.insert(trailing_signatures_.end(), trailing.begin(), trailing.end());
+                }
+
+                node_candidates.resize(nodes_.size());
+                flatten(node_candidates);
+            }
+
+            /**
+             * @brief Finds the most specific hint matching a buffer, which has the longest leading signature and then
+             *        the longest trailing signature.
+             * @param buffer The buffer, whose end is matched against the trailing signatures.
+             * @return The index of the hint, or std::nullopt if none matches.
+             */
+            [[nodiscard]] std::optional<std::size_t> match(std::span<const std::byte> buffer) const noexcept {
+                std::optional<std::size_t> result;
+
+                for (std::size_t node{}, depth{};; ++depth) {
+                    if (const auto index = match_candidates(nodes_[node], buffer)) {
+                        result = index;
+                    }
+
+                    if (depth == buffer.size()) {
+                        return result;
+                    }
+
+                    const auto child = find_child(node, buffer[depth]);
+
+                    if (!child) {
+                        return result;
+                    }
+
+                    node = *child;
+                }
+            }
+
+        private:
+            struct node_type {
+                std::size_t first_edge{};
+                std::size_t edge_count{};
+                std::size_t first_candidate{};
+                std::size_t candidate_count{};
+            };
+
+            struct edge {
+                std::byte value;
+                std::size_t target;
+            };
+
+            std::size_t find_or_add_child(std::size_t node, std::byte value) {
+                // The edges are kept per node during the construction and flattened afterwards.
+                building_edges_.resize(nodes_.size());
+
+                auto&& edges = building_edges_[node];
+
+                if (const auto iter = std::ranges::find(edges, value, &edge::value); iter != edges.end()) {
+                    return iter->target;
+                }
+
+                edges.emplace_back(edge{value, nodes_.size()});
+                nodes_.emplace_back();
+
+                return nodes_.size() - 1;
+            }
+
+            void flatten(std::vector<std::vector<candidate>>& node_candidates) {
+                building_edges_.resize(nodes_.size());
+
+                for (std::size_t i = 0; i < nodes_.size(); i++) {
+                    auto&& edges      = building_edges_[i];
+                    auto&& candidates = node_candidates[i];
+
+                    std::ranges::sort(edges, {}, &edge::value);
+                    std::ranges::stable_sort(candidates, std::ranges::greater{}, &candidate::trailing_size);
+
+                    nodes_[i] = node_type{edges_.size(), edges.size(), candidates_.size(), candidates.size()};
+                    edges_.insert(edges_.end(), edges.begin(), edges.end());
+                    candidates_.insert(candidates_.end(), candidates.begin(), candidates.end());
+                }
+
+                building_edges_ = {};
+            }
+
+            [[nodiscard]] std::optional<std::size_t> find_child(std::size_t node, std::byte value) const noexcept {
+                const auto edges = std::span{edges_}.subspan(nodes_[node].first_edge, nodes_[node].edge_count);
+                const auto iter  = std::ranges::lower_bound(edges, value, {}, &edge::value);
+
+                if (iter != edges.end() && iter->value == value) {
+                    return iter->target;
+                }
+
+                return std::nullopt;
+            }
+
+            [[nodiscard]] std::optional<std::size_t> match_candidates(
+                const node_type& node, std::span<const std::byte> buffer) const noexcept {
+                // The candidates are ordered by the size of the trailing signature in descending order.
+                for (auto&& item : std::span{candidates_}.subspan(node.first_candidate, node.candidate_count)) {
+                    if (item.leading_size + item.trailing_size <= buffer.size()
+                        && std::ranges::equal(buffer.last(item.trailing_size),
+                            std::span{trailing_signatures_}.subspan(item.trailing_offset, item.trailing_size))) {
+                        return item.hint_index;
+                    }
+                }
+
+                return std::nullopt;
+            }
+
+            std::vector<node_type> nodes_;
+            std::vector<edge> edges_;
+            std::vector<candidate> candidates_;
+            std::vector<std::byte> trailing_signatures_;
+            std::vector<std::vector<edge>> building_edges_;
+        };
     } // namespace
 
     class bitstream_type_judger::impl {
     public:
-        using mapping_type = std::unordered_map<std::string_view, abstract::bitstream_type_hint>;
-
         explicit impl(std::span<const abstract::bitstream_type_hint> hints)
             : combined_signature_size_{}, max_leading_signature_size_{}, max_trailing_signature_size_{},
-              hints_{hints.begin(), hints.end()} {
+              hints_{hints.begin(), hints.end()}, trie_{hints_} {
 
             if (hints_.empty()) {
                 throw source_code_aware_runtime_error{U8("The input type hints cannot be empty.")};
@@ -79,7 +262,7 @@ namespace essence::io {
 
             init_max_signature_size<true>();
             init_max_signature_size<false>();
-            init_signature_mapping();
+            combined_signature_size_ = max_leading_signature_size_ + max_trailing_signature_size_;
         }
 
         [[nodiscard]] std::span<const abstract::bitstream_type_hint> hints() const noexcept {
@@ -87,18 +270,43 @@ namespace essence::io {
         }
 
         [[nodiscard]] std::optional<abstract::bitstream_type_hint> identify(std::string_view path) const {
-            std::ifstream stream;
+            thread_local std::vector<std::byte> buffer;
 
-            try {
-                stream.exceptions(std::ios::badbit);
-                stream.open(std::filesystem::path{to_u8string(path)}, std::ios::in | std::ios::binary);
-            } catch (const std::exception& ex) {
-                throw source_code_aware_runtime_error{
-                    U8("File"), path, U8("Message"), U8("Failed to open the file."), U8("Internal"), ex.what()};
+            buffer.resize(combined_signature_size_);
+
+            // Reads the leading and the trailing bytes by positional reads.
+            const auto file           = native_file::open_read(path);
+            const auto size           = file.size();
+            const auto leading_size   = file.read_at(0, std::span{buffer}.first(max_leading_signature_size_));
+            const auto remaining_size = size - std::min<std::uint64_t>(size, leading_size);
+            const auto rollback_size  =
+                static_cast<std::size_t>(std::min<std::uint64_t>(remaining_size, max_trailing_signature_size_));
+            const auto trailing       = std::span{buffer}.subspan(max_leading_signature_size_, rollback_size);
+
+            if (rollback_size != 0) {
+                file.read_at(size - rollback_size, trailing);
             }
 
-            return identify(stream);
+            return identify(join_signature_bytes(buffer, leading_size, trailing, remaining_size));
+        }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+        [[nodiscard]] abi::vector<bitstream_identification> identify_many(
+            std::span<const std::string_view> paths, std::size_t worker_count) const {
+            abi::vector<bitstream_identification> result(paths.size());
+
+            parallel_for(0, paths.size(), worker_count,
+                [&](std::size_t index, [[maybe_unused]] std::size_t thread_index, [[maybe_unused]] bool& exit) {
+                    try {
+                        result[index].hint = identify(paths[index]);
+                    } catch (...) {
+                        result[index].error = std::current_exception();
+                    }
+                });
+
+            return result;
         }
+#endif
 
         [[nodiscard]] std::optional<abstract::bitstream_type_hint> identify(std::istream& stream) const {
             thread_local std::vector<std::byte> buffer;
@@ -108,35 +316,89 @@ namespace essence::io {
             // Fetches data in the max possible size in one single call to the stream.read function.
             stream.read(
                 reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(max_leading_signature_size_));
-            read_trailing_bytes(
-                stream, std::span{buffer.data() + max_leading_signature_size_, max_trailing_signature_size_});
 
-            return identify(buffer);
+            const auto leading_size = static_cast<std::size_t>(stream.gcount());
+            const auto trailing     = std::span{buffer}.subspan(max_leading_signature_size_);
+
+            // A short read of the leading bytes has reached the end already.
+            const auto rollback_size =
+                leading_size == max_leading_signature_size_ ? read_trailing_bytes(stream, trailing) : 0;
+
+            return identify(join_signature_bytes(buffer, leading_size, trailing.first(rollback_size), rollback_size));
         }
 
         [[nodiscard]] std::optional<abstract::bitstream_type_hint> identify(std::span<const std::byte> buffer) const {
-            // Prohibits out-of-range exceptions.
-            auto adapter = hints_ | std::views::filter([&](const auto& inner) {
-                return inner.leading_signature_size() + inner.trailing_signature_size() <= buffer.size();
-            });
+            if (const auto index = trie_.match(buffer)) {
+                return hints_[*index];
+            }
 
-            for (auto&& item : adapter) {
-                abi::string combined_key{reinterpret_cast<const char*>(buffer.data()), item.leading_signature_size()};
+            return std::nullopt;
+        }
 
-                // Uses a combined key.
-                combined_key.append(
-                    reinterpret_cast<const char*>(buffer.data() + buffer.size() - item.trailing_signature_size()),
-                    item.trailing_signature_size());
+#ifdef CPP_ESSENCE_HAS_THREADS
+        [[nodiscard]] abi::vector<std::future<std::optional<abstract::bitstream_type_hint>>> identify_async(
+            std::span<const std::string_view> paths, const async_file_engine& engine) const {
+            // The leading and the trailing bytes are read concurrently, and the last read to complete identifies.
+            struct identification_state {
+                std::promise<std::optional<abstract::bitstream_type_hint>> promise;
+                std::array<async_read_result, 2> parts;
+                std::array<std::exception_ptr, 2> errors;
+                std::atomic_size_t remaining{2};
+            };
 
-                if (auto iter = mapping_.find(combined_key); iter != mapping_.end()) {
-                    return item;
-                }
+            abi::vector<std::future<std::optional<abstract::bitstream_type_hint>>> result;
+
+            result.reserve(paths.size());
+
+            for (auto&& item : paths) {
+                const auto state = std::make_shared<identification_state>();
+                auto make_handler = [&](std::size_t index) {
+                    return [this, state, index](async_read_result part, std::exception_ptr error) {
+                        state->parts[index]  = std::move(part);
+                        state->errors[index] = std::move(error);
+
+                        if (state->remaining.fetch_sub(1, std::memory_order::acq_rel) == 1) {
+                            complete_identification(state->promise, state->parts, state->errors);
+                        }
+                    };
+                };
+
+                result.emplace_back(state->promise.get_future());
+                engine.read(async_read_request{.path = item, .length = max_leading_signature_size_}, make_handler(0));
+                engine.read(async_read_request{.path = item,
+                                .length                  = max_trailing_signature_size_,
+                                .origin                  = std::ios_base::end},
+                    make_handler(1));
             }
 
-            return std::nullopt;
+            return result;
         }
+#endif
 
     private:
+#ifdef CPP_ESSENCE_HAS_THREADS
+        void complete_identification(std::promise<std::optional<abstract::bitstream_type_hint>>& promise,
+            std::span<const async_read_result, 2> parts, std::span<const std::exception_ptr, 2> errors) const {
+            try {
+                for (auto&& item : errors) {
+                    if (item) {
+                        std::rethrow_exception(item);
+                    }
+                }
+
+                const auto& leading  = parts[0];
+                const auto& trailing = parts[1];
+                std::vector<std::byte> buffer(leading.data.size() + trailing.data.size());
+
+                std::ranges::copy(leading.data, buffer.begin());
+                promise.set_value(identify(join_signature_bytes(
+                    buffer, leading.data.size(), trailing.data, leading.file_size - leading.data.size())));
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }
+#endif
+
         template <bool Leading>
         std::size_t& get_max_signature_size() noexcept {
             if constexpr (Leading) {
@@ -148,38 +410,15 @@ namespace essence::io {
 
         template <bool Leading>
         void init_max_signature_size() {
-            static constexpr auto compare = [](const auto& left, const auto& right) {
-                return get_signature_size<Leading>(left) < get_signature_size<Leading>(right);
-            };
-
-            std::ranges::sort(hints_, compare);
-
-            get_max_signature_size<Leading>() =
-                get_signature_size<Leading>(*std::max_element(hints_.begin(), hints_.end(), compare));
-        }
-
-        void init_signature_mapping() {
-            init_max_signature_size<true>();
-            init_max_signature_size<false>();
-            combined_signature_size_ = max_leading_signature_size_ + max_trailing_signature_size_;
-
-            // Adds non-empty signatures only.
-            auto adapter = hints_ | std::views::filter([](const auto& inner) {
-                return inner.leading_signature_size() != 0 || inner.trailing_signature_size() != 0;
-            });
-
-            for (auto&& item : adapter) {
-                // Uses a combined key.
-                mapping_.insert_or_assign(
-                    std::move(abi::string{item.leading_signature_str()}.append(item.trailing_signature_str())), item);
-            }
+            get_max_signature_size<Leading>() = get_signature_size<Leading>(*std::ranges::max_element(
+                hints_, {}, [](const auto& inner) { return get_signature_size<Leading>(inner); }));
         }
 
         std::size_t combined_signature_size_;
         std::size_t max_leading_signature_size_;
         std::size_t max_trailing_signature_size_;
         std::vector<abstract::bitstream_type_hint> hints_;
-        std::unordered_map<abi::string, abstract::bitstream_type_hint, string_hash, std::equal_to<>> mapping_;
+        signature_trie trie_;
     };
 
     bitstream_type_judger::bitstream_type_judger(std::span<const abstract::bitstream_type_hint> hints)
@@ -207,4 +446,16 @@ namespace essence::io {
         std::span<const std::byte> buffer) const {
         return impl_->identify(buffer);
     }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+    abi::vector<bitstream_identification> bitstream_type_judger::identify_many(
+        std::span<const std::string_view> paths, std::size_t worker_count) const {
+        return impl_->identify_many(paths, worker_count);
+    }
+
+    abi::vector<std::future<std::optional<abstract::bitstream_type_hint>>> bitstream_type_judger::identify_async(
+        std::span<const std::string_view> paths, const async_file_engine& engine) const {
+        return impl_->identify_async(paths, engine);
+    }
+#endif
 } // namespace essence::io
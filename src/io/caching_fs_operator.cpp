@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "io/caching_fs_operator.hpp"
+
+#include "io/spanstream.hpp"
+#include "string.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace essence::io {
+    namespace {
+        using content_ptr = std::shared_ptr<const abi::vector<std::byte>>;
+
+        /**
+         * @brief A stream over the cached content of a file, which keeps the content alive.
+         */
+        class cached_istream final : public ispanstream {
+        public:
+            cached_istream(content_ptr content, std::ios_base::openmode mode)
+                : ispanstream{std::span{reinterpret_cast<const char*>(content->data()), content->size()}, mode},
+                  content_{std::move(content)} {}
+
+        private:
+            content_ptr content_;
+        };
+
+        struct file_version {
+            std::uint64_t size{};
+            std::filesystem::file_time_type time;
+        };
+
+        struct cache_entry {
+            content_ptr content;
+            file_version version;
+            std::list<std::string>::iterator position;
+        };
+
+        struct metadata_entry {
+            std::optional<bool> exists;
+            std::optional<bool> is_file;
+        };
+
+        struct cache_shard {
+            std::mutex mutex;
+            std::list<std::string> lru;
+            std::unordered_map<std::string, cache_entry, string_hash, std::equal_to<>> entries;
+            std::unordered_map<std::string, metadata_entry, string_hash, std::equal_to<>> metadata;
+            std::size_t bytes{};
+        };
+    } // namespace
+
+    class caching_fs_operator::impl {
+    public:
+        impl(abstract::virtual_fs_operator inner, const caching_fs_options& options)
+            : inner_{std::move(inner)}, validate_{options.validate},
+              shard_capacity_{options.capacity / std::max<std::size_t>(options.shard_count, 1)},
+              shards_(std::max<std::size_t>(options.shard_count, 1)) {}
+
+        [[nodiscard]] const abstract::virtual_fs_operator& inner() const noexcept {
+            return inner_;
+        }
+
+        [[nodiscard]] bool exists(std::string_view path) {
+            return get_metadata(path, &metadata_entry::exists, [&] { return inner_.exists(path); });
+        }
+
+        [[nodiscard]] bool is_file(std::string_view path) {
+            return get_metadata(path, &metadata_entry::is_file, [&] { return inner_.is_file(path); });
+        }
+
+        [[nodiscard]] content_ptr get(std::string_view path) {
+            return get(path, query_version_if_validating(path));
+        }
+
+        [[nodiscard]] content_ptr get(std::string_view path, const std::optional<file_version>& version) {
+            auto&& shard = select_shard(path);
+
+            {
+                std::scoped_lock lock{shard.mutex};
+
+                if (auto iter = shard.entries.find(path); iter != shard.entries.end()) {
+                    if (!version || (version->size == iter->second.version.size
+                                        && version->time == iter->second.version.time)) {
+                        shard.lru.splice(shard.lru.begin(), shard.lru, iter->second.position);
+                        hits_.fetch_add(1, std::memory_order::relaxed);
+
+                        return iter->second.content;
+                    }
+
+                    erase(shard, iter);
+                    stale_.fetch_add(1, std::memory_order::relaxed);
+                }
+            }
+
+            misses_.fetch_add(1, std::memory_order::relaxed);
+
+            // The version is queried before reading, so a concurrent modification is detected on the next access.
+            auto content = std::make_shared<const abi::vector<std::byte>>(inner_.read_all(path));
+
+            if (content->size() <= shard_capacity_) {
+                std::scoped_lock lock{shard.mutex};
+
+                if (auto iter = shard.entries.find(path); iter != shard.entries.end()) {
+                    erase(shard, iter);
+                }
+
+                shard.lru.emplace_front(path);
+                shard.entries.emplace(path, cache_entry{content, version.value_or(file_version{}), shard.lru.begin()});
+                shard.bytes += content->size();
+
+                while (shard.bytes > shard_capacity_) {
+                    erase(shard, shard.entries.find(shard.lru.back()));
+                    evictions_.fetch_add(1, std::memory_order::relaxed);
+                }
+            }
+
+            return content;
+        }
+
+        [[nodiscard]] std::size_t read_range(std::string_view path, std::uint64_t offset, std::span<std::byte> result) {
+            const auto version = query_version_if_validating(path);
+
+            // A file beyond the capacity of a shard is never cached, so only the range is read instead of the file.
+            if ((version ? version->size : file_size(path)) > shard_capacity_) {
+                misses_.fetch_add(1, std::memory_order::relaxed);
+
+                return inner_.read_range(path, offset, result);
+            }
+
+            const auto content = get(path, version);
+
+            if (offset >= content->size()) {
+                return 0;
+            }
+
+            const auto size = std::min(result.size(), content->size() - static_cast<std::size_t>(offset));
+
+            std::copy_n(content->begin() + static_cast<std::ptrdiff_t>(offset), size, result.begin());
+
+            return size;
+        }
+
+        [[nodiscard]] std::uint64_t file_size(std::string_view path) {
+            if (!validate_) {
+                auto&& shard = select_shard(path);
+                std::scoped_lock lock{shard.mutex};
+
+                if (const auto iter = shard.entries.find(path); iter != shard.entries.end()) {
+                    return iter->second.content->size();
+                }
+            }
+
+            return inner_.file_size(path);
+        }
+
+        void invalidate(std::string_view path) {
+            auto&& shard = select_shard(path);
+            std::scoped_lock lock{shard.mutex};
+
+            if (const auto iter = shard.entries.find(path); iter != shard.entries.end()) {
+                erase(shard, iter);
+            }
+
+            if (const auto iter = shard.metadata.find(path); iter != shard.metadata.end()) {
+                shard.metadata.erase(iter);
+            }
+        }
+
+        void clear() {
+            for (auto&& shard : shards_) {
+                std::scoped_lock lock{shard.mutex};
+
+                shard.lru.clear();
+                shard.entries.clear();
+                shard.metadata.clear();
+                shard.bytes = 0;
+            }
+        }
+
+        [[nodiscard]] caching_fs_stats stats() {
+            caching_fs_stats result{
+                .hits          = hits_.load(std::memory_order::relaxed),
+                .misses        = misses_.load(std::memory_order::relaxed),
+                .stale         = stale_.load(std::memory_order::relaxed),
+                .evictions     = evictions_.load(std::memory_order::relaxed),
+                .metadata_hits = metadata_hits_.load(std::memory_order::relaxed),
+            };
+
+            for (auto&& shard : shards_) {
+                std::scoped_lock lock{shard.mutex};
+
+                result.cached_bytes += shard.bytes;
+            }
+
+            return result;
+        }
+
+    private:
+        [[nodiscard]] cache_shard& select_shard(std::string_view path) {
+            return shards_[string_hash{}(path) % shards_.size()];
+        }
+
+        [[nodiscard]] file_version query_version(std::string_view path) const {
+            return file_version{
+                .size = inner_.file_size(path),
+                .time = inner_.last_write_time(path),
+            };
+        }
+
+        [[nodiscard]] std::optional<file_version> query_version_if_validating(std::string_view path) const {
+            std::optional<file_version> result;
+
+            if (validate_) {
+                result.emplace(query_version(path));
+            }
+
+            return result;
+        }
+
+        template <typename Callable>
+        bool get_metadata(std::string_view path, std::optional<bool> metadata_entry::*member, Callable&& handler) {
+            auto&& shard = select_shard(path);
+
+            {
+                std::scoped_lock lock{shard.mutex};
+
+                if (const auto iter = shard.metadata.find(path);
+                    iter != shard.metadata.end() && (iter->second.*member).has_value()) {
+                    metadata_hits_.fetch_add(1, std::memory_order::relaxed);
+
+                    return *(iter->second.*member);
+                }
+            }
+
+            const bool result = std::forward<Callable>(handler)();
+            std::scoped_lock lock{shard.mutex};
+
+            if (auto iter = shard.metadata.find(path); iter != shard.metadata.end()) {
+                iter->second.*member = result;
+            } else {
+                shard.metadata.emplace(path, metadata_entry{}).first->second.*member = result;
+            }
+
+            return result;
+        }
+
+        static void erase(cache_shard& shard, decltype(cache_shard::entries)::iterator iter) {
+            shard.bytes -= iter->second.content->size();
+            shard.lru.erase(iter->second.position);
+            shard.entries.erase(iter);
+        }
+
+        abstract::virtual_fs_operator inner_;
+        bool validate_;
+        std::size_t shard_capacity_;
+        std::vector<cache_shard> shards_;
+        std::atomic_uint64_t hits_;
+        std::atomic_uint64_t misses_;
+        std::atomic_uint64_t stale_;
+        std::atomic_uint64_t evictions_;
+        std::atomic_uint64_t metadata_hits_;
+    };
+
+    caching_fs_operator::caching_fs_operator(abstract::virtual_fs_operator inner, const caching_fs_options& options)
+        : impl_{std::make_shared<impl>(std::move(inner), options)} {}
+
+    bool caching_fs_operator::exists(std::string_view path) const {
+        return impl_->exists(path);
+    }
+
+    bool caching_fs_operator::is_file(std::string_view path) const {
+        return impl_->is_file(path);
+    }
+
+    bool caching_fs_operator::is_directory(std::string_view path) const {
+        return impl_->inner().is_directory(path);
+    }
+
+    std::unique_ptr<std::iostream> caching_fs_operator::open(
+        std::string_view path, std::ios_base::openmode mode) const {
+        impl_->invalidate(path);
+
+        return impl_->inner().open(path, mode);
+    }
+
+    std::unique_ptr<std::istream> caching_fs_operator::open_read(
+        std::string_view path, std::ios_base::openmode mode) const {
+        auto stream = std::make_unique<cached_istream>(impl_->get(path), mode);
+
+        stream->exceptions(std::ios_base::badbit);
+
+        return stream;
+    }
+
+    std::unique_ptr<std::ostream> caching_fs_operator::open_write(
+        std::string_view path, std::ios_base::openmode mode) const {
+        impl_->invalidate(path);
+
+        return impl_->inner().open_write(path, mode);
+    }
+
+    abi::vector<std::byte> caching_fs_operator::read_all(std::string_view path) const {
+        return *impl_->get(path);
+    }
+
+    std::size_t caching_fs_operator::read_range(
+        std::string_view path, std::uint64_t offset, std::span<std::byte> result) const {
+        return impl_->read_range(path, offset, result);
+    }
+
+    void caching_fs_operator::write_all(std::string_view path, std::span<const std::byte> buffer) const {
+        impl_->inner().write_all(path, buffer);
+        impl_->invalidate(path);
+    }
+
+    std::uint64_t caching_fs_operator::file_size(std::string_view path) const {
+        return impl_->file_size(path);
+    }
+
+    std::filesystem::file_time_type caching_fs_operator::last_write_time(std::string_view path) const {
+        return impl_->inner().last_write_time(path);
+    }
+
+    abi::vector<directory_entry> caching_fs_operator::list_directory(std::string_view path) const {
+        return impl_->inner().list_directory(path);
+    }
+
+    void caching_fs_operator::invalidate(std::string_view path) const {
+        impl_->invalidate(path);
+    }
+
+    void caching_fs_operator::clear() const {
+        impl_->clear();
+    }
+
+    caching_fs_stats caching_fs_operator::stats() const {
+        return impl_->stats();
+    }
+
+    abstract::virtual_fs_operator make_caching_fs_operator(
+        abstract::virtual_fs_operator inner, const caching_fs_options& options) {
+        return abstract::virtual_fs_operator{caching_fs_operator{std::move(inner), options}};
+    }
+} // namespace essence::io
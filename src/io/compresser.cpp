@@ -23,50 +23,82 @@
 #include "io/compresser.hpp"
 
 #include "abstract/writable_buffer.hpp"
+#include "char8_t_remediation.hpp"
 #include "compression_routines.hpp"
+#include "memory/allocation_profiler.hpp"
+
+#include <mutex>
+#include <span>
 
 namespace essence::io {
     class compresser::impl {
     public:
-        explicit impl(compression_mode mode) : routines_{get_compression_routines(mode)} {}
+        impl(compression_mode mode, const compression_settings& settings)
+            : options_{settings.options}, context_{get_compression_routines(mode).make_context(settings)} {}
 
-        [[nodiscard]] abi::vector<std::byte> as_bytes(std::span<const std::byte> buffer, std::int32_t level) const {
-            abi::vector<std::byte> result;
+        [[nodiscard]] const compression_options& options() const noexcept {
+            return options_;
+        }
 
-            routines_.compress(buffer, abstract::writable_buffer{result}, level);
+        [[nodiscard]] std::size_t compress_bound(std::size_t size) const {
+            std::scoped_lock lock{mutex_};
 
-            return result;
+            return context_->compress_bound(size);
         }
 
-        [[nodiscard]] abi::string as_string(std::span<const std::byte> buffer, std::int32_t level) const {
-            abi::string result;
+        std::size_t compress_into(
+            std::span<const std::byte> buffer, std::span<std::byte> result, std::int32_t level) const {
+            std::scoped_lock lock{mutex_};
 
-            routines_.compress(buffer, abstract::writable_buffer{result}, level);
+            return context_->compress_into(buffer, result, level);
+        }
 
-            return result;
+        std::size_t decompress_into(std::span<const std::byte> buffer, std::span<std::byte> result) const {
+            std::scoped_lock lock{mutex_};
+
+            return context_->decompress_into(buffer, result);
         }
 
-        [[nodiscard]] abi::vector<std::byte> inverse_as_bytes(std::span<const std::byte> buffer) const {
-            abi::vector<std::byte> result;
+        template <typename T>
+        [[nodiscard]] T compress(std::span<const std::byte> buffer, std::int32_t level) const {
+            const memory::alloc_scope scope{U8("compression")};
+            std::scoped_lock lock{mutex_};
+
+            T result;
 
-            routines_.decompress(buffer, abstract::writable_buffer{result});
+            // Compresses straight into the result sized to the bound, then shrinks it to the compressed size, which
+            // keeps the capacity of the bound but saves copying through a temporary.
+            result.resize(context_->compress_bound(buffer.size()));
+            result.resize(context_->compress_into(buffer, std::as_writable_bytes(std::span{result}), level));
 
             return result;
         }
 
-        [[nodiscard]] abi::string inverse_as_string(std::span<const std::byte> buffer) const {
-            abi::string result;
+        template <typename T>
+        [[nodiscard]] T decompress(std::span<const std::byte> buffer) const {
+            const memory::alloc_scope scope{U8("compression")};
+            std::scoped_lock lock{mutex_};
+            T result;
 
-            routines_.decompress(buffer, abstract::writable_buffer{result});
+            context_->decompress(buffer, abstract::writable_buffer{result});
 
             return result;
         }
 
     private:
-        compression_routines routines_;
+        compression_options options_;
+        std::unique_ptr<compression_context> context_;
+        mutable std::mutex mutex_;
     };
 
-    compresser::compresser(compression_mode mode) : impl_{std::make_unique<impl>(mode)} {}
+    compresser::compresser(compression_mode mode) : compresser{mode, compression_options{}} {}
+
+    compresser::compresser(compression_mode mode, const compression_options& options)
+        : impl_{std::make_unique<impl>(mode, compression_settings{.options = options})} {}
+
+    compresser::compresser(
+        compression_mode mode, const compression_dictionary& dictionary, const compression_options& options)
+        : impl_{std::make_unique<impl>(mode, compression_settings{.options = options, .dictionary = dictionary})} {}
 
     compresser::compresser(compresser&&) noexcept = default;
 
@@ -74,20 +106,37 @@ namespace essence::io {
 
     compresser& compresser::operator=(compresser&&) noexcept = default;
 
+    const compression_options& compresser::options() const noexcept {
+        return impl_->options();
+    }
+
+    std::size_t compresser::compress_bound(std::size_t size) const {
+        return impl_->compress_bound(size);
+    }
+
+    std::size_t compresser::compress_into(
+        std::span<const std::byte> buffer, std::span<std::byte> result, std::int32_t level) const {
+        return impl_->compress_into(buffer, result, level);
+    }
+
+    std::size_t compresser::decompress_into(std::span<const std::byte> buffer, std::span<std::byte> result) const {
+        return impl_->decompress_into(buffer, result);
+    }
+
     abi::vector<std::byte> compresser::as_bytes(std::span<const std::byte> buffer, std::int32_t level) const {
-        return impl_->as_bytes(buffer, level);
+        return impl_->compress<abi::vector<std::byte>>(buffer, level);
     }
 
     abi::string compresser::as_string(std::span<const std::byte> buffer, std::int32_t level) const {
-        return impl_->as_string(buffer, level);
+        return impl_->compress<abi::string>(buffer, level);
     }
 
     abi::vector<std::byte> compresser::inverse_as_bytes(std::span<const std::byte> buffer) const {
-        return impl_->inverse_as_bytes(buffer);
+        return impl_->decompress<abi::vector<std::byte>>(buffer);
     }
 
     abi::string compresser::inverse_as_string(std::span<const std::byte> buffer) const {
-        return impl_->inverse_as_string(buffer);
+        return impl_->decompress<abi::string>(buffer);
     }
 
 } // namespace essence::io
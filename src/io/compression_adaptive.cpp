@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "char8_t_remediation.hpp"
+#include "compat.hpp"
+#include "compression_routines.hpp"
+#include "error_extensions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+
+namespace essence::io {
+    namespace {
+        /*
+         * The container consists of a magic number followed by blocks. Each block has a 9-byte header: the block type,
+         * the uncompressed size and the stored size, both as little-endian 32-bit integers. A stored block covers a run
+         * of adjacent sampling blocks.
+         */
+        constexpr std::array<std::uint8_t, 4> magic_number{'E', 'S', 'A', '1'};
+        constexpr std::size_t block_header_size  = 9;
+        constexpr std::size_t default_block_size = 128 * 1024;
+        constexpr std::size_t max_block_size     = 64 * 1024 * 1024;
+        constexpr std::size_t max_run_size       = 256 * 1024 * 1024;
+
+        // The number and size of the windows sampled from a block to estimate its compressibility.
+        constexpr std::size_t sample_window_count = 4;
+        constexpr std::size_t sample_window_size  = 1024;
+
+        // Samples below this entropy in bits per byte always compress well enough to skip the trial.
+        constexpr double low_entropy_threshold = 6.0;
+
+        // The trial compression ratios above which a block is stored raw or compressed at the fast level.
+        constexpr double incompressible_ratio = 0.97;
+        constexpr double weak_ratio           = 0.85;
+        constexpr std::int32_t fast_level     = 1;
+
+        enum class block_type : std::uint8_t {
+            raw,
+            zstd,
+        };
+
+        void write_uint32(std::byte* output, std::uint32_t value) noexcept {
+            for (std::size_t i = 0; i < sizeof(value); i++) {
+                output[i] = static_cast<std::byte>((value >> (i * 8)) & 0xFF);
+            }
+        }
+
+        std::uint32_t read_uint32(const std::byte* input) noexcept {
+            std::uint32_t result{};
+
+            for (std::size_t i = 0; i < sizeof(result); i++) {
+                result |= std::to_integer<std::uint32_t>(input[i]) << (i * 8);
+            }
+
+            return result;
+        }
+
+        [[noreturn]] void throw_output_too_small() {
+            throw source_code_aware_runtime_error{U8("The output buffer is too small.")};
+        }
+
+        [[noreturn]] void throw_invalid_format(const char* message) {
+            throw source_code_aware_runtime_error{
+                U8("Message"), U8("Invalid adaptive compression data."), U8("Internal"), message};
+        }
+
+        /**
+         * @brief Computes the Shannon entropy of a buffer.
+         * @param buffer The buffer.
+         * @return The entropy in bits per byte.
+         */
+        double get_entropy(std::span<const std::byte> buffer) noexcept {
+            std::array<std::uint32_t, 256> histogram{};
+
+            for (auto&& item : buffer) {
+                ++histogram[std::to_integer<std::uint8_t>(item)];
+            }
+
+            double result{};
+
+            for (auto&& count : histogram) {
+                if (count != 0) {
+                    const auto probability = static_cast<double>(count) / static_cast<double>(buffer.size());
+
+                    result -= probability * std::log2(probability);
+                }
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Stores incompressible blocks raw and chooses the compression level of the others by sampling, on
+         *        top of the zstd compression.
+         */
+        class adaptive_context final : public compression_context {
+        public:
+            explicit adaptive_context(const compression_settings& settings)
+                : options_{settings.options},
+                  block_size_{
+                      std::min(options_.job_size != 0 ? options_.job_size : default_block_size, max_block_size)},
+                  inner_{get_compression_routines(compression_mode::zstd).make_context(settings)} {}
+
+            std::size_t compress_bound(std::size_t size) override {
+                const auto block_count = get_block_count(size);
+
+                return magic_number.size()
+                     + block_count * (block_header_size + std::max(block_size_, inner_->compress_bound(block_size_)));
+            }
+
+            std::size_t compress_into(
+                std::span<const std::byte> buffer, std::span<std::byte> result, std::int32_t level) override {
+                if (result.size() < magic_number.size()) {
+                    throw_output_too_small();
+                }
+
+                std::memcpy(result.data(), magic_number.data(), magic_number.size());
+
+                std::size_t position = magic_number.size();
+                std::size_t run_offset{};
+                std::optional<std::int32_t> run_level;
+
+                // Adjacent blocks with the same decision are merged into one run, so that compressible data keeps the
+                // ratio of a single frame.
+                for (std::size_t offset = 0; offset < buffer.size(); offset += block_size_) {
+                    const auto input       = buffer.subspan(offset, std::min(block_size_, buffer.size() - offset));
+                    const auto block_level = choose_level(input, level);
+
+                    if (offset != run_offset && (block_level != run_level || offset - run_offset >= max_run_size)) {
+                        position += compress_run(
+                            buffer.subspan(run_offset, offset - run_offset), result.subspan(position), run_level);
+                        run_offset = offset;
+                    }
+
+                    run_level = block_level;
+                }
+
+                if (run_offset != buffer.size()) {
+                    position += compress_run(buffer.subspan(run_offset), result.subspan(position), run_level);
+                }
+
+                return position;
+            }
+
+            std::size_t decompress_into(std::span<const std::byte> buffer, std::span<std::byte> result) override {
+                std::size_t position{};
+
+                for (auto input = skip_magic_number(buffer); !input.empty();) {
+                    const auto type        = static_cast<block_type>(std::to_integer<std::uint8_t>(input[0]));
+                    const auto raw_size    = read_uint32(input.data() + 1);
+                    const auto stored_size = read_uint32(input.data() + 5);
+                    const auto stored      = input.subspan(block_header_size, stored_size);
+
+                    if (result.size() - position < raw_size) {
+                        throw_output_too_small();
+                    }
+
+                    const auto output = result.subspan(position, raw_size);
+
+                    if (type == block_type::raw) {
+                        std::memcpy(output.data(), stored.data(), stored.size());
+                    } else if (inner_->decompress_into(stored, output) != raw_size) {
+                        throw_invalid_format(U8("The decompressed size of the block mismatches its header."));
+                    }
+
+                    position += raw_size;
+                    input = input.subspan(block_header_size + stored_size);
+                }
+
+                return position;
+            }
+
+            void decompress(std::span<const std::byte> buffer, const abstract::writable_buffer& result) override {
+                const auto size = get_decompressed_size(buffer);
+
+                if (options_.max_decompressed_size != 0 && size > options_.max_decompressed_size) {
+                    throw source_code_aware_runtime_error{U8("Content Size"), size, U8("Max Size"),
+                        options_.max_decompressed_size, U8("Message"),
+                        U8("The decompressed data exceeds the maximum size.")};
+                }
+
+                result.resize(size);
+                decompress_into(buffer, std::span{result.data(), result.size_bytes()});
+            }
+
+        private:
+            [[nodiscard]] std::size_t get_block_count(std::size_t size) const noexcept {
+                return (size + block_size_ - 1) / block_size_;
+            }
+
+            /**
+             * @brief Validates the magic number and the block headers.
+             * @param buffer The compressed data.
+             * @return The blocks after the magic number.
+             */
+            static std::span<const std::byte> skip_magic_number(std::span<const std::byte> buffer) {
+                if (buffer.size() < magic_number.size()
+                    || std::memcmp(buffer.data(), magic_number.data(), magic_number.size()) != 0) {
+                    throw_invalid_format(U8("The magic number is missing."));
+                }
+
+                const auto blocks = buffer.subspan(magic_number.size());
+
+                for (auto input = blocks; !input.empty();) {
+                    if (input.size() < block_header_size) {
+                        throw_invalid_format(U8("The block header is truncated."));
+                    }
+
+                    const auto type        = std::to_integer<std::uint8_t>(input[0]);
+                    const auto raw_size    = read_uint32(input.data() + 1);
+                    const auto stored_size = read_uint32(input.data() + 5);
+
+                    if (type > static_cast<std::uint8_t>(block_type::zstd)
+                        || (type == static_cast<std::uint8_t>(block_type::raw) && raw_size != stored_size)
+                        || input.size() - block_header_size < stored_size) {
+                        throw_invalid_format(U8("The block header is corrupted."));
+                    }
+
+                    input = input.subspan(block_header_size + stored_size);
+                }
+
+                return blocks;
+            }
+
+            static std::size_t get_decompressed_size(std::span<const std::byte> buffer) {
+                std::size_t result{};
+
+                for (auto input = skip_magic_number(buffer); !input.empty();) {
+                    result += read_uint32(input.data() + 1);
+                    input = input.subspan(block_header_size + read_uint32(input.data() + 5));
+                }
+
+                return result;
+            }
+
+            /**
+             * @brief Estimates the compressibility of a block from a few evenly spaced windows.
+             * @param input The block.
+             * @param level The requested compression level.
+             * @return The compression level for the block, or std::nullopt to store it raw.
+             */
+            std::optional<std::int32_t> choose_level(std::span<const std::byte> input, std::int32_t level) {
+                const auto window_count = std::min(sample_window_count, input.size() / sample_window_size);
+
+                if (window_count == 0) {
+                    return level;
+                }
+
+                const auto stride = input.size() / window_count;
+
+                sample_.resize(window_count * sample_window_size);
+
+                for (std::size_t i = 0; i < window_count; i++) {
+                    std::memcpy(
+                        sample_.data() + i * sample_window_size, input.data() + i * stride, sample_window_size);
+                }
+
+                if (get_entropy(sample_) < low_entropy_threshold) {
+                    return level;
+                }
+
+                // High-entropy bytes may still be compressible by matching, which only a trial compression reveals.
+                trial_.resize(inner_->compress_bound(sample_.size()));
+
+                const auto ratio = static_cast<double>(inner_->compress_into(sample_, trial_, fast_level))
+                                 / static_cast<double>(sample_.size());
+
+                if (ratio >= incompressible_ratio) {
+                    return std::nullopt;
+                }
+
+                return ratio >= weak_ratio ? std::min(level, fast_level) : level;
+            }
+
+            std::size_t compress_run(std::span<const std::byte> input, std::span<std::byte> result,
+                const std::optional<std::int32_t>& level) {
+                if (result.size() < block_header_size) {
+                    throw_output_too_small();
+                }
+
+                const auto output = result.subspan(block_header_size);
+                auto type         = block_type::raw;
+                auto stored_size  = input.size();
+
+                if (level) {
+                    const auto bound = inner_->compress_bound(input.size());
+
+                    // Compresses into the output directly when it is large enough for the worst case.
+                    if (output.size() >= bound) {
+                        stored_size = inner_->compress_into(input, output, *level);
+                    } else {
+                        block_.resize(bound);
+                        stored_size = inner_->compress_into(input, block_, *level);
+
+                        if (stored_size < input.size()) {
+                            copy_to(output, std::span{block_.data(), stored_size});
+                        }
+                    }
+
+                    // Falls back to the raw block if the compression does not pay off.
+                    type = stored_size < input.size() ? block_type::zstd : block_type::raw;
+                }
+
+                if (type == block_type::raw) {
+                    stored_size = input.size();
+                    copy_to(output, input);
+                }
+
+                result[0] = static_cast<std::byte>(type);
+                write_uint32(result.data() + 1, static_cast<std::uint32_t>(input.size()));
+                write_uint32(result.data() + 5, static_cast<std::uint32_t>(stored_size));
+
+                return block_header_size + stored_size;
+            }
+
+            static void copy_to(std::span<std::byte> output, std::span<const std::byte> data) {
+                if (output.size() < data.size()) {
+                    throw_output_too_small();
+                }
+
+                std::memcpy(output.data(), data.data(), data.size());
+            }
+
+            compression_options options_;
+            std::size_t block_size_;
+            std::unique_ptr<compression_context> inner_;
+            abi::vector<std::byte> sample_;
+            abi::vector<std::byte> trial_;
+            abi::vector<std::byte> block_;
+        };
+
+        [[maybe_unused]] ES_KEEP_ALIVE struct init {
+            init() {
+                add_compression_routines(compression_mode::adaptive,
+                    compression_routines{
+                        .make_context =
+                            [](const compression_settings& settings) -> std::unique_ptr<compression_context> {
+                            return std::make_unique<adaptive_context>(settings);
+                        },
+                    });
+            }
+        } force_init;
+    } // namespace
+
+#ifdef EMSCRIPTEN
+    ES_KEEP_ALIVE void (*compression_adaptive_keep_alive)() = [] {};
+#endif
+} // namespace essence::io
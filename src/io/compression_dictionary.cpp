@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "io/compression_dictionary.hpp"
+
+#include "char8_t_remediation.hpp"
+#include "error_extensions.hpp"
+
+#include <exception>
+#include <ios>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+#include <zdict.h>
+#include <zstd.h>
+
+namespace essence::io {
+    namespace {
+        using cdict_pointer = std::unique_ptr<ZSTD_CDict, decltype(&ZSTD_freeCDict)>;
+        using ddict_pointer = std::unique_ptr<ZSTD_DDict, decltype(&ZSTD_freeDDict)>;
+    } // namespace
+
+    class compression_dictionary::impl {
+    public:
+        explicit impl(std::span<const std::byte> content)
+            : content_{content.begin(), content.end()},
+              ddict_{ZSTD_createDDict(content_.data(), content_.size()), &ZSTD_freeDDict} {
+            if (content_.empty()) {
+                throw source_code_aware_runtime_error{U8("The content of the dictionary cannot be empty.")};
+            }
+
+            if (!ddict_) {
+                throw source_code_aware_runtime_error{U8("Failed to create the decompression dictionary.")};
+            }
+        }
+
+        [[nodiscard]] std::uint32_t id() const noexcept {
+            return ZDICT_getDictID(content_.data(), content_.size());
+        }
+
+        [[nodiscard]] std::span<const std::byte> content() const noexcept {
+            return content_;
+        }
+
+        [[nodiscard]] ZSTD_CDict* cdict(std::int32_t level) const {
+            std::scoped_lock lock{mutex_};
+
+            // Digests the content only once for each compression level.
+            auto iter = cdicts_.find(level);
+
+            if (iter == cdicts_.end()) {
+                cdict_pointer cdict{ZSTD_createCDict(content_.data(), content_.size(), level), &ZSTD_freeCDict};
+
+                if (!cdict) {
+                    throw source_code_aware_runtime_error{U8("Level"), level, U8("Message"),
+                        U8("Failed to create the compression dictionary.")};
+                }
+
+                iter = cdicts_.emplace(level, std::move(cdict)).first;
+            }
+
+            return iter->second.get();
+        }
+
+        [[nodiscard]] ZSTD_DDict* ddict() const noexcept {
+            return ddict_.get();
+        }
+
+    private:
+        abi::vector<std::byte> content_;
+        ddict_pointer ddict_;
+        mutable std::mutex mutex_;
+        mutable std::unordered_map<std::int32_t, cdict_pointer> cdicts_;
+    };
+
+    compression_dictionary::compression_dictionary(std::span<const std::byte> content)
+        : impl_{std::make_shared<impl>(content)} {}
+
+    compression_dictionary::compression_dictionary(const compression_dictionary&) = default;
+
+    compression_dictionary::compression_dictionary(compression_dictionary&&) noexcept = default;
+
+    compression_dictionary::~compression_dictionary() = default;
+
+    compression_dictionary& compression_dictionary::operator=(const compression_dictionary&) = default;
+
+    compression_dictionary& compression_dictionary::operator=(compression_dictionary&&) noexcept = default;
+
+    compression_dictionary compression_dictionary::train(
+        std::span<const std::byte> samples, std::span<const std::size_t> sample_sizes, std::size_t max_size) {
+        abi::vector<std::byte> buffer(max_size);
+
+        const auto size = ZDICT_trainFromBuffer(buffer.data(), buffer.size(), samples.data(), sample_sizes.data(),
+            static_cast<std::uint32_t>(sample_sizes.size()));
+
+        if (ZDICT_isError(size)) {
+            throw source_code_aware_runtime_error{U8("Sample Count"), sample_sizes.size(), U8("Message"),
+                U8("Failed to train the dictionary."), U8("Internal"), ZDICT_getErrorName(size)};
+        }
+
+        return compression_dictionary{std::span{buffer.data(), size}};
+    }
+
+    compression_dictionary compression_dictionary::from_file(
+        const abstract::virtual_fs_operator& fs_operator, std::string_view path) {
+        const auto stream = [&] {
+            try {
+                return fs_operator.open_read(path, std::ios::in | std::ios::binary);
+            } catch (const std::exception& ex) {
+                throw source_code_aware_runtime_error{U8("File"), path, U8("Message"),
+                    U8("Failed to open the dictionary file."), U8("Internal"), ex.what()};
+            }
+        }();
+
+        const abi::vector<char> content{std::istreambuf_iterator<char>{*stream}, std::istreambuf_iterator<char>{}};
+
+        return compression_dictionary{std::as_bytes(std::span{content})};
+    }
+
+    std::uint32_t compression_dictionary::id() const noexcept {
+        return impl_->id();
+    }
+
+    std::span<const std::byte> compression_dictionary::content() const noexcept {
+        return impl_->content();
+    }
+
+    void* compression_dictionary::to_compression_blob(std::int32_t level) const {
+        return impl_->cdict(level);
+    }
+
+    void* compression_dictionary::to_decompression_blob() const noexcept {
+        return impl_->ddict();
+    }
+} // namespace essence::io
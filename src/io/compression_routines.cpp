@@ -28,10 +28,13 @@
 #include "compat.hpp"
 #endif
 
+#include <algorithm>
 #include <unordered_map>
 
 namespace essence::io {
     namespace {
+        constexpr std::size_t min_decompression_buffer_size = 65536;
+
         auto& get_routines_map() {
             static std::unordered_map<compression_mode, compression_routines> routines;
 
@@ -39,6 +42,24 @@ namespace essence::io {
         }
     } // namespace
 
+    void grow_decompression_buffer(
+        const abstract::writable_buffer& result, std::size_t size_hint, std::size_t max_size) {
+        const auto size = result.size_bytes();
+
+        if (max_size != 0 && size >= max_size) {
+            throw source_code_aware_runtime_error{U8("Max Size"), max_size, U8("Message"),
+                U8("The decompressed data exceeds the maximum size.")};
+        }
+
+        auto new_size = std::max({size * 2, size_hint, min_decompression_buffer_size});
+
+        if (max_size != 0) {
+            new_size = std::min(new_size, max_size);
+        }
+
+        result.resize(new_size);
+    }
+
     compression_routines get_compression_routines(compression_mode mode) {
         if (const auto iter = get_routines_map().find(mode); iter != get_routines_map().end()) {
             return iter->second;
@@ -54,10 +75,12 @@ namespace essence::io {
 #ifdef EMSCRIPTEN
     extern void (*compression_zstd_keep_alive)();
     extern void (*compression_zlibng_keep_alive)();
+    extern void (*compression_adaptive_keep_alive)();
 
     ES_KEEP_ALIVE void keep_alive_for_emscripten() {
         compression_zstd_keep_alive();
         compression_zlibng_keep_alive();
+        compression_adaptive_keep_alive();
     }
 #endif
 } // namespace essence::io
@@ -24,20 +24,75 @@
 
 #include "abstract/writable_buffer.hpp"
 #include "io/common_types.hpp"
+#include "io/compression_dictionary.hpp"
 
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <span>
 
 namespace essence::io {
+    struct compression_settings {
+        compression_options options;
+        std::optional<compression_dictionary> dictionary{};
+    };
+
+    /**
+     * @brief Holds the native compression and decompression contexts of a compresser, whose parameters are set only
+     *        once upon creation.
+     */
+    class compression_context {
+    public:
+        virtual ~compression_context() = default;
+
+        /**
+         * @brief Gets the maximum compressed size of a buffer in the worst case.
+         * @param size The size of the buffer.
+         * @return The maximum compressed size.
+         */
+        [[nodiscard]] virtual std::size_t compress_bound(std::size_t size) = 0;
+
+        /**
+         * @brief Compresses a buffer into a caller-provided buffer.
+         * @param buffer The buffer.
+         * @param result The output buffer.
+         * @param level The compression level.
+         * @return The size of the compressed data.
+         */
+        virtual std::size_t compress_into(
+            std::span<const std::byte> buffer, std::span<std::byte> result, std::int32_t level) = 0;
+
+        /**
+         * @brief Decompresses a buffer into a caller-provided buffer.
+         * @param buffer The buffer.
+         * @param result The output buffer.
+         * @return The size of the decompressed data.
+         */
+        virtual std::size_t decompress_into(std::span<const std::byte> buffer, std::span<std::byte> result) = 0;
+
+        /**
+         * @brief Decompresses a buffer into a growable buffer.
+         * @param buffer The buffer.
+         * @param result The output buffer.
+         */
+        virtual void decompress(std::span<const std::byte> buffer, const abstract::writable_buffer& result) = 0;
+    };
+
     struct compression_routines {
-        std::function<void(
-            std::span<const std::byte> buffer, const abstract::writable_buffer& result, std::int32_t level)>
-            compress;
-        std::function<void(std::span<const std::byte> buffer, const abstract::writable_buffer& result)> decompress;
+        std::function<std::unique_ptr<compression_context>(const compression_settings& settings)> make_context;
     };
 
+    /**
+     * @brief Grows the output buffer geometrically when the size of the decompressed data is unknown in advance.
+     * @param result The output buffer.
+     * @param size_hint The minimum size to grow to.
+     * @param max_size The maximum size of the output buffer, or zero to be unlimited.
+     */
+    void grow_decompression_buffer(
+        const abstract::writable_buffer& result, std::size_t size_hint, std::size_t max_size);
+
     compression_routines get_compression_routines(compression_mode mode);
     void add_compression_routines(compression_mode mode, const compression_routines& routines);
 } // namespace essence::io
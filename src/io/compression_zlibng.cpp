@@ -26,10 +26,20 @@
 #include "error_extensions.hpp"
 #include "source_location.hpp"
 
+#include <algorithm>
+#include <array>
+#include <concepts>
 #include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
 
 #include <zlib.h>
 
+#ifdef CPP_ESSENCE_HAS_THREADS
+#include "thread.hpp"
+#endif
+
 namespace essence::io {
     namespace {
         void check_error(std::int32_t code, const source_location& location = source_location::current()) {
@@ -38,29 +48,387 @@ namespace essence::io {
             }
         }
 
-        void compress(std::span<const std::byte> buffer, const abstract::writable_buffer& result, std::int32_t level) {
-            const auto size = compressBound(static_cast<unsigned long>(buffer.size()));
+        constexpr std::size_t max_chunk_size = std::numeric_limits<uInt>::max();
+
+        // The size of the sliding window of the deflate algorithm.
+        constexpr std::size_t window_size             = 32768;
+        constexpr std::size_t default_gzip_block_size = 128 * 1024;
+        constexpr std::int32_t raw_window_bits        = -MAX_WBITS;
+        constexpr std::int32_t gzip_window_bits       = MAX_WBITS + 16;
+        constexpr std::size_t gzip_header_size        = 10;
+        constexpr std::size_t gzip_trailer_size       = 8;
+
+        // An empty stored block emitted by Z_SYNC_FLUSH.
+        constexpr std::size_t sync_flush_size = 5;
+
+        class deflate_stream {
+        public:
+            deflate_stream(std::int32_t level, std::int32_t window_bits) {
+                check_error(deflateInit2(&stream_, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY));
+            }
+
+            deflate_stream(const deflate_stream&) = delete;
+
+            ~deflate_stream() {
+                deflateEnd(&stream_);
+            }
+
+            deflate_stream& operator=(const deflate_stream&) = delete;
+
+            z_stream* operator->() noexcept {
+                return &stream_;
+            }
+
+            z_stream* get() noexcept {
+                return &stream_;
+            }
+
+        private:
+            z_stream stream_{};
+        };
+
+        class inflate_stream {
+        public:
+            explicit inflate_stream(std::int32_t window_bits) {
+                check_error(inflateInit2(&stream_, window_bits));
+            }
+
+            inflate_stream(const inflate_stream&) = delete;
+
+            ~inflate_stream() {
+                inflateEnd(&stream_);
+            }
+
+            inflate_stream& operator=(const inflate_stream&) = delete;
+
+            z_stream* operator->() noexcept {
+                return &stream_;
+            }
+
+            z_stream* get() noexcept {
+                return &stream_;
+            }
+
+        private:
+            z_stream stream_{};
+        };
+
+        Bytef* to_native(const std::byte* data) noexcept {
+            return reinterpret_cast<Bytef*>(const_cast<std::byte*>(data));
+        }
+
+        /**
+         * @brief Deflates a buffer into a caller-provided buffer.
+         * @param stream The deflate stream.
+         * @param buffer The buffer.
+         * @param result The output buffer.
+         * @param flush The flush mode after the whole buffer is consumed.
+         * @return The size of the compressed data.
+         */
+        std::size_t deflate_into(
+            z_stream* stream, std::span<const std::byte> buffer, std::span<std::byte> result, std::int32_t flush) {
+            std::size_t consumed{};
+            std::size_t position{};
+
+            while (true) {
+                if (position == result.size()) {
+                    throw source_code_aware_runtime_error{U8("The output buffer is too small.")};
+                }
+
+                const auto input_size = std::min(buffer.size() - consumed, max_chunk_size);
+                const auto last       = consumed + input_size == buffer.size();
+
+                stream->next_in   = to_native(buffer.data() + consumed);
+                stream->avail_in  = static_cast<uInt>(input_size);
+                stream->next_out  = reinterpret_cast<Bytef*>(result.data() + position);
+                stream->avail_out = static_cast<uInt>(std::min(result.size() - position, max_chunk_size));
 
-            result.resize(size);
+                const auto available = stream->avail_out;
+                const auto code      = deflate(stream, last ? flush : Z_NO_FLUSH);
 
-            auto actual_size = static_cast<unsigned long>(result.size_bytes());
+                if (code != Z_OK && code != Z_STREAM_END && code != Z_BUF_ERROR) {
+                    check_error(code);
+                }
 
-            check_error(compress2(reinterpret_cast<std::uint8_t*>(result.data()), &actual_size,
-                reinterpret_cast<const std::uint8_t*>(buffer.data()), static_cast<unsigned long>(buffer.size()),
-                level));
+                consumed += input_size - stream->avail_in;
+                position += available - stream->avail_out;
 
-            result.resize(actual_size);
-            result.shrink_to_fit();
+                // A flush other than Z_FINISH completes once deflate leaves some output space unused.
+                if (code == Z_STREAM_END || (flush != Z_FINISH && last && stream->avail_out != 0)) {
+                    return position;
+                }
+            }
         }
 
-        void decompress(std::span<const std::byte> buffer, const abstract::writable_buffer& result) {}
+        /**
+         * @brief The common decompression of the zlib and gzip formats.
+         */
+        class inflating_context : public compression_context {
+        public:
+            inflating_context(const compression_settings& settings, std::int32_t window_bits)
+                : options_{settings.options}, inflater_{window_bits},
+                  multiple_members_{window_bits == gzip_window_bits} {
+                if (settings.dictionary) {
+                    throw source_code_aware_runtime_error{
+                        U8("Dictionaries are not supported by the zlib compression.")};
+                }
+            }
+
+            std::size_t decompress_into(std::span<const std::byte> buffer, std::span<std::byte> result) override {
+                return inflate_with(buffer, result, [](std::size_t) -> std::span<std::byte> {
+                    throw source_code_aware_runtime_error{U8("The output buffer is too small.")};
+                });
+            }
+
+            void decompress(std::span<const std::byte> buffer, const abstract::writable_buffer& result) override {
+                // Neither format records the decompressed size up front, so the output grows on demand.
+                result.resize(0);
+
+                const auto size = inflate_with(buffer, {}, [&](std::size_t) {
+                    grow_decompression_buffer(result, buffer.size() * 4, options_.max_decompressed_size);
+
+                    return std::span{result.data(), result.size_bytes()};
+                });
+
+                result.resize(size);
+                result.shrink_to_fit();
+            }
+
+        protected:
+            compression_options options_;
+
+        private:
+            /**
+             * @brief Inflates a buffer, asking for a larger output buffer once the current one is full.
+             * @param buffer The compressed data.
+             * @param result The initial output buffer.
+             * @param grow The handler that returns the grown output buffer, given the size of the decompressed data.
+             * @return The size of the decompressed data.
+             */
+            template <std::invocable<std::size_t> Grow>
+            std::size_t inflate_with(std::span<const std::byte> buffer, std::span<std::byte> result, Grow&& grow) {
+                check_error(inflateReset(inflater_.get()));
+
+                std::size_t consumed{};
+                std::size_t position{};
+
+                while (true) {
+                    if (position == result.size()) {
+                        result = grow(position);
+                    }
+
+                    const auto input_size = std::min(buffer.size() - consumed, max_chunk_size);
+
+                    inflater_->next_in   = to_native(buffer.data() + consumed);
+                    inflater_->avail_in  = static_cast<uInt>(input_size);
+                    inflater_->next_out  = reinterpret_cast<Bytef*>(result.data() + position);
+                    inflater_->avail_out = static_cast<uInt>(std::min(result.size() - position, max_chunk_size));
+
+                    const auto available = inflater_->avail_out;
+                    const auto code      = inflate(inflater_.get(), Z_NO_FLUSH);
+
+                    consumed += input_size - inflater_->avail_in;
+                    position += available - inflater_->avail_out;
+
+                    if (code == Z_STREAM_END) {
+                        // Concatenated gzip members decompress to the concatenation of their contents.
+                        if (!multiple_members_ || consumed == buffer.size()) {
+                            return position;
+                        }
+
+                        check_error(inflateReset(inflater_.get()));
+                        continue;
+                    }
+
+                    if (code == Z_BUF_ERROR && consumed == buffer.size()) {
+                        throw source_code_aware_runtime_error{U8("The zlib stream is truncated.")};
+                    }
+
+                    if (code != Z_BUF_ERROR) {
+                        check_error(code);
+                    }
+                }
+            }
+
+            inflate_stream inflater_;
+            bool multiple_members_;
+        };
+
+        class zlib_context final : public inflating_context {
+        public:
+            explicit zlib_context(const compression_settings& settings)
+                : inflating_context{settings, MAX_WBITS}, level_{Z_DEFAULT_COMPRESSION},
+                  deflater_{Z_DEFAULT_COMPRESSION, MAX_WBITS} {}
+
+            std::size_t compress_bound(std::size_t size) override {
+                return compressBound(static_cast<uLong>(size));
+            }
+
+            std::size_t compress_into(
+                std::span<const std::byte> buffer, std::span<std::byte> result, std::int32_t level) override {
+                check_error(deflateReset(deflater_.get()));
+
+                if (level != level_) {
+                    check_error(deflateParams(deflater_.get(), level, Z_DEFAULT_STRATEGY));
+                    level_ = level;
+                }
+
+                return deflate_into(deflater_.get(), buffer, result, Z_FINISH);
+            }
+
+        private:
+            std::int32_t level_;
+            deflate_stream deflater_;
+        };
+
+        /**
+         * @brief Compresses blocks of the input concurrently into one standard gzip member, in the way of pigz.
+         */
+        class gzip_context final : public inflating_context {
+        public:
+            explicit gzip_context(const compression_settings& settings)
+                : inflating_context{settings, gzip_window_bits},
+                  block_size_{options_.job_size != 0 ? options_.job_size : default_gzip_block_size} {}
+
+            std::size_t compress_bound(std::size_t size) override {
+                const auto block_count = get_block_count(size);
+
+                return block_count * (compressBound(static_cast<uLong>(block_size_)) + sync_flush_size)
+                     + gzip_header_size + gzip_trailer_size;
+            }
+
+            std::size_t compress_into(
+                std::span<const std::byte> buffer, std::span<std::byte> result, std::int32_t level) override {
+                const auto block_count  = get_block_count(buffer.size());
+                const auto thread_count =
+                    std::max<std::size_t>(std::min<std::size_t>(options_.worker_count, block_count), 1);
+
+                blocks_.resize(block_count);
+
+                while (workers_.size() < thread_count) {
+                    workers_.emplace_back(std::make_unique<deflate_stream>(level, raw_window_bits), level);
+                }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+                parallel_for(0, block_count, thread_count, [&](std::size_t index, std::size_t thread_index, bool&) {
+                    compress_block(buffer, index, block_count, workers_[thread_index], level);
+                });
+#else
+                for (std::size_t i = 0; i < block_count; i++) {
+                    compress_block(buffer, i, block_count, workers_.front(), level);
+                }
+#endif
+
+                // The raw deflate blocks are stitched together between the gzip header and trailer.
+                auto output   = result;
+                auto checksum = crc32_z(0, nullptr, 0);
+
+                // The modification time is left empty and the operating system is unknown.
+                write(output,
+                    std::array<std::uint8_t, gzip_header_size>{0x1F, 0x8B, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xFF});
+
+                for (std::size_t i = 0; i < block_count; i++) {
+                    const auto& block = blocks_[i];
+
+                    write(output, block.output);
+                    checksum = crc32_combine64(checksum, block.checksum, static_cast<z_off64_t>(block.size));
+                }
+
+                write_uint32(output, static_cast<std::uint32_t>(checksum));
+                write_uint32(output, static_cast<std::uint32_t>(buffer.size()));
+
+                return result.size() - output.size();
+            }
+
+        private:
+            struct block {
+                abi::vector<std::byte> output;
+                uLong checksum{};
+                std::size_t size{};
+            };
+
+            struct worker {
+                std::unique_ptr<deflate_stream> stream;
+                std::int32_t level;
+            };
+
+            static void write(std::span<std::byte>& output, std::span<const std::byte> data) {
+                if (output.size() < data.size()) {
+                    throw source_code_aware_runtime_error{U8("The output buffer is too small.")};
+                }
+
+                std::ranges::copy(data, output.begin());
+                output = output.subspan(data.size());
+            }
+
+            template <std::size_t N>
+            static void write(std::span<std::byte>& output, const std::array<std::uint8_t, N>& data) {
+                write(output, std::as_bytes(std::span{data}));
+            }
+
+            static void write_uint32(std::span<std::byte>& output, std::uint32_t value) {
+                write(output, std::array<std::uint8_t, 4>{static_cast<std::uint8_t>(value),
+                                  static_cast<std::uint8_t>(value >> 8), static_cast<std::uint8_t>(value >> 16),
+                                  static_cast<std::uint8_t>(value >> 24)});
+            }
+
+            [[nodiscard]] std::size_t get_block_count(std::size_t size) const noexcept {
+                return std::max<std::size_t>((size + block_size_ - 1) / block_size_, 1);
+            }
+
+            void compress_block(std::span<const std::byte> buffer, std::size_t index, std::size_t block_count,
+                worker& worker, std::int32_t level) {
+                const auto offset = index * block_size_;
+                const auto input  = buffer.subspan(offset, std::min(block_size_, buffer.size() - offset));
+                auto& block       = blocks_[index];
+                const auto stream = worker.stream->get();
+
+                check_error(deflateReset(stream));
+
+                if (level != worker.level) {
+                    check_error(deflateParams(stream, level, Z_DEFAULT_STRATEGY));
+                    worker.level = level;
+                }
+
+                // Primes the block with the tail of the previous one, so that matches may cross the boundary.
+                if (offset != 0) {
+                    const auto dictionary_size = std::min(offset, window_size);
+
+                    check_error(deflateSetDictionary(stream, to_native(buffer.data() + offset - dictionary_size),
+                        static_cast<uInt>(dictionary_size)));
+                }
+
+                // Every block but the last one ends byte-aligned with an empty stored block and without the final
+                // bit, so the blocks can be concatenated.
+                block.output.resize(compressBound(static_cast<uLong>(input.size())) + sync_flush_size);
+                block.output.resize(
+                    deflate_into(stream, input, block.output, index + 1 == block_count ? Z_FINISH : Z_SYNC_FLUSH));
+                block.checksum = crc32_z(0, reinterpret_cast<const Bytef*>(input.data()), input.size());
+                block.size     = input.size();
+            }
+
+            std::size_t block_size_;
+            std::vector<block> blocks_;
+            std::vector<worker> workers_;
+        };
 
         [[maybe_unused]] ES_KEEP_ALIVE struct init {
             init() {
-                add_compression_routines(compression_mode::zlib, compression_routines{
-                                                                     .compress   = &compress,
-                                                                     .decompress = &decompress,
-                                                                 });
+                add_compression_routines(compression_mode::zlib,
+                    compression_routines{
+                        .make_context =
+                            [](const compression_settings& settings) -> std::unique_ptr<compression_context> {
+                            return std::make_unique<zlib_context>(settings);
+                        },
+                    });
+
+                add_compression_routines(compression_mode::gzip,
+                    compression_routines{
+                        .make_context =
+                            [](const compression_settings& settings) -> std::unique_ptr<compression_context> {
+                            return std::make_unique<gzip_context>(settings);
+                        },
+                    });
             }
         } force_init;
     } // namespace
@@ -24,15 +24,22 @@
 #include "compat.hpp"
 #include "compression_routines.hpp"
 #include "error_extensions.hpp"
+#include "memory/generic_resource_pool.hpp"
 #include "source_location.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <optional>
 
 #include <zstd.h>
 #include <zstd_errors.h>
 
 namespace essence::io {
     namespace {
+        // Mirrors ZSTD_WINDOWLOG_LIMIT_DEFAULT, which is only exposed by the static linking API.
+        constexpr std::int32_t default_window_log_limit = 27;
+
         std::size_t check_error(
             std::size_t content_size, const source_location& location = source_location::current()) {
             if (ZSTD_isError(content_size)) {
@@ -45,32 +52,264 @@ namespace essence::io {
             return content_size;
         }
 
-        void compress(std::span<const std::byte> buffer, const abstract::writable_buffer& result, std::int32_t level) {
-            thread_local std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(ZSTD_createCCtx(), ZSTD_freeCCtx);
-            const auto size = check_error(ZSTD_compressBound(buffer.size()));
+        void set_parameter(ZSTD_CCtx* context, ZSTD_cParameter parameter, std::int32_t value,
+            const source_location& location = source_location::current()) {
+            check_error(ZSTD_CCtx_setParameter(context, parameter, value), location);
+        }
+
+        void apply_settings(ZSTD_CCtx* context, std::int32_t level, const compression_settings& settings) {
+            const auto& options = settings.options;
+
+            set_parameter(context, ZSTD_c_compressionLevel, level);
+
+            // The prepared dictionary supersedes the compression parameters.
+            if (settings.dictionary) {
+                check_error(ZSTD_CCtx_refCDict(
+                    context, static_cast<const ZSTD_CDict*>(settings.dictionary->to_compression_blob(level))));
+            }
+
+            // The upper bound is zero if the library is built without multithreading support.
+            if (const auto bounds = ZSTD_cParam_getBounds(ZSTD_c_nbWorkers);
+                options.worker_count != 0 && !ZSTD_isError(bounds.error) && bounds.upperBound > 0) {
+                set_parameter(context, ZSTD_c_nbWorkers,
+                    static_cast<std::int32_t>(
+                        std::min(options.worker_count, static_cast<std::uint32_t>(bounds.upperBound))));
+
+                if (const auto job_bounds = ZSTD_cParam_getBounds(ZSTD_c_jobSize);
+                    options.job_size != 0 && !ZSTD_isError(job_bounds.error)) {
+                    set_parameter(context, ZSTD_c_jobSize,
+                        static_cast<std::int32_t>(
+                            std::min(options.job_size, static_cast<std::size_t>(job_bounds.upperBound))));
+                }
+            }
+
+            if (options.long_distance_matching) {
+                set_parameter(context, ZSTD_c_enableLongDistanceMatching, 1);
+            }
+
+            if (options.window_log != 0) {
+                set_parameter(context, ZSTD_c_windowLog, options.window_log);
+            }
+        }
+
+        void apply_settings(ZSTD_DCtx* context, const compression_settings& settings) {
+            if (settings.dictionary) {
+                check_error(ZSTD_DCtx_refDDict(
+                    context, static_cast<const ZSTD_DDict*>(settings.dictionary->to_decompression_blob())));
+            }
+
+            // Frames compressed with a large window must be explicitly allowed by the decoder.
+            if (settings.options.window_log > default_window_log_limit) {
+                check_error(ZSTD_DCtx_setParameter(context, ZSTD_d_windowLogMax, settings.options.window_log));
+            }
+        }
+
+        /**
+         * @brief Sums up the content sizes of all frames in the buffer.
+         * @param buffer The compressed data, which may consist of multiple concatenated frames.
+         * @return The total content size, or std::nullopt if any frame does not record its content size.
+         */
+        std::optional<std::size_t> get_total_content_size(std::span<const std::byte> buffer) {
+            std::size_t total_size{};
+
+            while (!buffer.empty()) {
+                const auto frame_size   = check_error(ZSTD_findFrameCompressedSize(buffer.data(), buffer.size()));
+                const auto content_size = ZSTD_getFrameContentSize(buffer.data(), frame_size);
+
+                if (content_size == ZSTD_CONTENTSIZE_ERROR) {
+                    throw source_code_aware_runtime_error{U8("Invalid zstd frame.")};
+                }
+
+                if (content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+                    return std::nullopt;
+                }
+
+                total_size += static_cast<std::size_t>(content_size);
+                buffer = buffer.subspan(frame_size);
+            }
+
+            return total_size;
+        }
+
+        using cctx_ptr = std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)>;
+        using dctx_ptr = std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)>;
 
-            result.resize(size);
+        /**
+         * @brief Bounds the idle contexts kept by each pool.
+         */
+        constexpr resource_pool_options context_pool_options{.max_size = 16, .thread_cache_size = 2};
 
-            const auto actual_size = check_error(ZSTD_compressCCtx(
-                context.get(), result.data(), result.size_bytes(), buffer.data(), buffer.size(), level));
+        /**
+         * @brief The workspace sizes beyond which a released context is freed instead of pooled, so that a single
+         *        high-level or large-window job does not pin its memory for the lifetime of the process.
+         */
+        constexpr std::size_t max_pooled_cctx_size = 32 * 1024 * 1024;
+        constexpr std::size_t max_pooled_dctx_size = 16 * 1024 * 1024;
 
-            result.resize(actual_size);
-            result.shrink_to_fit();
+        /**
+         * @brief Gets the pool of the compression contexts, whose workspaces survive the contexts being reset so that
+         *        short-lived compressers skip the large allocations.
+         * @return The pool.
+         */
+        const generic_resource_pool<cctx_ptr>& get_cctx_pool() {
+            static const generic_resource_pool<cctx_ptr> pool{
+                [] {
+                    if (cctx_ptr context{ZSTD_createCCtx(), &ZSTD_freeCCtx}) {
+                        return context;
+                    }
+
+                    throw source_code_aware_runtime_error{U8("Failed to create the zstd compression context.")};
+                },
+                [](cctx_ptr& context) {
+                    return ZSTD_sizeof_CCtx(context.get()) <= max_pooled_cctx_size
+                        && !ZSTD_isError(ZSTD_CCtx_reset(context.get(), ZSTD_reset_session_and_parameters));
+                },
+                context_pool_options};
+
+            return pool;
         }
 
-        void decompress(std::span<const std::byte> buffer, const abstract::writable_buffer& result) {
-            const auto content_size = check_error(ZSTD_getFrameContentSize(buffer.data(), buffer.size()));
+        /**
+         * @brief Gets the pool of the decompression contexts.
+         * @return The pool.
+         */
+        const generic_resource_pool<dctx_ptr>& get_dctx_pool() {
+            static const generic_resource_pool<dctx_ptr> pool{
+                [] {
+                    if (dctx_ptr context{ZSTD_createDCtx(), &ZSTD_freeDCtx}) {
+                        return context;
+                    }
 
-            result.resize(content_size);
-            check_error(ZSTD_decompress(result.data(), result.size_bytes(), buffer.data(), buffer.size()));
+                    throw source_code_aware_runtime_error{U8("Failed to create the zstd decompression context.")};
+                },
+                [](dctx_ptr& context) {
+                    return ZSTD_sizeof_DCtx(context.get()) <= max_pooled_dctx_size
+                        && !ZSTD_isError(ZSTD_DCtx_reset(context.get(), ZSTD_reset_session_and_parameters));
+                },
+                context_pool_options};
+
+            return pool;
         }
 
+        class zstd_context final : public compression_context {
+        public:
+            explicit zstd_context(const compression_settings& settings)
+                : settings_{settings}, level_{ZSTD_CLEVEL_DEFAULT},
+                  compression_context_{get_cctx_pool().acquire()}, decompression_context_{get_dctx_pool().acquire()} {
+                apply_settings(compression_context_->get(), level_, settings_);
+                apply_settings(decompression_context_->get(), settings_);
+            }
+
+            std::size_t compress_bound(std::size_t size) override {
+                return check_error(ZSTD_compressBound(size));
+            }
+
+            std::size_t compress_into(
+                std::span<const std::byte> buffer, std::span<std::byte> result, std::int32_t level) override {
+                select_level(level);
+
+                // The session is reset by ZSTD_compress2 while the parameters are kept.
+                return check_error(ZSTD_compress2(
+                    compression_context_->get(), result.data(), result.size(), buffer.data(), buffer.size()));
+            }
+
+            std::size_t decompress_into(std::span<const std::byte> buffer, std::span<std::byte> result) override {
+                if (settings_.dictionary) {
+                    return check_error(ZSTD_decompress_usingDDict(decompression_context_->get(), result.data(),
+                        result.size(), buffer.data(), buffer.size(),
+                        static_cast<const ZSTD_DDict*>(settings_.dictionary->to_decompression_blob())));
+                }
+
+                return check_error(ZSTD_decompressDCtx(
+                    decompression_context_->get(), result.data(), result.size(), buffer.data(), buffer.size()));
+            }
+
+            void decompress(std::span<const std::byte> buffer, const abstract::writable_buffer& result) override {
+                const auto max_size     = settings_.options.max_decompressed_size;
+                const auto content_size = get_total_content_size(buffer);
+
+                // Falls back to streaming when any frame omits its content size, e.g. frames written by a streaming
+                // encoder.
+                if (!content_size) {
+                    return decompress_stream(buffer, result);
+                }
+
+                if (max_size != 0 && *content_size > max_size) {
+                    throw source_code_aware_runtime_error{U8("Content Size"), *content_size, U8("Max Size"), max_size,
+                        U8("Message"), U8("The decompressed data exceeds the maximum size.")};
+                }
+
+                result.resize(*content_size);
+                result.resize(decompress_into(buffer, std::span{result.data(), result.size_bytes()}));
+            }
+
+        private:
+            void select_level(std::int32_t level) {
+                if (level == level_) {
+                    return;
+                }
+
+                set_parameter(compression_context_->get(), ZSTD_c_compressionLevel, level);
+
+                if (settings_.dictionary) {
+                    check_error(ZSTD_CCtx_refCDict(compression_context_->get(),
+                        static_cast<const ZSTD_CDict*>(settings_.dictionary->to_compression_blob(level))));
+                }
+
+                level_ = level;
+            }
+
+            void decompress_stream(std::span<const std::byte> buffer, const abstract::writable_buffer& result) {
+                const auto context = decompression_context_->get();
+
+                check_error(ZSTD_DCtx_reset(context, ZSTD_reset_session_only));
+
+                ZSTD_inBuffer input{buffer.data(), buffer.size(), 0};
+                std::size_t position{};
+                std::size_t remaining{};
+
+                result.resize(0);
+
+                while (true) {
+                    if (position == result.size_bytes()) {
+                        grow_decompression_buffer(
+                            result, ZSTD_DStreamOutSize(), settings_.options.max_decompressed_size);
+                    }
+
+                    ZSTD_outBuffer output{result.data(), result.size_bytes(), position};
+
+                    remaining = check_error(ZSTD_decompressStream(context, &output, &input));
+                    position  = output.pos;
+
+                    // The decoder may still hold flushable data while the output buffer is full.
+                    if (input.pos == input.size && (remaining == 0 || output.pos < output.size)) {
+                        break;
+                    }
+                }
+
+                if (remaining != 0) {
+                    throw source_code_aware_runtime_error{U8("The zstd frame is truncated.")};
+                }
+
+                result.resize(position);
+                result.shrink_to_fit();
+            }
+
+            compression_settings settings_;
+            std::int32_t level_;
+            generic_resource_pool<cctx_ptr>::lease compression_context_;
+            generic_resource_pool<dctx_ptr>::lease decompression_context_;
+        };
+
         [[maybe_unused]] ES_KEEP_ALIVE struct init {
             init() {
-                add_compression_routines(compression_mode::zstd, compression_routines{
-                                                                     .compress   = &compress,
-                                                                     .decompress = &decompress,
-                                                                 });
+                add_compression_routines(compression_mode::zstd,
+                    compression_routines{
+                        .make_context =
+                            [](const compression_settings& settings) -> std::unique_ptr<compression_context> {
+                            return std::make_unique<zstd_context>(settings);
+                        },
+                    });
             }
         } force_init;
     } // namespace
@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "io/directory_scanner.hpp"
+
+#include "char8_t_remediation.hpp"
+#include "error_extensions.hpp"
+#include "string.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+#include "thread.hpp"
+
+#include <condition_variable>
+#include <thread>
+#endif
+
+namespace essence::io {
+    namespace {
+        abi::string join_path(std::string_view directory, std::string_view name) {
+            abi::string result;
+
+            result.reserve(directory.size() + name.size() + 1);
+            result.append(directory);
+
+            if (!result.empty() && !result.ends_with(U8('/'))) {
+                result.push_back(U8('/'));
+            }
+
+            result.append(name);
+
+            return result;
+        }
+
+        std::string_view get_extension(std::string_view name) noexcept {
+            const auto position = name.rfind(U8('.'));
+
+            // A leading dot names a hidden file rather than an extension.
+            return position == std::string_view::npos || position == 0 ? std::string_view{} : name.substr(position);
+        }
+
+        /**
+         * @brief The shared state of a scan, in which each worker owns a deque of directories. A worker takes the
+         *        newest directory of its own deque, which keeps the traversal depth-first and cache-friendly, and
+         *        steals the oldest one of the others when its deque runs dry.
+         */
+        class scan_context {
+        public:
+            scan_context(const abstract::virtual_fs_operator& fs_operator, const scan_batch_handler& handler,
+                const directory_scan_options& options, std::size_t worker_count)
+                : fs_operator_{fs_operator}, handler_{handler}, options_{options},
+                  query_size_{options.query_size || options.min_size != 0
+                              || options.max_size != std::numeric_limits<std::uint64_t>::max()},
+                  queues_(worker_count) {}
+
+            void push(std::size_t worker, abi::string directory) {
+                pending_.fetch_add(1, std::memory_order::relaxed);
+
+                {
+                    std::scoped_lock lock{queues_[worker].mutex};
+
+                    queues_[worker].directories.emplace_back(std::move(directory));
+                }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+                {
+                    std::scoped_lock lock{idle_mutex_};
+
+                    pushed_.fetch_add(1, std::memory_order::release);
+                }
+
+                idle_.notify_one();
+#endif
+            }
+
+            void run(std::size_t worker) {
+                while (!stopped_.load(std::memory_order::relaxed)) {
+#ifdef CPP_ESSENCE_HAS_THREADS
+                    // Counted before looking for a directory, so that one pushed after a failed steal ends the wait.
+                    const auto pushed = pushed_.load(std::memory_order::acquire);
+#endif
+
+                    if (auto directory = pop(worker)) {
+                        process(worker, *directory);
+                        complete();
+
+                        continue;
+                    }
+
+                    if (pending_.load(std::memory_order::acquire) == 0) {
+                        break;
+                    }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+                    std::unique_lock lock{idle_mutex_};
+
+                    idle_.wait(lock, [&] {
+                        return stopped_.load(std::memory_order::relaxed)
+                            || pending_.load(std::memory_order::acquire) == 0
+                            || pushed_.load(std::memory_order::relaxed) != pushed;
+                    });
+#endif
+                }
+            }
+
+            void rethrow_if_failed() const {
+                if (error_) {
+                    std::rethrow_exception(error_);
+                }
+            }
+
+        private:
+            struct worker_queue {
+                std::mutex mutex;
+                std::deque<abi::string> directories;
+            };
+
+            void complete() {
+#ifdef CPP_ESSENCE_HAS_THREADS
+                std::unique_lock lock{idle_mutex_};
+#endif
+
+                if (pending_.fetch_sub(1, std::memory_order::acq_rel) == 1) {
+#ifdef CPP_ESSENCE_HAS_THREADS
+                    lock.unlock();
+                    idle_.notify_all();
+#endif
+                }
+            }
+
+            void stop() {
+                {
+#ifdef CPP_ESSENCE_HAS_THREADS
+                    std::scoped_lock lock{idle_mutex_};
+#endif
+
+                    stopped_.store(true, std::memory_order::relaxed);
+                }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+                idle_.notify_all();
+#endif
+            }
+
+            std::optional<abi::string> pop(std::size_t worker) {
+                for (std::size_t i = 0; i < queues_.size(); i++) {
+                    auto&& queue = queues_[(worker + i) % queues_.size()];
+                    std::scoped_lock lock{queue.mutex};
+
+                    if (queue.directories.empty()) {
+                        continue;
+                    }
+
+                    abi::string result;
+
+                    if (i == 0) {
+                        result = std::move(queue.directories.back());
+                        queue.directories.pop_back();
+                    } else {
+                        result = std::move(queue.directories.front());
+                        queue.directories.pop_front();
+                    }
+
+                    return result;
+                }
+
+                return std::nullopt;
+            }
+
+            void process(std::size_t worker, std::string_view directory) {
+                try {
+                    std::vector<scan_entry> batch;
+
+                    for (auto&& item : list(directory)) {
+                        auto path = join_path(directory, item.name);
+
+                        if (item.type == directory_entry_type::directory) {
+                            if (options_.include_directories) {
+                                batch.emplace_back(scan_entry{path, item.type, 0});
+                            }
+
+                            if ((!item.symlink || options_.follow_symlinks)
+                                && (!options_.directory_filter || options_.directory_filter(path))) {
+                                push(worker, std::move(path));
+                            }
+                        } else if (item.type == directory_entry_type::file && accepts_extension(item.name)) {
+                            if (auto entry = make_file_entry(std::move(path))) {
+                                batch.emplace_back(std::move(*entry));
+                            }
+                        }
+                    }
+
+                    if (options_.filter) {
+                        std::erase_if(batch, [this](const scan_entry& entry) { return !options_.filter(entry); });
+                    }
+
+                    if (!batch.empty() && !handler_(batch)) {
+                        stop();
+                    }
+                } catch (...) {
+                    fail(std::current_exception());
+                }
+            }
+
+            abi::vector<directory_entry> list(std::string_view directory) {
+                try {
+                    return fs_operator_.list_directory(directory);
+                } catch (...) {
+                    if (!options_.skip_errors) {
+                        throw;
+                    }
+                }
+
+                return {};
+            }
+
+            [[nodiscard]] bool accepts_extension(std::string_view name) const {
+                if (options_.extensions.empty()) {
+                    return true;
+                }
+
+                const auto extension = get_extension(name);
+
+                return std::ranges::any_of(options_.extensions,
+                    [&](std::string_view item) { return icase_string_comparer{}(extension, item); });
+            }
+
+            std::optional<scan_entry> make_file_entry(abi::string path) {
+                scan_entry result{std::move(path), directory_entry_type::file, 0};
+
+                if (query_size_) {
+                    try {
+                        result.size = fs_operator_.file_size(result.path);
+                    } catch (...) {
+                        if (!options_.skip_errors) {
+                            throw;
+                        }
+
+                        return std::nullopt;
+                    }
+
+                    if (result.size < options_.min_size || result.size > options_.max_size) {
+                        return std::nullopt;
+                    }
+                }
+
+                return result;
+            }
+
+            void fail(std::exception_ptr error) {
+                {
+                    std::scoped_lock lock{error_mutex_};
+
+                    if (!error_) {
+                        error_ = std::move(error);
+                    }
+                }
+
+                stop();
+            }
+
+            const abstract::virtual_fs_operator& fs_operator_;
+            const scan_batch_handler& handler_;
+            const directory_scan_options& options_;
+            bool query_size_;
+            std::vector<worker_queue> queues_;
+            std::atomic_size_t pending_;
+            std::atomic_bool stopped_;
+            std::mutex error_mutex_;
+            std::exception_ptr error_;
+#ifdef CPP_ESSENCE_HAS_THREADS
+            std::atomic_size_t pushed_;
+            std::mutex idle_mutex_;
+            std::condition_variable idle_;
+#endif
+        };
+    } // namespace
+
+    void scan_directory(const abstract::virtual_fs_operator& fs_operator, std::string_view root,
+        const scan_batch_handler& handler, const directory_scan_options& options) {
+        if (!fs_operator.is_directory(root)) {
+            throw source_code_aware_runtime_error{U8("Path"), root, U8("Message"), U8("The root is not a directory.")};
+        }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+        const std::size_t worker_count =
+            options.worker_count != 0 ? options.worker_count : std::max(std::thread::hardware_concurrency(), 1U);
+#else
+        const std::size_t worker_count = 1;
+#endif
+
+        scan_context context{fs_operator, handler, options, worker_count};
+
+        context.push(0, abi::string{root});
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+        if (worker_count > 1) {
+            parallel_for(0, worker_count, worker_count,
+                [&](std::size_t index, [[maybe_unused]] std::size_t thread_index, [[maybe_unused]] bool& exit) {
+                    context.run(index);
+                });
+        } else {
+            context.run(0);
+        }
+#else
+        context.run(0);
+#endif
+
+        context.rethrow_if_failed();
+    }
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+    class directory_scanner::impl {
+    public:
+        impl(abstract::virtual_fs_operator fs_operator, std::string_view root, const directory_scan_options& options,
+            std::size_t queue_capacity)
+            : fs_operator_{std::move(fs_operator)}, root_{root}, options_{options},
+              queue_capacity_{std::max<std::size_t>(queue_capacity, 1)}, worker_{[this] { scan(); }} {}
+
+        ~impl() {
+            cancel();
+        }
+
+        [[nodiscard]] std::optional<scan_entry> next() {
+            std::unique_lock lock{mutex_};
+
+            not_empty_.wait(lock, [this] { return !entries_.empty() || completed_ || cancelled_; });
+
+            if (cancelled_) {
+                return std::nullopt;
+            }
+
+            if (entries_.empty()) {
+                if (auto error = std::exchange(error_, nullptr)) {
+                    std::rethrow_exception(error);
+                }
+
+                return std::nullopt;
+            }
+
+            auto result = std::move(entries_.front());
+
+            entries_.pop_front();
+            not_full_.notify_one();
+
+            return result;
+        }
+
+        void cancel() {
+            {
+                std::scoped_lock lock{mutex_};
+
+                cancelled_ = true;
+            }
+
+            not_full_.notify_all();
+            not_empty_.notify_all();
+        }
+
+    private:
+        void scan() {
+            try {
+                scan_directory(
+                    fs_operator_, root_,
+                    [this](std::span<const scan_entry> entries) {
+                        std::unique_lock lock{mutex_};
+
+                        for (auto&& item : entries) {
+                            not_full_.wait(lock, [this] { return entries_.size() < queue_capacity_ || cancelled_; });
+
+                            if (cancelled_) {
+                                return false;
+                            }
+
+                            entries_.emplace_back(item);
+                            not_empty_.notify_one();
+                        }
+
+                        return true;
+                    },
+                    options_);
+            } catch (...) {
+                std::scoped_lock lock{mutex_};
+
+                error_ = std::current_exception();
+            }
+
+            {
+                std::scoped_lock lock{mutex_};
+
+                completed_ = true;
+            }
+
+            not_empty_.notify_all();
+        }
+
+        abstract::virtual_fs_operator fs_operator_;
+        std::string root_;
+        directory_scan_options options_;
+        std::size_t queue_capacity_;
+        std::mutex mutex_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+        std::deque<scan_entry> entries_;
+        std::exception_ptr error_;
+        bool completed_{};
+        bool cancelled_{};
+        std::jthread worker_;
+    };
+
+    directory_scanner::directory_scanner(abstract::virtual_fs_operator fs_operator, std::string_view root,
+        const directory_scan_options& options, std::size_t queue_capacity)
+        : impl_{std::make_unique<impl>(std::move(fs_operator), root, options, queue_capacity)} {}
+
+    directory_scanner::directory_scanner(directory_scanner&&) noexcept = default;
+
+    directory_scanner::~directory_scanner() = default;
+
+    directory_scanner& directory_scanner::operator=(directory_scanner&&) noexcept = default;
+
+    std::optional<scan_entry> directory_scanner::next() const {
+        return impl_->next();
+    }
+
+    void directory_scanner::cancel() const {
+        impl_->cancel();
+    }
+#endif
+} // namespace essence::io
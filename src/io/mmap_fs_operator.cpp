@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "io/mmap_fs_operator.hpp"
+
+#include "abi/vector.hpp"
+#include "char8_t_remediation.hpp"
+#include "error_extensions.hpp"
+#include "io/fs_operator.hpp"
+#include "io/spanstream.hpp"
+#include "native_file.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+
+#include <sys/mman.h>
+#endif
+
+namespace essence::io {
+    namespace {
+#ifdef _WIN32
+        void* map_file(const native_file& file, std::size_t size, std::string_view path) {
+            const native_file::handle_type mapping{
+                CreateFileMappingW(file.handle().get(), nullptr, PAGE_READONLY, 0, 0, nullptr)};
+
+            // The view keeps the mapping alive after the handles are closed.
+            const auto address = mapping ? MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, size) : nullptr;
+
+            if (!address) {
+                throw source_code_aware_runtime_error{U8("File"), path, U8("Message"), U8("Failed to map the file."),
+                    U8("Internal"), std::system_category().message(static_cast<std::int32_t>(GetLastError()))};
+            }
+
+            return address;
+        }
+#else
+        void* map_file(const native_file& file, std::size_t size, std::string_view path) {
+            // The mapping stays valid after the descriptor is closed.
+            const auto address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.handle().get(), 0);
+
+            if (address == MAP_FAILED) {
+                throw source_code_aware_runtime_error{U8("File"), path, U8("Message"), U8("Failed to map the file."),
+                    U8("Internal"), std::generic_category().message(errno)};
+            }
+
+            return address;
+        }
+#endif
+
+        /**
+         * @brief A stream over the content of a file, which keeps the content alive.
+         */
+        class mapped_istream final : public ispanstream {
+        public:
+            mapped_istream(mapped_buffer buffer, std::ios_base::openmode mode)
+                : ispanstream{std::span{reinterpret_cast<const char*>(buffer.data()), buffer.size()}, mode},
+                  buffer_{std::move(buffer)} {}
+
+        private:
+            mapped_buffer buffer_;
+        };
+    } // namespace
+
+    class mapped_buffer::impl {
+    public:
+        impl() noexcept = default;
+
+        explicit impl(abi::vector<std::byte> buffer) noexcept : buffer_{std::move(buffer)}, span_{buffer_} {}
+
+        impl(void* address, std::size_t size) noexcept
+            : address_{address}, span_{static_cast<const std::byte*>(address), size} {}
+
+        impl(const impl&) = delete;
+
+        ~impl() {
+            if (address_) {
+#ifdef _WIN32
+                UnmapViewOfFile(address_);
+#else
+                munmap(address_, span_.size());
+#endif
+            }
+        }
+
+        impl& operator=(const impl&) = delete;
+
+        [[nodiscard]] std::span<const std::byte> span() const noexcept {
+            return span_;
+        }
+
+    private:
+        void* address_{};
+        abi::vector<std::byte> buffer_;
+        std::span<const std::byte> span_;
+    };
+
+    mapped_buffer::mapped_buffer(std::shared_ptr<const impl> impl) noexcept : impl_{std::move(impl)} {}
+
+    std::span<const std::byte> mapped_buffer::span() const noexcept {
+        return impl_ ? impl_->span() : std::span<const std::byte>{};
+    }
+
+    mmap_fs_operator::mmap_fs_operator(std::size_t small_file_threshold)
+        : small_file_threshold_{small_file_threshold} {}
+
+    bool mmap_fs_operator::exists(std::string_view path) noexcept {
+        return get_native_fs_operator().exists(path);
+    }
+
+    bool mmap_fs_operator::is_file(std::string_view path) noexcept {
+        return get_native_fs_operator().is_file(path);
+    }
+
+    bool mmap_fs_operator::is_directory(std::string_view path) noexcept {
+        return get_native_fs_operator().is_directory(path);
+    }
+
+    std::unique_ptr<std::iostream> mmap_fs_operator::open(
+        [[maybe_unused]] std::string_view path, [[maybe_unused]] std::ios_base::openmode mode) {
+        throw source_code_aware_runtime_error{
+            U8("This memory-mapped file is read-only and cannot be opened as std::iostream.")};
+    }
+
+    std::unique_ptr<std::istream> mmap_fs_operator::open_read(
+        std::string_view path, std::ios_base::openmode mode) const {
+        auto stream = std::make_unique<mapped_istream>(map_read(path), mode);
+
+        stream->exceptions(std::ios_base::badbit);
+
+        return stream;
+    }
+
+    std::unique_ptr<std::ostream> mmap_fs_operator::open_write(
+        [[maybe_unused]] std::string_view path, [[maybe_unused]] std::ios_base::openmode mode) {
+        throw source_code_aware_runtime_error{
+            U8("This memory-mapped file is read-only and cannot be opened as std::ostream.")};
+    }
+
+    mapped_buffer mmap_fs_operator::map_read(std::string_view path) const {
+        const auto file = native_file::open_read(path);
+        const auto size = static_cast<std::size_t>(file.size());
+
+        if (size == 0) {
+            return mapped_buffer{std::make_shared<const mapped_buffer::impl>()};
+        }
+
+        if (size < small_file_threshold_) {
+            return mapped_buffer{std::make_shared<const mapped_buffer::impl>(file.read_all())};
+        }
+
+        return mapped_buffer{std::make_shared<const mapped_buffer::impl>(map_file(file, size, path), size)};
+    }
+
+    abi::vector<std::byte> mmap_fs_operator::read_all(std::string_view path) {
+        return native_file::open_read(path).read_all();
+    }
+
+    std::size_t mmap_fs_operator::read_range(std::string_view path, std::uint64_t offset, std::span<std::byte> result) {
+        return native_file::open_read(path).read_at(offset, result);
+    }
+
+    void mmap_fs_operator::write_all(
+        [[maybe_unused]] std::string_view path, [[maybe_unused]] std::span<const std::byte> buffer) {
+        throw source_code_aware_runtime_error{U8("This memory-mapped file is read-only and cannot be written.")};
+    }
+
+    std::uint64_t mmap_fs_operator::file_size(std::string_view path) {
+        return native_file::open_read(path).size();
+    }
+
+    std::filesystem::file_time_type mmap_fs_operator::last_write_time(std::string_view path) {
+        return get_native_fs_operator().last_write_time(path);
+    }
+
+    abi::vector<directory_entry> mmap_fs_operator::list_directory(std::string_view path) {
+        return get_native_fs_operator().list_directory(path);
+    }
+
+    const abstract::virtual_fs_operator& get_mmap_fs_operator() {
+        static const abstract::virtual_fs_operator fs_operator{mmap_fs_operator{}};
+
+        return fs_operator;
+    }
+} // namespace essence::io
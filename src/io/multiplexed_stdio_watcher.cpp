@@ -0,0 +1,497 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "io/multiplexed_stdio_watcher.hpp"
+
+#include "char8_t_remediation.hpp"
+#include "delegate.hpp"
+#include "error_extensions.hpp"
+
+#ifndef _WIN32
+#include "managed_handle.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+#endif
+
+namespace essence::io {
+#ifdef _WIN32
+    class multiplexed_stdio_watcher::impl {
+    public:
+        explicit impl([[maybe_unused]] const multiplexed_stdio_options& options) {}
+
+        [[noreturn]] static void watch([[maybe_unused]] stdio_watcher_mode mode) {
+            throw_not_supported();
+        }
+
+        [[noreturn]] static void watch([[maybe_unused]] std::int32_t descriptor) {
+            throw_not_supported();
+        }
+
+        [[noreturn]] static void start() {
+            throw_not_supported();
+        }
+
+        static void stop() noexcept {}
+
+        void on_lines(const stdio_lines_handler& handler) {
+            on_lines_ += handler;
+        }
+
+    private:
+        [[noreturn]] static void throw_not_supported() {
+            throw source_code_aware_runtime_error{U8("The multiplexed stdio watcher is not supported on Windows.")};
+        }
+
+        delegate<stdio_lines_handler> on_lines_;
+    };
+#else
+    namespace {
+        using posix_handle = unique_handle<&close, std::uintptr_t, std::int32_t>;
+
+        constexpr std::size_t read_size = 64 * 1024;
+
+        [[noreturn]] void throw_system_error(const char* message) {
+            throw source_code_aware_runtime_error{
+                U8("Message"), message, U8("Internal"), std::generic_category().message(errno)};
+        }
+
+        std::array<posix_handle, 2> make_pipe() {
+            std::array<std::int32_t, 2> handles{};
+
+            if (pipe(handles.data()) == -1) {
+                throw_system_error(U8("Failed to create a pipe."));
+            }
+
+            fcntl(handles[0], F_SETFD, FD_CLOEXEC);
+            fcntl(handles[1], F_SETFD, FD_CLOEXEC);
+
+            return {posix_handle{handles[0]}, posix_handle{handles[1]}};
+        }
+
+        /**
+         * @brief Waits for any of the registered descriptors to become readable, on epoll or poll.
+         */
+        class readiness_poller {
+        public:
+            readiness_poller() {
+#ifdef __linux__
+                handle_.reset(epoll_create1(EPOLL_CLOEXEC));
+
+                if (!handle_) {
+                    throw_system_error(U8("Failed to create an epoll instance."));
+                }
+#endif
+            }
+
+            void add(std::int32_t descriptor, std::size_t key) {
+#ifdef __linux__
+                epoll_event event{.events = EPOLLIN, .data = {.u64 = key}};
+
+                if (epoll_ctl(handle_.get(), EPOLL_CTL_ADD, descriptor, &event) == -1) {
+                    throw_system_error(U8("Failed to watch the descriptor."));
+                }
+#else
+                descriptors_.emplace_back(pollfd{.fd = descriptor, .events = POLLIN});
+                keys_.emplace_back(key);
+#endif
+            }
+
+            void remove(std::int32_t descriptor) {
+#ifdef __linux__
+                epoll_ctl(handle_.get(), EPOLL_CTL_DEL, descriptor, nullptr);
+#else
+                for (auto&& item : descriptors_) {
+                    if (item.fd == descriptor) {
+                        // Negative descriptors are ignored by poll.
+                        item.fd = -1;
+                    }
+                }
+#endif
+            }
+
+            /**
+             * @brief Waits for readable descriptors.
+             * @param timeout The timeout in milliseconds, or -1 to wait infinitely.
+             * @param keys The keys of the readable descriptors, including the closed ones.
+             */
+            void wait(std::int32_t timeout, std::vector<std::size_t>& keys) {
+                keys.clear();
+
+#ifdef __linux__
+                std::array<epoll_event, 64> events{};
+                const auto count = epoll_wait(handle_.get(), events.data(), events.size(), timeout);
+
+                for (std::int32_t i = 0; i < count; i++) {
+                    keys.emplace_back(static_cast<std::size_t>(events[i].data.u64));
+                }
+#else
+                if (poll(descriptors_.data(), descriptors_.size(), timeout) > 0) {
+                    for (std::size_t i = 0; i < descriptors_.size(); i++) {
+                        const auto& item = descriptors_[i];
+
+                        if (item.fd >= 0 && (item.revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+                            keys.emplace_back(keys_[i]);
+                        }
+                    }
+                }
+#endif
+            }
+
+        private:
+#ifdef __linux__
+            posix_handle handle_;
+#else
+            std::vector<pollfd> descriptors_;
+            std::vector<std::size_t> keys_;
+#endif
+        };
+    } // namespace
+
+    class multiplexed_stdio_watcher::impl {
+    public:
+        explicit impl(const multiplexed_stdio_options& options)
+            : options_{options}, buffer_(read_size) {}
+
+        ~impl() {
+            stop();
+        }
+
+        void watch(stdio_watcher_mode mode) {
+            ensure_stopped();
+            sources_.emplace_back(mode == stdio_watcher_mode::output ? fileno(stdout) : fileno(stderr), true);
+        }
+
+        void watch(std::int32_t descriptor) {
+            ensure_stopped();
+            sources_.emplace_back(descriptor, false);
+        }
+
+        void start() {
+            stop();
+
+            // Everything that may fail is set up on the calling thread, so that the errors reach the caller.
+            try {
+                for (auto&& item : sources_) {
+                    item.pending.clear();
+                    item.open = true;
+
+                    if (item.redirected) {
+                        redirect(item);
+                    }
+                }
+
+                auto [wake_read, wake_write] = make_pipe();
+                readiness_poller poller;
+
+                for (std::size_t i = 0; i < sources_.size(); i++) {
+                    poller.add(sources_[i].readable_descriptor(), i);
+                }
+
+                poller.add(static_cast<std::int32_t>(wake_read.get()), sources_.size());
+
+                wake_read_  = std::move(wake_read);
+                wake_write_ = std::move(wake_write);
+                worker_     = std::jthread{[this, poller = std::move(poller)]() mutable { dispatch_lines(poller); }};
+            } catch (...) {
+                restore_descriptors();
+
+                for (auto&& item : sources_) {
+                    item.pipe_read.reset();
+                }
+
+                throw;
+            }
+        }
+
+        void stop() {
+            if (!worker_.joinable()) {
+                return;
+            }
+
+            // Restores the original descriptors, after which the pipes reach the end once drained.
+            restore_descriptors();
+
+            static constexpr char signal{};
+
+            static_cast<void>(write(wake_write_.get(), &signal, sizeof(signal)));
+            worker_.join();
+
+            for (auto&& item : sources_) {
+                item.pipe_read.reset();
+            }
+
+            wake_read_.reset();
+            wake_write_.reset();
+        }
+
+        void on_lines(const stdio_lines_handler& handler) {
+            on_lines_ += handler;
+        }
+
+    private:
+        struct source {
+            source(std::int32_t descriptor, bool redirected) noexcept
+                : descriptor{descriptor}, redirected{redirected} {}
+
+            std::int32_t descriptor;
+            bool redirected;
+            posix_handle origin;
+            posix_handle pipe_read;
+            posix_handle pipe_write;
+            std::string pending;
+            bool open{};
+
+            [[nodiscard]] std::int32_t readable_descriptor() const noexcept {
+                return redirected ? static_cast<std::int32_t>(pipe_read.get()) : descriptor;
+            }
+        };
+
+        struct line_record {
+            std::int32_t source{};
+            std::chrono::system_clock::time_point timestamp;
+            std::size_t offset{};
+            std::size_t size{};
+        };
+
+        void ensure_stopped() const {
+            if (worker_.joinable()) {
+                throw source_code_aware_runtime_error{
+                    U8("The descriptors must be added while the watcher is stopped.")};
+            }
+        }
+
+        void restore_descriptors() {
+            for (auto&& item : sources_) {
+                if (item.origin) {
+                    dup2(item.origin.get(), item.descriptor);
+                    item.origin.reset();
+                    item.pipe_write.reset();
+                }
+            }
+        }
+
+        void redirect(source& item) const {
+            std::fflush(item.descriptor == fileno(stdout) ? stdout : stderr);
+
+            auto [pipe_read, pipe_write] = make_pipe();
+
+#ifdef F_SETPIPE_SZ
+            // A larger pipe lets a heavily logging writer run ahead without blocking; failures are harmless.
+            if (options_.pipe_size != 0) {
+                fcntl(pipe_write.get(), F_SETPIPE_SZ, static_cast<std::int32_t>(options_.pipe_size));
+            }
+#endif
+
+            item.origin.reset(dup(item.descriptor));
+
+            if (!item.origin || dup2(pipe_write.get(), item.descriptor) == -1) {
+                throw_system_error(U8("Failed to redirect the stdio descriptor to the pipe."));
+            }
+
+            item.pipe_read  = std::move(pipe_read);
+            item.pipe_write = std::move(pipe_write);
+        }
+
+        void dispatch_lines(readiness_poller& poller) {
+            std::vector<std::size_t> keys;
+
+            // Reads once per readable descriptor and delivers everything received in one wakeup as a single batch.
+            for (bool stopping{}; !stopping;) {
+                poller.wait(-1, keys);
+
+                for (const auto key : keys) {
+                    if (key == sources_.size()) {
+                        stopping = true;
+                    } else {
+                        read_source(poller, sources_[key]);
+                    }
+                }
+
+                deliver();
+            }
+
+            // Drains whatever is left without blocking.
+            for (poller.wait(0, keys); !keys.empty(); poller.wait(0, keys)) {
+                bool progressed{};
+
+                for (const auto key : keys) {
+                    if (key != sources_.size() && sources_[key].open) {
+                        read_source(poller, sources_[key]);
+                        progressed = true;
+                    }
+                }
+
+                if (!progressed) {
+                    break;
+                }
+            }
+
+            for (auto&& item : sources_) {
+                flush_pending(item, std::chrono::system_clock::now());
+            }
+
+            deliver();
+        }
+
+        void read_source(readiness_poller& poller, source& item) {
+            const auto size = read(item.readable_descriptor(), buffer_.data(), buffer_.size());
+            const auto now  = std::chrono::system_clock::now();
+
+            if (size > 0) {
+                append(item, std::string_view{buffer_.data(), static_cast<std::size_t>(size)}, now);
+            } else if (size == 0 || (errno != EINTR && errno != EAGAIN)) {
+                flush_pending(item, now);
+                poller.remove(item.readable_descriptor());
+                item.open = false;
+            }
+        }
+
+        void append(source& item, std::string_view data, std::chrono::system_clock::time_point timestamp) {
+            for (auto position = data.find(U8('\n')); position != std::string_view::npos;
+                position       = data.find(U8('\n'))) {
+                if (item.pending.empty()) {
+                    emit(item.descriptor, data.substr(0, position), timestamp);
+                } else {
+                    item.pending.append(data.substr(0, position));
+                    emit(item.descriptor, item.pending, timestamp);
+                    item.pending.clear();
+                }
+
+                data.remove_prefix(position + 1);
+            }
+
+            item.pending.append(data);
+
+            // Cuts an overlong partial line so that the buffered data stay bounded.
+            if (const auto limit = options_.max_line_size; limit != 0 && item.pending.size() >= limit) {
+                const auto size = item.pending.size() / limit * limit;
+
+                for (std::size_t offset = 0; offset < size; offset += limit) {
+                    record(item.descriptor, std::string_view{item.pending}.substr(offset, limit), timestamp);
+                }
+
+                item.pending.erase(0, size);
+            }
+        }
+
+        void flush_pending(source& item, std::chrono::system_clock::time_point timestamp) {
+            if (!item.pending.empty()) {
+                emit(item.descriptor, item.pending, timestamp);
+                item.pending.clear();
+            }
+        }
+
+        void emit(std::int32_t descriptor, std::string_view text, std::chrono::system_clock::time_point timestamp) {
+            if (text.ends_with(U8('\r'))) {
+                text.remove_suffix(1);
+            }
+
+            if (const auto limit = options_.max_line_size; limit != 0) {
+                for (; text.size() > limit; text.remove_prefix(limit)) {
+                    record(descriptor, text.substr(0, limit), timestamp);
+                }
+            }
+
+            record(descriptor, text, timestamp);
+        }
+
+        void record(std::int32_t descriptor, std::string_view text, std::chrono::system_clock::time_point timestamp) {
+            records_.emplace_back(line_record{descriptor, timestamp, batch_text_.size(), text.size()});
+            batch_text_.append(text);
+        }
+
+        void deliver() {
+            if (records_.empty()) {
+                return;
+            }
+
+            // The views are made after the whole batch is collected, since appending may move the text.
+            lines_.clear();
+
+            for (auto&& item : records_) {
+                lines_.emplace_back(stdio_line{item.source, item.timestamp,
+                    std::string_view{batch_text_}.substr(item.offset, item.size)});
+            }
+
+            on_lines_.try_invoke(std::span<const stdio_line>{lines_});
+            records_.clear();
+            batch_text_.clear();
+        }
+
+        multiplexed_stdio_options options_;
+        std::vector<source> sources_;
+        std::vector<char> buffer_;
+        std::vector<line_record> records_;
+        std::vector<stdio_line> lines_;
+        std::string batch_text_;
+        posix_handle wake_read_;
+        posix_handle wake_write_;
+        std::jthread worker_;
+        delegate<stdio_lines_handler> on_lines_;
+    };
+#endif
+
+    multiplexed_stdio_watcher::multiplexed_stdio_watcher(const multiplexed_stdio_options& options)
+        : impl_{std::make_unique<impl>(options)} {}
+
+    multiplexed_stdio_watcher::multiplexed_stdio_watcher(multiplexed_stdio_watcher&&) noexcept = default;
+
+    multiplexed_stdio_watcher::~multiplexed_stdio_watcher() = default;
+
+    multiplexed_stdio_watcher& multiplexed_stdio_watcher::operator=(multiplexed_stdio_watcher&&) noexcept = default;
+
+    void multiplexed_stdio_watcher::watch(stdio_watcher_mode mode) const {
+        impl_->watch(mode);
+    }
+
+    void multiplexed_stdio_watcher::watch(std::int32_t descriptor) const {
+        impl_->watch(descriptor);
+    }
+
+    void multiplexed_stdio_watcher::start() const {
+        impl_->start();
+    }
+
+    void multiplexed_stdio_watcher::stop() const {
+        impl_->stop();
+    }
+
+    void multiplexed_stdio_watcher::on_lines(const stdio_lines_handler& handler) const {
+        impl_->on_lines(handler);
+    }
+} // namespace essence::io
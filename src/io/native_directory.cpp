@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "native_directory.hpp"
+
+#include "char8_t_remediation.hpp"
+#include "error_extensions.hpp"
+
+#include <filesystem>
+#include <system_error>
+
+#ifndef _WIN32
+#include "managed_handle.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace essence::io {
+#ifdef _WIN32
+    abi::vector<directory_entry> list_native_directory(std::string_view path) {
+        abi::vector<directory_entry> result;
+        std::error_code code;
+
+        for (std::filesystem::directory_iterator iter{to_u8string(path), code}, end; !code && iter != end;
+            iter.increment(code)) {
+            const auto type = iter->is_directory(code) ? directory_entry_type::directory
+                            : iter->is_regular_file(code) ? directory_entry_type::file
+                                                          : directory_entry_type::other;
+
+            result.emplace_back(directory_entry{from_u8string(iter->path().filename().u8string()), type,
+                iter->is_symlink(code)});
+        }
+
+        if (code) {
+            throw source_code_aware_runtime_error{U8("Path"), path, U8("Message"), U8("Failed to list the directory."),
+                U8("Internal"), code.message()};
+        }
+
+        return result;
+    }
+#else
+    namespace {
+        using posix_handle = unique_handle<&close, std::uintptr_t, std::int32_t>;
+
+        directory_entry_type get_type(mode_t mode) noexcept {
+            if (S_ISREG(mode)) {
+                return directory_entry_type::file;
+            }
+
+            return S_ISDIR(mode) ? directory_entry_type::directory : directory_entry_type::other;
+        }
+
+        /**
+         * @brief Classifies an entry by the type reported by the directory, querying the metadata relative to the
+         *        directory only for symbolic links and unknown types.
+         */
+        directory_entry make_entry(std::int32_t directory, const char* name, std::uint8_t type) {
+            directory_entry result{name, directory_entry_type::other, false};
+
+            switch (type) {
+            case DT_REG:
+                result.type = directory_entry_type::file;
+                break;
+            case DT_DIR:
+                result.type = directory_entry_type::directory;
+                break;
+            case DT_LNK:
+            case DT_UNKNOWN:
+                if (struct stat status {}; fstatat(directory, name, &status, AT_SYMLINK_NOFOLLOW) == 0) {
+                    result.symlink = S_ISLNK(status.st_mode);
+                    result.type    = get_type(status.st_mode);
+
+                    // A broken link stays as other.
+                    if (result.symlink && fstatat(directory, name, &status, 0) == 0) {
+                        result.type = get_type(status.st_mode);
+                    }
+                }
+
+                break;
+            default:
+                break;
+            }
+
+            return result;
+        }
+
+        bool is_dot_or_dot_dot(const char* name) noexcept {
+            return std::strcmp(name, U8(".")) == 0 || std::strcmp(name, U8("..")) == 0;
+        }
+    } // namespace
+
+    abi::vector<directory_entry> list_native_directory(std::string_view path) {
+        const posix_handle directory{open(std::string{path}.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        abi::vector<directory_entry> result;
+
+        const auto throw_error = [&] {
+            throw source_code_aware_runtime_error{U8("Path"), path, U8("Message"), U8("Failed to list the directory."),
+                U8("Internal"), std::generic_category().message(errno)};
+        };
+
+        if (!directory) {
+            throw_error();
+        }
+
+        const auto descriptor = static_cast<std::int32_t>(directory.get());
+
+#ifdef __linux__
+        // Reads many entries per system call, instead of the small buffer used by readdir.
+        alignas(std::uint64_t) std::array<char, 64 * 1024> buffer;
+
+        while (true) {
+            const auto size = syscall(SYS_getdents64, descriptor, buffer.data(), buffer.size());
+
+            if (size == 0) {
+                break;
+            }
+
+            if (size < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                throw_error();
+            }
+
+            for (long offset = 0; offset < size;) {
+                // The layout of struct linux_dirent64: d_ino (8), d_off (8), d_reclen (2), d_type (1), d_name.
+                const auto record = buffer.data() + offset;
+                std::uint16_t record_size{};
+
+                std::memcpy(&record_size, record + 16, sizeof(record_size));
+
+                const auto type = static_cast<std::uint8_t>(record[18]);
+                const auto name = record + 19;
+
+                if (!is_dot_or_dot_dot(name)) {
+                    result.emplace_back(make_entry(descriptor, name, type));
+                }
+
+                offset += record_size;
+            }
+        }
+#else
+        const auto duplicate = dup(descriptor);
+        const auto stream    = duplicate != -1 ? fdopendir(duplicate) : nullptr;
+
+        if (!stream) {
+            if (duplicate != -1) {
+                close(duplicate);
+            }
+
+            throw_error();
+        }
+
+        int error{};
+
+        // Only a null return of readdir reports an error through errno, which make_entry may set meanwhile.
+        for (;;) {
+            errno           = 0;
+            const auto item = readdir(stream);
+
+            if (!item) {
+                error = errno;
+                break;
+            }
+
+            if (!is_dot_or_dot_dot(item->d_name)) {
+                result.emplace_back(make_entry(descriptor, item->d_name, item->d_type));
+            }
+        }
+
+        closedir(stream);
+
+        if (error != 0) {
+            errno = error;
+            throw_error();
+        }
+#endif
+
+        return result;
+    }
+#endif
+} // namespace essence::io
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "native_file.hpp"
+
+#include "char8_t_remediation.hpp"
+#include "error_extensions.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace essence::io {
+    namespace {
+        // The maximum size of one single system call, which some platforms limit to 32 bits.
+        constexpr std::size_t max_chunk_size = std::numeric_limits<std::int32_t>::max();
+
+        std::int32_t get_last_error() noexcept {
+#ifdef _WIN32
+            return static_cast<std::int32_t>(GetLastError());
+#else
+            return errno;
+#endif
+        }
+    } // namespace
+
+    native_file::native_file(handle_type handle, std::string_view path) : handle_{std::move(handle)}, path_{path} {}
+
+    void native_file::throw_error(const char* message) const {
+        throw source_code_aware_runtime_error{U8("File"), path_, U8("Message"), message, U8("Internal"),
+            std::system_category().message(get_last_error())};
+    }
+
+#ifdef _WIN32
+    native_file native_file::open_read(std::string_view path) {
+        native_file file{handle_type{CreateFileW(std::filesystem::path{to_u8string(path)}.c_str(), GENERIC_READ,
+                             FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)},
+            path};
+
+        if (!file.handle_) {
+            file.throw_error(U8("Failed to open the file."));
+        }
+
+        return file;
+    }
+
+    native_file native_file::open_write(std::string_view path) {
+        native_file file{handle_type{CreateFileW(std::filesystem::path{to_u8string(path)}.c_str(), GENERIC_WRITE, 0,
+                             nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)},
+            path};
+
+        if (!file.handle_) {
+            file.throw_error(U8("Failed to open the file."));
+        }
+
+        return file;
+    }
+
+    std::uint64_t native_file::size() const {
+        LARGE_INTEGER size{};
+
+        if (!GetFileSizeEx(handle_.get(), &size)) {
+            throw_error(U8("Failed to get the size of the file."));
+        }
+
+        return static_cast<std::uint64_t>(size.QuadPart);
+    }
+
+    std::size_t native_file::read_at(std::uint64_t offset, std::span<std::byte> buffer) const {
+        std::size_t position{};
+
+        while (position < buffer.size()) {
+            OVERLAPPED overlapped{};
+            DWORD read_size{};
+            const auto current = offset + position;
+
+            overlapped.Offset     = static_cast<DWORD>(current);
+            overlapped.OffsetHigh = static_cast<DWORD>(current >> 32);
+
+            if (!ReadFile(handle_.get(), buffer.data() + position,
+                    static_cast<DWORD>(std::min(buffer.size() - position, max_chunk_size)), &read_size,
+                    &overlapped)) {
+                if (GetLastError() == ERROR_HANDLE_EOF) {
+                    break;
+                }
+
+                throw_error(U8("Failed to read the file."));
+            }
+
+            if (read_size == 0) {
+                break;
+            }
+
+            position += read_size;
+        }
+
+        return position;
+    }
+
+    void native_file::write(std::span<const std::byte> buffer) const {
+        for (std::size_t position = 0; position < buffer.size();) {
+            DWORD written_size{};
+
+            if (!WriteFile(handle_.get(), buffer.data() + position,
+                    static_cast<DWORD>(std::min(buffer.size() - position, max_chunk_size)), &written_size, nullptr)) {
+                throw_error(U8("Failed to write the file."));
+            }
+
+            position += written_size;
+        }
+    }
+#else
+    native_file native_file::open_read(std::string_view path) {
+        native_file file{
+            handle_type{::open(std::filesystem::path{to_u8string(path)}.c_str(), O_RDONLY | O_CLOEXEC)}, path};
+
+        if (!file.handle_) {
+            file.throw_error(U8("Failed to open the file."));
+        }
+
+        struct stat status {};
+
+        if (fstat(file.handle_.get(), &status) != 0) {
+            file.throw_error(U8("Failed to get the status of the file."));
+        }
+
+        if (!S_ISREG(status.st_mode)) {
+            throw source_code_aware_runtime_error{U8("File"), path, U8("Message"), U8("Not a regular file.")};
+        }
+
+        return file;
+    }
+
+    native_file native_file::open_write(std::string_view path) {
+        native_file file{handle_type{::open(std::filesystem::path{to_u8string(path)}.c_str(),
+                             O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666)},
+            path};
+
+        if (!file.handle_) {
+            file.throw_error(U8("Failed to open the file."));
+        }
+
+        return file;
+    }
+
+    std::uint64_t native_file::size() const {
+        struct stat status {};
+
+        if (fstat(handle_.get(), &status) != 0) {
+            throw_error(U8("Failed to get the size of the file."));
+        }
+
+        return static_cast<std::uint64_t>(status.st_size);
+    }
+
+    std::size_t native_file::read_at(std::uint64_t offset, std::span<std::byte> buffer) const {
+        std::size_t position{};
+
+        while (position < buffer.size()) {
+            const auto read_size = pread(handle_.get(), buffer.data() + position,
+                std::min(buffer.size() - position, max_chunk_size), static_cast<off_t>(offset + position));
+
+            if (read_size < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (read_size < 0) {
+                throw_error(U8("Failed to read the file."));
+            }
+
+            if (read_size == 0) {
+                break;
+            }
+
+            position += static_cast<std::size_t>(read_size);
+        }
+
+        return position;
+    }
+
+    void native_file::write(std::span<const std::byte> buffer) const {
+        for (std::size_t position = 0; position < buffer.size();) {
+            const auto written_size =
+                ::write(handle_.get(), buffer.data() + position, std::min(buffer.size() - position, max_chunk_size));
+
+            if (written_size < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (written_size < 0) {
+                throw_error(U8("Failed to write the file."));
+            }
+
+            position += static_cast<std::size_t>(written_size);
+        }
+    }
+#endif
+
+    abi::vector<std::byte> native_file::read_all() const {
+        abi::vector<std::byte> result(static_cast<std::size_t>(size()));
+
+        result.resize(read_at(0, result));
+
+        return result;
+    }
+} // namespace essence::io
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "abi/vector.hpp"
+#include "managed_handle.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NOGDI
+
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace essence::io {
+    /**
+     * @brief A native file accessed by direct system calls, bypassing the buffers of file streams.
+     */
+    class native_file {
+    public:
+#ifdef _WIN32
+        using handle_type = unique_handle<&CloseHandle>;
+#else
+        using handle_type = unique_handle<&close, std::uintptr_t, std::int32_t>;
+#endif
+
+        /**
+         * @brief Opens an existing regular file to read.
+         * @param path The path of the file.
+         * @return The file.
+         */
+        static native_file open_read(std::string_view path);
+
+        /**
+         * @brief Creates or truncates a file to write.
+         * @param path The path of the file.
+         * @return The file.
+         */
+        static native_file open_write(std::string_view path);
+
+        /**
+         * @brief Gets the size of the file.
+         * @return The size of the file.
+         */
+        [[nodiscard]] std::uint64_t size() const;
+
+        /**
+         * @brief Reads the file at an offset without moving the file pointer.
+         * @param offset The offset.
+         * @param buffer The output buffer.
+         * @return The number of bytes read, which is less than the size of the buffer only at the end of the file.
+         */
+        std::size_t read_at(std::uint64_t offset, std::span<std::byte> buffer) const;
+
+        /**
+         * @brief Reads the whole file.
+         * @return The content of the file.
+         */
+        [[nodiscard]] abi::vector<std::byte> read_all() const;
+
+        /**
+         * @brief Writes a buffer at the current file pointer.
+         * @param buffer The buffer.
+         */
+        void write(std::span<const std::byte> buffer) const;
+
+        /**
+         * @brief Gets the underlying handle.
+         * @return The underlying handle.
+         */
+        [[nodiscard]] const handle_type& handle() const noexcept {
+            return handle_;
+        }
+
+    private:
+        native_file(handle_type handle, std::string_view path);
+
+        [[noreturn]] void throw_error(const char* message) const;
+
+        handle_type handle_;
+        std::string path_;
+    };
+} // namespace essence::io
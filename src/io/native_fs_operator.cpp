@@ -22,11 +22,16 @@
 
 #include "char8_t_remediation.hpp"
 #include "io/fs_operator.hpp"
+#include "native_directory.hpp"
+#include "native_file.hpp"
 
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include <span>
 #include <string_view>
 #include <system_error>
 
@@ -76,6 +81,35 @@ namespace essence::io {
                 std::string_view path, std::ios_base::openmode mode) {
                 return make_unique_stream<std::ofstream>(path, mode);
             }
+
+            [[nodiscard]] [[maybe_unused]] static abi::vector<std::byte> read_all(std::string_view path) {
+                return native_file::open_read(path).read_all();
+            }
+
+            [[maybe_unused]] static std::size_t read_range(
+                std::string_view path, std::uint64_t offset, std::span<std::byte> result) {
+                return native_file::open_read(path).read_at(offset, result);
+            }
+
+            [[maybe_unused]] static void write_all(std::string_view path, std::span<const std::byte> buffer) {
+                native_file::open_write(path).write(buffer);
+            }
+
+            [[nodiscard]] [[maybe_unused]] static std::uint64_t file_size(std::string_view path) {
+                return native_file::open_read(path).size();
+            }
+
+            [[nodiscard]] [[maybe_unused]] static std::filesystem::file_time_type last_write_time(
+                std::string_view path) noexcept {
+                std::error_code code;
+                const auto result = std::filesystem::last_write_time(to_u8string(path), code);
+
+                return code ? std::filesystem::file_time_type{} : result;
+            }
+
+            [[nodiscard]] [[maybe_unused]] static abi::vector<directory_entry> list_directory(std::string_view path) {
+                return list_native_directory(path);
+            }
         };
     } // namespace
 
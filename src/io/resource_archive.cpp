@@ -0,0 +1,627 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "io/resource_archive.hpp"
+
+#include "char8_t_remediation.hpp"
+#include "error_extensions.hpp"
+#include "io/common_types.hpp"
+#include "io/compresser.hpp"
+#include "io/fs_operator.hpp"
+#include "io/mmap_fs_operator.hpp"
+#include "io/spanstream.hpp"
+#include "native_file.hpp"
+#include "string.hpp"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <zstd.h>
+
+namespace essence::io {
+    namespace {
+        // The layout of an archive, in which all integers are little-endian:
+        //   header: magic (4), version (u32), entry count (u32), reserved (u32), data offset (u64), reserved (u64)
+        //   index:  one record per entry sorted by the path in byte order
+        //           path offset in the string table (u32), path size (u32), method (u32), reserved (u32),
+        //           offset of the data (u64), stored size (u64), original size (u64)
+        //   string table: the concatenated paths
+        //   data: the entries, each of which starts at a 4 KiB boundary
+        constexpr std::array archive_magic{std::byte{'E'}, std::byte{'S'}, std::byte{'R'}, std::byte{'A'}};
+        constexpr std::uint32_t archive_version = 1;
+        constexpr std::size_t header_size       = 32;
+        constexpr std::size_t record_size       = 40;
+        constexpr std::size_t entry_alignment   = 4096;
+
+        // The largest original size accepted for a compressed entry whose frame omits its content size.
+        constexpr std::uint64_t max_unsized_entry_size = 1024 * 1024 * 1024;
+
+        enum class entry_method : std::uint32_t {
+            stored,
+            zstd,
+        };
+
+        using content_ptr = std::shared_ptr<const abi::vector<std::byte>>;
+
+        template <std::unsigned_integral T>
+        void store_le(std::byte* output, T value) noexcept {
+            for (std::size_t i = 0; i < sizeof(T); i++) {
+                output[i] = static_cast<std::byte>(value >> (i * 8) & 0xFF);
+            }
+        }
+
+        template <std::unsigned_integral T>
+        T load_le(const std::byte* input) noexcept {
+            T value{};
+
+            for (std::size_t i = 0; i < sizeof(T); i++) {
+                value |= static_cast<T>(std::to_integer<T>(input[i]) << (i * 8));
+            }
+
+            return value;
+        }
+
+        std::uint64_t align_up(std::uint64_t value) noexcept {
+            return (value + entry_alignment - 1) / entry_alignment * entry_alignment;
+        }
+
+        /**
+         * @brief Converts a path to the form in the archive, i.e. with '/' as the separator and without leading or
+         *        trailing separators.
+         */
+        std::string normalize_path(std::string_view path) {
+            std::string result{path};
+
+            std::ranges::replace(result, U8('\\'), U8('/'));
+
+            std::string_view view{result};
+
+            while (view.starts_with(U8("./")) || view.starts_with(U8('/'))) {
+                view.remove_prefix(view.starts_with(U8('/')) ? 1 : 2);
+            }
+
+            while (view.ends_with(U8('/'))) {
+                view.remove_suffix(1);
+            }
+
+            return std::string{view};
+        }
+
+        /**
+         * @brief A stream over the content of an entry, which keeps the archive and the decompressed content alive.
+         */
+        class archive_istream final : public ispanstream {
+        public:
+            archive_istream(std::span<const std::byte> data, mapped_buffer archive, content_ptr content,
+                std::ios_base::openmode mode)
+                : ispanstream{std::span{reinterpret_cast<const char*>(data.data()), data.size()}, mode},
+                  archive_{std::move(archive)}, content_{std::move(content)} {}
+
+        private:
+            mapped_buffer archive_;
+            content_ptr content_;
+        };
+
+        struct pending_entry {
+            std::string path;
+            entry_method method{};
+            std::uint64_t size{};
+            abi::vector<std::byte> data;
+        };
+
+        struct archive_entry {
+            std::string_view path;
+            entry_method method{};
+            std::uint64_t offset{};
+            std::uint64_t stored_size{};
+            std::uint64_t size{};
+        };
+
+        /**
+         * @brief The content of an entry, which is either a view of the mapped archive or decompressed data.
+         */
+        struct entry_content {
+            std::span<const std::byte> data;
+            content_ptr owner;
+        };
+    } // namespace
+
+    class resource_archive_writer::impl {
+    public:
+        explicit impl(const resource_archive_writer_options& options)
+            : options_{options}, compresser_{compression_mode::zstd} {}
+
+        [[nodiscard]] std::size_t entry_count() const noexcept {
+            return entries_.size();
+        }
+
+        void add(std::string_view path, std::span<const std::byte> content) {
+            auto normalized = normalize_path(path);
+
+            if (normalized.empty()) {
+                throw source_code_aware_runtime_error{
+                    U8("Path"), path, U8("Message"), U8("The path of the entry is empty.")};
+            }
+
+            if (paths_.contains(normalized)) {
+                throw source_code_aware_runtime_error{U8("Path"), path, U8("Message"), U8("The entry already exists.")};
+            }
+
+            pending_entry entry{normalized, entry_method::stored, content.size(), {}};
+
+            // Small or incompressible entries are cheaper to serve without decompression.
+            if (options_.compress && !content.empty()) {
+                if (auto compressed = compresser_.as_bytes(content, options_.level);
+                    compressed.size() < content.size()) {
+                    entry.method = entry_method::zstd;
+                    entry.data   = std::move(compressed);
+                }
+            }
+
+            if (entry.method == entry_method::stored) {
+                entry.data.assign(content.begin(), content.end());
+            }
+
+            entries_.emplace_back(std::move(entry));
+            paths_.emplace(std::move(normalized));
+        }
+
+        void add_file(std::string_view path, std::string_view source_path) {
+            add(path, native_file::open_read(source_path).read_all());
+        }
+
+        void add_directory(std::string_view directory, std::string_view prefix) {
+            const std::filesystem::path root{to_u8string(directory)};
+            const auto normalized_prefix = normalize_path(prefix);
+
+            for (auto&& item : std::filesystem::recursive_directory_iterator{
+                     root, std::filesystem::directory_options::skip_permission_denied}) {
+                if (!item.is_regular_file()) {
+                    continue;
+                }
+
+                const auto relative = from_u8string(item.path().lexically_relative(root).generic_u8string());
+
+                add_file(normalized_prefix.empty() ? relative : normalized_prefix + U8('/') + relative,
+                    from_u8string(item.path().u8string()));
+            }
+        }
+
+        void save(std::string_view path) const {
+            if (entries_.size() > std::numeric_limits<std::uint32_t>::max()) {
+                throw source_code_aware_runtime_error{
+                    U8("Path"), path, U8("Message"), U8("There are too many entries in the archive.")};
+            }
+
+            std::vector<const pending_entry*> sorted;
+
+            sorted.reserve(entries_.size());
+
+            for (auto&& item : entries_) {
+                sorted.emplace_back(&item);
+            }
+
+            std::ranges::sort(sorted, {}, &pending_entry::path);
+
+            // Lays out the header, the index and the string table, which are written in one go.
+            std::size_t string_table_size{};
+
+            for (const auto item : sorted) {
+                string_table_size += item->path.size();
+            }
+
+            const auto string_table_offset = header_size + record_size * sorted.size();
+            const auto data_offset         = align_up(string_table_offset + string_table_size);
+            abi::vector<std::byte> head(data_offset);
+
+            std::ranges::copy(archive_magic, head.begin());
+            store_le(&head[4], archive_version);
+            store_le(&head[8], static_cast<std::uint32_t>(sorted.size()));
+            store_le(&head[16], data_offset);
+
+            std::uint64_t offset = data_offset;
+            std::size_t path_offset{};
+
+            for (std::size_t i = 0; i < sorted.size(); i++) {
+                const auto& item  = *sorted[i];
+                const auto record = &head[header_size + record_size * i];
+
+                store_le(record, static_cast<std::uint32_t>(path_offset));
+                store_le(record + 4, static_cast<std::uint32_t>(item.path.size()));
+                store_le(record + 8, static_cast<std::uint32_t>(item.method));
+                store_le(record + 16, offset);
+                store_le(record + 24, static_cast<std::uint64_t>(item.data.size()));
+                store_le(record + 32, item.size);
+
+                std::memcpy(&head[string_table_offset + path_offset], item.path.data(), item.path.size());
+                path_offset += item.path.size();
+                offset = align_up(offset + item.data.size());
+            }
+
+            const auto file = native_file::open_write(path);
+            static constexpr std::array<std::byte, entry_alignment> padding{};
+
+            file.write(head);
+
+            for (std::size_t i = 0; i < sorted.size(); i++) {
+                const auto& data = sorted[i]->data;
+
+                file.write(data);
+
+                if (i + 1 != sorted.size()) {
+                    file.write(std::span{padding}.first(align_up(data.size()) - data.size()));
+                }
+            }
+        }
+
+    private:
+        resource_archive_writer_options options_;
+        compresser compresser_;
+        std::vector<pending_entry> entries_;
+        std::unordered_set<std::string, string_hash, std::equal_to<>> paths_;
+    };
+
+    class resource_archive_fs_operator::impl {
+    public:
+        impl(std::string_view path, const resource_archive_options& options)
+            : archive_{mmap_fs_operator{0}.map_read(path)}, time_{get_native_fs_operator().last_write_time(path)},
+              cache_capacity_{options.cache_capacity} {
+            parse(path);
+        }
+
+        [[nodiscard]] std::size_t entry_count() const noexcept {
+            return entries_.size();
+        }
+
+        [[nodiscard]] const archive_entry* find(std::string_view path) const {
+            const auto normalized = normalize_path(path);
+            const auto iter       = std::ranges::lower_bound(entries_, normalized, {}, &archive_entry::path);
+
+            return iter != entries_.end() && iter->path == normalized ? &*iter : nullptr;
+        }
+
+        [[nodiscard]] bool is_directory(std::string_view path) const {
+            const auto normalized = normalize_path(path);
+
+            if (normalized.empty()) {
+                return true;
+            }
+
+            const auto prefix = normalized + U8('/');
+            const auto iter   = std::ranges::lower_bound(entries_, prefix, {}, &archive_entry::path);
+
+            return iter != entries_.end() && iter->path.starts_with(prefix);
+        }
+
+        [[nodiscard]] abi::vector<directory_entry> list_directory(std::string_view path) const {
+            const auto normalized = normalize_path(path);
+            const auto prefix     = normalized.empty() ? normalized : normalized + U8('/');
+            abi::vector<directory_entry> result;
+
+            if (!is_directory(normalized)) {
+                throw source_code_aware_runtime_error{
+                    U8("Path"), path, U8("Message"), U8("The directory does not exist in the resource archive.")};
+            }
+
+            // The entries under the directory are contiguous in the sorted index, and so are those of a subdirectory.
+            for (auto iter = std::ranges::lower_bound(entries_, prefix, {}, &archive_entry::path);
+                iter != entries_.end() && iter->path.starts_with(prefix);) {
+                const auto name = iter->path.substr(prefix.size());
+
+                if (const auto separator = name.find(U8('/')); separator == std::string_view::npos) {
+                    result.emplace_back(directory_entry{abi::string{name}, directory_entry_type::file, false});
+                    ++iter;
+                } else {
+                    const auto child = iter->path.substr(0, prefix.size() + separator + 1);
+
+                    result.emplace_back(directory_entry{
+                        abi::string{name.substr(0, separator)}, directory_entry_type::directory, false});
+
+                    iter = std::ranges::find_if_not(
+                        iter, entries_.end(), [&](std::string_view item) { return item.starts_with(child); },
+                        &archive_entry::path);
+                }
+            }
+
+            return result;
+        }
+
+        [[nodiscard]] const archive_entry& get(std::string_view path) const {
+            if (const auto entry = find(path)) {
+                return *entry;
+            }
+
+            throw source_code_aware_runtime_error{
+                U8("Path"), path, U8("Message"), U8("The entry does not exist in the resource archive.")};
+        }
+
+        [[nodiscard]] const mapped_buffer& archive() const noexcept {
+            return archive_;
+        }
+
+        [[nodiscard]] const std::filesystem::file_time_type& time() const noexcept {
+            return time_;
+        }
+
+        [[nodiscard]] entry_content content(const archive_entry& entry) {
+            const auto stored = archive_.span().subspan(entry.offset, entry.stored_size);
+
+            if (entry.method == entry_method::stored) {
+                return entry_content{stored, nullptr};
+            }
+
+            const auto index = static_cast<std::size_t>(&entry - entries_.data());
+
+            {
+                std::scoped_lock lock{mutex_};
+
+                if (const auto iter = cache_.find(index); iter != cache_.end()) {
+                    lru_.splice(lru_.begin(), lru_, iter->second.second);
+
+                    return entry_content{*iter->second.first, iter->second.first};
+                }
+            }
+
+            // The zstd contexts are pooled, so that concurrent reads neither share a context nor allocate one.
+            const compresser decompresser{compression_mode::zstd};
+            auto result = std::make_shared<abi::vector<std::byte>>(static_cast<std::size_t>(entry.size));
+
+            if (decompresser.decompress_into(stored, *result) != result->size()) {
+                throw source_code_aware_runtime_error{
+                    U8("Path"), entry.path, U8("Message"), U8("The entry in the resource archive is corrupted.")};
+            }
+
+            content_ptr content = std::move(result);
+
+            if (content->size() <= cache_capacity_) {
+                std::scoped_lock lock{mutex_};
+
+                if (!cache_.contains(index)) {
+                    lru_.emplace_front(index);
+                    cache_.emplace(index, std::pair{content, lru_.begin()});
+                    cached_bytes_ += content->size();
+                }
+
+                while (cached_bytes_ > cache_capacity_) {
+                    const auto iter = cache_.find(lru_.back());
+
+                    cached_bytes_ -= iter->second.first->size();
+                    cache_.erase(iter);
+                    lru_.pop_back();
+                }
+            }
+
+            return entry_content{*content, content};
+        }
+
+    private:
+        [[noreturn]] static void throw_invalid(std::string_view path, const char* message) {
+            throw source_code_aware_runtime_error{U8("Archive"), path, U8("Message"), message};
+        }
+
+        static bool is_valid_frame_size(const archive_entry& entry, std::span<const std::byte> buffer) {
+            const auto stored       = buffer.subspan(entry.offset, entry.stored_size);
+            const auto content_size = ZSTD_getFrameContentSize(stored.data(), stored.size());
+
+            if (content_size == ZSTD_CONTENTSIZE_ERROR || entry.size > std::numeric_limits<std::size_t>::max()) {
+                return false;
+            }
+
+            return content_size == ZSTD_CONTENTSIZE_UNKNOWN ? entry.size <= max_unsized_entry_size
+                                                            : entry.size <= content_size;
+        }
+
+        void parse(std::string_view path) {
+            const auto buffer = archive_.span();
+
+            if (buffer.size() < header_size || !std::ranges::equal(buffer.first(archive_magic.size()), archive_magic)) {
+                throw_invalid(path, U8("The file is not a resource archive."));
+            }
+
+            if (load_le<std::uint32_t>(&buffer[4]) != archive_version) {
+                throw_invalid(path, U8("The version of the resource archive is not supported."));
+            }
+
+            const auto count               = load_le<std::uint32_t>(&buffer[8]);
+            const auto data_offset         = load_le<std::uint64_t>(&buffer[16]);
+            const auto string_table_offset = header_size + record_size * static_cast<std::uint64_t>(count);
+
+            if (string_table_offset > data_offset || data_offset > buffer.size()) {
+                throw_invalid(path, U8("The index of the resource archive is truncated."));
+            }
+
+            const auto string_table = buffer.subspan(string_table_offset, data_offset - string_table_offset);
+
+            entries_.reserve(count);
+
+            // Validates every record up front, so that lookups and reads need no further checks.
+            for (std::size_t i = 0; i < count; i++) {
+                const auto record      = &buffer[header_size + record_size * i];
+                const auto path_offset = load_le<std::uint32_t>(record);
+                const auto path_size   = load_le<std::uint32_t>(record + 4);
+                const auto method      = load_le<std::uint32_t>(record + 8);
+
+                archive_entry entry{.path = {},
+                    .method               = static_cast<entry_method>(method),
+                    .offset               = load_le<std::uint64_t>(record + 16),
+                    .stored_size          = load_le<std::uint64_t>(record + 24),
+                    .size                 = load_le<std::uint64_t>(record + 32)};
+
+                if (static_cast<std::uint64_t>(path_offset) + path_size > string_table.size()
+                    || method > static_cast<std::uint32_t>(entry_method::zstd) || entry.offset < data_offset
+                    || entry.offset > buffer.size() || entry.stored_size > buffer.size() - entry.offset
+                    || (entry.method == entry_method::stored && entry.stored_size != entry.size)) {
+                    throw_invalid(path, U8("The index of the resource archive is corrupted."));
+                }
+
+                // The original size is allocated before decompressing, so it must agree with the frame.
+                if (entry.method == entry_method::zstd && !is_valid_frame_size(entry, buffer)) {
+                    throw_invalid(path, U8("The size of the compressed entry in the resource archive is corrupted."));
+                }
+
+                entry.path = std::string_view{
+                    reinterpret_cast<const char*>(string_table.data()) + path_offset, path_size};
+
+                if (!entries_.empty() && entries_.back().path >= entry.path) {
+                    throw_invalid(path, U8("The index of the resource archive is not sorted."));
+                }
+
+                entries_.emplace_back(entry);
+            }
+        }
+
+        mapped_buffer archive_;
+        std::filesystem::file_time_type time_;
+        std::vector<archive_entry> entries_;
+        std::size_t cache_capacity_;
+        std::mutex mutex_;
+        std::list<std::size_t> lru_;
+        std::unordered_map<std::size_t, std::pair<content_ptr, std::list<std::size_t>::iterator>> cache_;
+        std::size_t cached_bytes_{};
+    };
+
+    resource_archive_writer::resource_archive_writer(const resource_archive_writer_options& options)
+        : impl_{std::make_unique<impl>(options)} {}
+
+    resource_archive_writer::resource_archive_writer(resource_archive_writer&&) noexcept = default;
+
+    resource_archive_writer::~resource_archive_writer() = default;
+
+    resource_archive_writer& resource_archive_writer::operator=(resource_archive_writer&&) noexcept = default;
+
+    std::size_t resource_archive_writer::entry_count() const noexcept {
+        return impl_->entry_count();
+    }
+
+    void resource_archive_writer::add(std::string_view path, std::span<const std::byte> content) const {
+        impl_->add(path, content);
+    }
+
+    void resource_archive_writer::add_file(std::string_view path, std::string_view source_path) const {
+        impl_->add_file(path, source_path);
+    }
+
+    void resource_archive_writer::add_directory(std::string_view directory, std::string_view prefix) const {
+        impl_->add_directory(directory, prefix);
+    }
+
+    void resource_archive_writer::save(std::string_view path) const {
+        impl_->save(path);
+    }
+
+    resource_archive_fs_operator::resource_archive_fs_operator(
+        std::string_view path, const resource_archive_options& options)
+        : impl_{std::make_shared<impl>(path, options)} {}
+
+    std::size_t resource_archive_fs_operator::entry_count() const noexcept {
+        return impl_->entry_count();
+    }
+
+    bool resource_archive_fs_operator::exists(std::string_view path) const {
+        return is_file(path) || is_directory(path);
+    }
+
+    bool resource_archive_fs_operator::is_file(std::string_view path) const {
+        return impl_->find(path) != nullptr;
+    }
+
+    bool resource_archive_fs_operator::is_directory(std::string_view path) const {
+        return impl_->is_directory(path);
+    }
+
+    std::unique_ptr<std::iostream> resource_archive_fs_operator::open(
+        [[maybe_unused]] std::string_view path, [[maybe_unused]] std::ios_base::openmode mode) {
+        throw source_code_aware_runtime_error{
+            U8("The resource archive is read-only and cannot be opened as std::iostream.")};
+    }
+
+    std::unique_ptr<std::istream> resource_archive_fs_operator::open_read(
+        std::string_view path, std::ios_base::openmode mode) const {
+        auto [data, owner] = impl_->content(impl_->get(path));
+        auto stream        = std::make_unique<archive_istream>(data, impl_->archive(), std::move(owner), mode);
+
+        stream->exceptions(std::ios_base::badbit);
+
+        return stream;
+    }
+
+    std::unique_ptr<std::ostream> resource_archive_fs_operator::open_write(
+        [[maybe_unused]] std::string_view path, [[maybe_unused]] std::ios_base::openmode mode) {
+        throw source_code_aware_runtime_error{
+            U8("The resource archive is read-only and cannot be opened as std::ostream.")};
+    }
+
+    abi::vector<std::byte> resource_archive_fs_operator::read_all(std::string_view path) const {
+        const auto [data, owner] = impl_->content(impl_->get(path));
+
+        return abi::vector<std::byte>{data.begin(), data.end()};
+    }
+
+    std::size_t resource_archive_fs_operator::read_range(
+        std::string_view path, std::uint64_t offset, std::span<std::byte> result) const {
+        const auto [data, owner] = impl_->content(impl_->get(path));
+
+        if (offset >= data.size()) {
+            return 0;
+        }
+
+        const auto size = std::min(result.size(), static_cast<std::size_t>(data.size() - offset));
+
+        std::memcpy(result.data(), data.data() + offset, size);
+
+        return size;
+    }
+
+    void resource_archive_fs_operator::write_all(
+        [[maybe_unused]] std::string_view path, [[maybe_unused]] std::span<const std::byte> buffer) {
+        throw source_code_aware_runtime_error{U8("The resource archive is read-only and cannot be written.")};
+    }
+
+    std::uint64_t resource_archive_fs_operator::file_size(std::string_view path) const {
+        return impl_->get(path).size;
+    }
+
+    std::filesystem::file_time_type resource_archive_fs_operator::last_write_time(std::string_view path) const {
+        static_cast<void>(impl_->get(path));
+
+        return impl_->time();
+    }
+
+    abi::vector<directory_entry> resource_archive_fs_operator::list_directory(std::string_view path) const {
+        return impl_->list_directory(path);
+    }
+
+    abstract::virtual_fs_operator make_resource_archive_fs_operator(
+        std::string_view path, const resource_archive_options& options) {
+        return abstract::virtual_fs_operator{resource_archive_fs_operator{path, options}};
+    }
+} // namespace essence::io
@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "io/seekable_compression.hpp"
+
+#include "char8_t_remediation.hpp"
+#include "error_extensions.hpp"
+#include "io/compresser.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <ios>
+#include <istream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+#include "thread.hpp"
+#endif
+
+namespace essence::io {
+    namespace {
+        // See the seekable format in the contrib directory of zstd.
+        constexpr std::uint32_t skippable_magic_number = 0x184D2A5E;
+        constexpr std::uint32_t seekable_magic_number  = 0x8F92EAB1;
+        constexpr std::uint8_t checksum_flag           = 0x80;
+        constexpr std::uint8_t reserved_bits           = 0x7C;
+        constexpr std::size_t skippable_header_size    = 8;
+        constexpr std::size_t footer_size              = 9;
+        constexpr std::size_t max_block_size           = 1024 * 1024 * 1024;
+
+        void write_uint32(abi::vector<std::byte>& buffer, std::uint32_t value) {
+            for (std::size_t i = 0; i < sizeof(value); i++) {
+                buffer.emplace_back(static_cast<std::byte>((value >> (i * 8)) & 0xFF));
+            }
+        }
+
+        std::uint32_t read_uint32(std::span<const std::byte> buffer, std::size_t offset) {
+            std::uint32_t result{};
+
+            for (std::size_t i = 0; i < sizeof(result); i++) {
+                result |= std::to_integer<std::uint32_t>(buffer[offset + i]) << (i * 8);
+            }
+
+            return result;
+        }
+
+        [[noreturn]] void throw_invalid_format(const char* message) {
+            throw source_code_aware_runtime_error{
+                U8("Message"), U8("Invalid seekable zstd data."), U8("Internal"), message};
+        }
+
+        std::uint32_t get_thread_count(std::uint32_t worker_count, std::size_t task_count) {
+            return static_cast<std::uint32_t>(
+                std::max<std::size_t>(std::min<std::size_t>(worker_count, task_count), 1));
+        }
+
+        struct frame_entry {
+            std::uint64_t compressed_offset;
+            std::uint64_t decompressed_offset;
+            std::uint32_t compressed_size;
+            std::uint32_t decompressed_size;
+        };
+
+        class seekable_source {
+        public:
+            virtual ~seekable_source() = default;
+
+            [[nodiscard]] virtual std::uint64_t size() const = 0;
+
+            /**
+             * @brief Reads a range of the compressed data.
+             * @param offset The offset.
+             * @param size The size.
+             * @param storage The storage to hold the data if the source is not in memory.
+             * @return The data.
+             */
+            virtual std::span<const std::byte> read(
+                std::uint64_t offset, std::size_t size, abi::vector<std::byte>& storage) = 0;
+        };
+
+        class span_source final : public seekable_source {
+        public:
+            explicit span_source(std::span<const std::byte> buffer) : buffer_{buffer} {}
+
+            [[nodiscard]] std::uint64_t size() const override {
+                return buffer_.size();
+            }
+
+            std::span<const std::byte> read(
+                std::uint64_t offset, std::size_t size, [[maybe_unused]] abi::vector<std::byte>& storage) override {
+                return buffer_.subspan(static_cast<std::size_t>(offset), size);
+            }
+
+        private:
+            std::span<const std::byte> buffer_;
+        };
+
+        class stream_source final : public seekable_source {
+        public:
+            explicit stream_source(std::unique_ptr<std::istream> stream) : stream_{std::move(stream)} {
+                stream_->seekg(0, std::ios::end);
+                size_ = static_cast<std::uint64_t>(stream_->tellg());
+
+                if (!*stream_) {
+                    throw source_code_aware_runtime_error{U8("Failed to get the size of the stream.")};
+                }
+            }
+
+            [[nodiscard]] std::uint64_t size() const override {
+                return size_;
+            }
+
+            std::span<const std::byte> read(
+                std::uint64_t offset, std::size_t size, abi::vector<std::byte>& storage) override {
+                storage.resize(size);
+                stream_->seekg(static_cast<std::streamoff>(offset));
+                stream_->read(reinterpret_cast<char*>(storage.data()), static_cast<std::streamsize>(size));
+
+                if (static_cast<std::size_t>(stream_->gcount()) != size) {
+                    throw source_code_aware_runtime_error{U8("Offset"), offset, U8("Size"), size, U8("Message"),
+                        U8("Failed to read the stream.")};
+                }
+
+                return storage;
+            }
+
+        private:
+            std::unique_ptr<std::istream> stream_;
+            std::uint64_t size_{};
+        };
+    } // namespace
+
+    abi::vector<std::byte> compress_seekable(
+        std::span<const std::byte> buffer, std::int32_t level, const seekable_compression_options& options) {
+        if (options.block_size == 0 || options.block_size > max_block_size) {
+            throw source_code_aware_runtime_error{U8("Block Size"), options.block_size, U8("Message"),
+                U8("The block size must be between 1 byte and 1 GiB.")};
+        }
+
+        const auto frame_count  = (buffer.size() + options.block_size - 1) / options.block_size;
+        const auto thread_count = get_thread_count(options.worker_count, frame_count);
+        std::vector<abi::vector<std::byte>> frames(frame_count);
+        std::vector<compresser> compressers;
+
+        compressers.reserve(thread_count);
+
+        for (std::uint32_t i = 0; i < thread_count; i++) {
+            compressers.emplace_back(compression_mode::zstd);
+        }
+
+        // Every block is compressed into an independent frame, so that each one can be decompressed alone.
+        const auto compress_frame = [&](std::size_t index, std::size_t thread_index) {
+            const auto offset = index * options.block_size;
+
+            frames[index] = compressers[thread_index].as_bytes(
+                buffer.subspan(offset, std::min(options.block_size, buffer.size() - offset)), level);
+        };
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+        parallel_for(0, frame_count, thread_count,
+            [&](std::size_t index, std::size_t thread_index, bool&) { compress_frame(index, thread_index); });
+#else
+        for (std::size_t i = 0; i < frame_count; i++) {
+            compress_frame(i, 0);
+        }
+#endif
+
+        std::size_t total_size{};
+
+        for (auto&& item : frames) {
+            total_size += item.size();
+        }
+
+        const auto table_size = frame_count * 8 + footer_size;
+        abi::vector<std::byte> result;
+
+        result.reserve(total_size + skippable_header_size + table_size);
+
+        for (auto&& item : frames) {
+            result.insert(result.end(), item.begin(), item.end());
+        }
+
+        write_uint32(result, skippable_magic_number);
+        write_uint32(result, static_cast<std::uint32_t>(table_size));
+
+        for (std::size_t i = 0; i < frame_count; i++) {
+            write_uint32(result, static_cast<std::uint32_t>(frames[i].size()));
+            write_uint32(result,
+                static_cast<std::uint32_t>(std::min(options.block_size, buffer.size() - i * options.block_size)));
+        }
+
+        write_uint32(result, static_cast<std::uint32_t>(frame_count));
+        result.emplace_back(std::byte{});
+        write_uint32(result, seekable_magic_number);
+
+        return result;
+    }
+
+    class seekable_decompresser::impl {
+    public:
+        explicit impl(std::unique_ptr<seekable_source> source) : source_{std::move(source)} {
+            parse_seek_table();
+        }
+
+        [[nodiscard]] std::uint64_t size() const noexcept {
+            return frames_.empty() ? 0 : frames_.back().decompressed_offset + frames_.back().decompressed_size;
+        }
+
+        [[nodiscard]] std::size_t frame_count() const noexcept {
+            return frames_.size();
+        }
+
+        std::size_t read_range_into(std::uint64_t offset, std::span<std::byte> result, std::uint32_t worker_count) {
+            std::scoped_lock lock{mutex_};
+
+            if (offset > size()) {
+                throw source_code_aware_runtime_error{U8("Offset"), offset, U8("Size"), size(), U8("Message"),
+                    U8("The offset is out of range.")};
+            }
+
+            const auto length = static_cast<std::size_t>(std::min<std::uint64_t>(result.size(), size() - offset));
+
+            if (length == 0) {
+                return 0;
+            }
+
+            const auto first = find_frame(offset);
+            const auto last  = find_frame(offset + length - 1);
+
+            // The overlapping frames are adjacent, so they are fetched by a single read.
+            const auto begin      = frames_[first].compressed_offset;
+            const auto end        = frames_[last].compressed_offset + frames_[last].compressed_size;
+            const auto compressed = source_->read(begin, static_cast<std::size_t>(end - begin), storage_);
+            const auto thread_count = get_thread_count(worker_count, last - first + 1);
+
+            while (decompressers_.size() < thread_count) {
+                decompressers_.emplace_back(compression_mode::zstd);
+                scratches_.emplace_back();
+            }
+
+            const auto decompress_frame = [&](std::size_t index, std::size_t thread_index) {
+                const auto& frame = frames_[index];
+                const auto input  = compressed.subspan(
+                    static_cast<std::size_t>(frame.compressed_offset - begin), frame.compressed_size);
+                const auto frame_begin = std::max(frame.decompressed_offset, offset);
+                const auto frame_end =
+                    std::min(frame.decompressed_offset + frame.decompressed_size, offset + length);
+                const auto output = result.subspan(
+                    static_cast<std::size_t>(frame_begin - offset), static_cast<std::size_t>(frame_end - frame_begin));
+
+                // Frames wholly inside the range are decompressed in place; the partial ones at both ends go
+                // through the scratch buffer.
+                if (output.size() == frame.decompressed_size) {
+                    check_frame_size(decompressers_[thread_index].decompress_into(input, output), frame);
+                } else {
+                    auto& scratch = scratches_[thread_index];
+
+                    scratch.resize(frame.decompressed_size);
+                    check_frame_size(decompressers_[thread_index].decompress_into(input, scratch), frame);
+                    std::memcpy(output.data(),
+                        scratch.data() + static_cast<std::size_t>(frame_begin - frame.decompressed_offset),
+                        output.size());
+                }
+            };
+
+#ifdef CPP_ESSENCE_HAS_THREADS
+            parallel_for(first, last + 1, thread_count,
+                [&](std::size_t index, std::size_t thread_index, bool&) { decompress_frame(index, thread_index); });
+#else
+            for (auto i = first; i <= last; i++) {
+                decompress_frame(i, 0);
+            }
+#endif
+
+            return length;
+        }
+
+    private:
+        static void check_frame_size(std::size_t size, const frame_entry& frame) {
+            if (size != frame.decompressed_size) {
+                throw_invalid_format(U8("The decompressed size of the frame mismatches the seek table."));
+            }
+        }
+
+        [[nodiscard]] std::size_t find_frame(std::uint64_t offset) const {
+            const auto iter = std::ranges::upper_bound(frames_, offset, {}, &frame_entry::decompressed_offset);
+
+            return static_cast<std::size_t>(iter - frames_.begin()) - 1;
+        }
+
+        void parse_seek_table() {
+            const auto total_size = source_->size();
+
+            if (total_size < skippable_header_size + footer_size) {
+                throw_invalid_format(U8("The data is too short."));
+            }
+
+            const auto footer     = source_->read(total_size - footer_size, footer_size, storage_);
+            const auto descriptor = std::to_integer<std::uint8_t>(footer[4]);
+
+            if (read_uint32(footer, 5) != seekable_magic_number) {
+                throw_invalid_format(U8("The seekable magic number is missing."));
+            }
+
+            if ((descriptor & reserved_bits) != 0) {
+                throw_invalid_format(U8("The reserved bits of the seek table descriptor are set."));
+            }
+
+            // The optional checksums are skipped because zstd verifies the frames on its own.
+            const std::uint64_t count      = read_uint32(footer, 0);
+            const std::uint64_t entry_size = (descriptor & checksum_flag) != 0 ? 12 : 8;
+            const auto table_size          = count * entry_size + footer_size;
+
+            if (table_size + skippable_header_size > total_size) {
+                throw_invalid_format(U8("The seek table exceeds the data."));
+            }
+
+            const auto table = source_->read(total_size - table_size - skippable_header_size,
+                static_cast<std::size_t>(table_size + skippable_header_size), storage_);
+
+            if (read_uint32(table, 0) != skippable_magic_number || read_uint32(table, 4) != table_size) {
+                throw_invalid_format(U8("The seek table is not a valid skippable frame."));
+            }
+
+            std::uint64_t compressed_offset{};
+            std::uint64_t decompressed_offset{};
+
+            frames_.reserve(static_cast<std::size_t>(count));
+
+            for (std::size_t i = 0; i < count; i++) {
+                const auto position = skippable_header_size + i * entry_size;
+                const auto& frame   = frames_.emplace_back(compressed_offset, decompressed_offset,
+                    read_uint32(table, position), read_uint32(table, position + 4));
+
+                compressed_offset += frame.compressed_size;
+                decompressed_offset += frame.decompressed_size;
+            }
+
+            if (compressed_offset != total_size - table_size - skippable_header_size) {
+                throw_invalid_format(U8("The frame sizes mismatch the data."));
+            }
+
+            // Empty frames would break the binary search of offsets.
+            std::erase_if(frames_, [](const frame_entry& item) { return item.decompressed_size == 0; });
+        }
+
+        std::unique_ptr<seekable_source> source_;
+        std::vector<frame_entry> frames_;
+        std::vector<compresser> decompressers_;
+        std::vector<abi::vector<std::byte>> scratches_;
+        abi::vector<std::byte> storage_;
+        std::mutex mutex_;
+    };
+
+    seekable_decompresser::seekable_decompresser(std::span<const std::byte> buffer)
+        : impl_{std::make_unique<impl>(std::make_unique<span_source>(buffer))} {}
+
+    seekable_decompresser::seekable_decompresser(
+        const abstract::virtual_fs_operator& fs_operator, std::string_view path)
+        : impl_{std::make_unique<impl>([&] {
+              try {
+                  return std::make_unique<stream_source>(fs_operator.open_read(path, std::ios::in | std::ios::binary));
+              } catch (const std::exception& ex) {
+                  throw source_code_aware_runtime_error{U8("File"), path, U8("Message"),
+                      U8("Failed to open the seekable file."), U8("Internal"), ex.what()};
+              }
+          }())} {}
+
+    seekable_decompresser::seekable_decompresser(seekable_decompresser&&) noexcept = default;
+
+    seekable_decompresser::~seekable_decompresser() = default;
+
+    seekable_decompresser& seekable_decompresser::operator=(seekable_decompresser&&) noexcept = default;
+
+    std::uint64_t seekable_decompresser::size() const noexcept {
+        return impl_->size();
+    }
+
+    std::size_t seekable_decompresser::frame_count() const noexcept {
+        return impl_->frame_count();
+    }
+
+    abi::vector<std::byte> seekable_decompresser::read_range(
+        std::uint64_t offset, std::size_t length, std::uint32_t worker_count) const {
+        abi::vector<std::byte> result(
+            static_cast<std::size_t>(std::min<std::uint64_t>(length, impl_->size() - std::min(offset, impl_->size()))));
+
+        result.resize(impl_->read_range_into(offset, result, worker_count));
+
+        return result;
+    }
+
+    std::size_t seekable_decompresser::read_range_into(
+        std::uint64_t offset, std::span<std::byte> result, std::uint32_t worker_count) const {
+        return impl_->read_range_into(offset, result, worker_count);
+    }
+} // namespace essence::io
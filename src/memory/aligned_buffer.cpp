@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "memory/aligned_buffer.hpp"
+
+#include "abi/memory.hpp"
+
+#include <algorithm>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace essence::memory {
+    namespace {
+        std::size_t get_storage_alignment(std::size_t size, std::size_t alignment) noexcept {
+            // Aligning large storage to huge pages lets the kernel map it by them without splitting at the ends.
+            return size >= huge_page_threshold ? std::max(alignment, huge_page_threshold) : alignment;
+        }
+    } // namespace
+
+    void* allocate_buffer_storage(std::size_t size, std::size_t alignment) {
+        const auto ptr = es_aligned_alloc(size, get_storage_alignment(size, alignment));
+
+        if (!ptr) {
+            throw std::bad_alloc{};
+        }
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        // Only a hint, which fails harmlessly when transparent huge pages are disabled.
+        if (size >= huge_page_threshold) {
+            static_cast<void>(madvise(ptr, size / huge_page_threshold * huge_page_threshold, MADV_HUGEPAGE));
+        }
+#endif
+
+        return ptr;
+    }
+
+    void deallocate_buffer_storage(void* ptr, std::size_t size, std::size_t alignment) noexcept {
+        es_aligned_dealloc(ptr, size, get_storage_alignment(size, alignment));
+    }
+} // namespace essence::memory
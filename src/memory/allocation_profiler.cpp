@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "memory/allocation_profiler.hpp"
+
+#include "abi/json.hpp"
+#include "allocation_recorder.hpp"
+#include "char8_t_remediation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace essence::memory {
+#ifdef CPP_ESSENCE_HAS_ALLOCATION_PROFILING
+    namespace {
+        constexpr std::size_t max_tag_size = 47;
+
+        /**
+         * @brief A counter written only by its owner thread, which other threads may read at any time.
+         */
+        struct counter {
+            std::atomic<std::uint64_t> value;
+
+            void add(std::uint64_t delta) noexcept {
+                value.store(value.load(std::memory_order::relaxed) + delta, std::memory_order::relaxed);
+            }
+
+            [[nodiscard]] std::uint64_t get() const noexcept {
+                return value.load(std::memory_order::relaxed);
+            }
+        };
+
+        struct tag_counters {
+            counter allocations;
+            counter allocated_bytes;
+            counter deallocations;
+            counter deallocated_bytes;
+            std::array<counter, allocation_histogram_size> histogram;
+
+            void add_to(allocation_tag_stats& stats) const noexcept {
+                stats.allocations += allocations.get();
+                stats.allocated_bytes += allocated_bytes.get();
+                stats.deallocations += deallocations.get();
+                stats.deallocated_bytes += deallocated_bytes.get();
+
+                for (std::size_t i = 0; i < histogram.size(); i++) {
+                    stats.histogram[i] += histogram[i].get();
+                }
+            }
+
+            void add_to(tag_counters& counters) const noexcept {
+                counters.allocations.add(allocations.get());
+                counters.allocated_bytes.add(allocated_bytes.get());
+                counters.deallocations.add(deallocations.get());
+                counters.deallocated_bytes.add(deallocated_bytes.get());
+
+                for (std::size_t i = 0; i < histogram.size(); i++) {
+                    counters.histogram[i].add(histogram[i].get());
+                }
+            }
+        };
+
+        using thread_record = std::array<tag_counters, max_allocation_tags>;
+
+        /**
+         * @brief The records of the live threads, the accumulated record of the exited threads, and the tags.
+         * @remark Nothing here is allocated by the ABI allocator, which would otherwise recurse into the recorder.
+         */
+        struct registry {
+            std::mutex mutex;
+            std::vector<thread_record*> live_records;
+            thread_record retired_record{};
+            std::array<std::array<char, max_tag_size>, max_allocation_tags> tags{};
+            std::array<std::size_t, max_allocation_tags> tag_sizes{};
+            std::atomic<std::uint32_t> tag_count{1};
+        };
+
+        /**
+         * @brief Gets the registry, which is never destroyed so that threads exiting after the static destructors
+         *        can still retire their records.
+         * @return The registry.
+         */
+        registry& get_registry() {
+            static const auto instance = new registry{};
+
+            return *instance;
+        }
+
+        constinit std::atomic<bool> profiling_enabled{};
+
+        enum class record_state : std::uint8_t { unregistered, active, retired };
+
+        constinit thread_local thread_record* current_record{};
+        constinit thread_local record_state current_state{};
+        constinit thread_local std::uint32_t current_tag{};
+
+        /**
+         * @brief Folds the record of the current thread into the accumulated record when the thread exits.
+         */
+        struct record_guard {
+            record_guard() noexcept = default;
+
+            record_guard(const record_guard&) = delete;
+
+            ~record_guard() {
+                auto&& instance = get_registry();
+
+                {
+                    std::scoped_lock lock{instance.mutex};
+
+                    for (std::size_t i = 0; i < current_record->size(); i++) {
+                        (*current_record)[i].add_to(instance.retired_record[i]);
+                    }
+
+                    std::erase(instance.live_records, current_record);
+                }
+
+                delete current_record;
+                current_record = nullptr;
+                current_state  = record_state::retired;
+            }
+
+            record_guard& operator=(const record_guard&) = delete;
+
+            void touch() noexcept {}
+        };
+
+        thread_local record_guard guard;
+
+        std::size_t get_histogram_index(std::size_t size) noexcept {
+            return size <= 16 ? 0 : std::min<std::size_t>(std::bit_width(size - 1) - 4, allocation_histogram_size - 1);
+        }
+
+        /**
+         * @brief Gets the counters of the current tag on the current thread.
+         * @param handler Updates the counters.
+         */
+        template <typename Handler>
+        void update_counters(Handler&& handler) noexcept {
+            if (current_state == record_state::unregistered) {
+                auto&& instance = get_registry();
+                const auto record = new (std::nothrow) thread_record{};
+
+                if (!record) {
+                    return;
+                }
+
+                try {
+                    std::scoped_lock lock{instance.mutex};
+
+                    instance.live_records.emplace_back(record);
+                } catch (...) {
+                    delete record;
+
+                    return;
+                }
+
+                current_record = record;
+                current_state  = record_state::active;
+
+                // Constructs the guard of this thread, whose destructor runs at the thread exit.
+                guard.touch();
+            }
+
+            if (current_state == record_state::active) {
+                handler((*current_record)[current_tag]);
+            } else {
+                // The thread is exiting, so its counters go directly to the accumulated record.
+                auto&& instance = get_registry();
+                std::scoped_lock lock{instance.mutex};
+
+                handler(instance.retired_record[current_tag]);
+            }
+        }
+
+        std::uint32_t find_tag(const registry& instance, std::uint32_t count, std::string_view tag) noexcept {
+            for (std::uint32_t i = 0; i < count; i++) {
+                if (std::string_view{instance.tags[i].data(), instance.tag_sizes[i]} == tag) {
+                    return i;
+                }
+            }
+
+            return count;
+        }
+
+        std::uint32_t intern_tag(std::string_view tag) noexcept {
+            auto&& instance = get_registry();
+
+            tag = tag.substr(0, max_tag_size);
+
+            // Tags are never removed, so the published ones can be compared without the lock.
+            const auto count = instance.tag_count.load(std::memory_order::acquire);
+
+            if (const auto index = find_tag(instance, count, tag); index != count) {
+                return index;
+            }
+
+            std::scoped_lock lock{instance.mutex};
+            const auto locked_count = instance.tag_count.load(std::memory_order::relaxed);
+
+            if (const auto index = find_tag(instance, locked_count, tag); index != locked_count) {
+                return index;
+            }
+
+            // The default tag takes the allocations once the tags are exhausted.
+            if (locked_count == max_allocation_tags) {
+                return 0;
+            }
+
+            std::ranges::copy(tag, instance.tags[locked_count].begin());
+            instance.tag_sizes[locked_count] = tag.size();
+            instance.tag_count.store(locked_count + 1, std::memory_order::release);
+
+            return locked_count;
+        }
+    } // namespace
+
+    void record_allocation(std::size_t size) noexcept {
+        if (profiling_enabled.load(std::memory_order::relaxed)) {
+            update_counters([&](tag_counters& counters) {
+                counters.allocations.add(1);
+                counters.allocated_bytes.add(size);
+                counters.histogram[get_histogram_index(size)].add(1);
+            });
+        }
+    }
+
+    void record_deallocation(std::size_t size) noexcept {
+        if (profiling_enabled.load(std::memory_order::relaxed)) {
+            update_counters([&](tag_counters& counters) {
+                counters.deallocations.add(1);
+                counters.deallocated_bytes.add(size);
+            });
+        }
+    }
+
+    void set_allocation_profiling(bool enabled) noexcept {
+        profiling_enabled.store(enabled, std::memory_order::relaxed);
+    }
+
+    bool is_allocation_profiling_enabled() noexcept {
+        return profiling_enabled.load(std::memory_order::relaxed);
+    }
+
+    allocation_snapshot take_allocation_snapshot() {
+        auto&& instance = get_registry();
+        std::array<allocation_tag_stats, max_allocation_tags> stats{};
+        std::uint32_t count{};
+
+        {
+            std::scoped_lock lock{instance.mutex};
+
+            count = instance.tag_count.load(std::memory_order::relaxed);
+
+            for (std::uint32_t i = 0; i < count; i++) {
+                instance.retired_record[i].add_to(stats[i]);
+
+                for (auto&& item : instance.live_records) {
+                    (*item)[i].add_to(stats[i]);
+                }
+            }
+        }
+
+        // The strings are allocated out of the lock, since the allocations may register the current thread.
+        allocation_snapshot result{.supported = true, .tags = {}};
+
+        result.tags.reserve(count);
+
+        for (std::uint32_t i = 0; i < count; i++) {
+            stats[i].tag = i == 0 ? U8("default") : std::string_view{instance.tags[i].data(), instance.tag_sizes[i]};
+            result.tags.emplace_back(std::move(stats[i]));
+        }
+
+        return result;
+    }
+
+    std::uint32_t enter_allocation_scope(std::string_view tag) noexcept {
+        return std::exchange(current_tag, intern_tag(tag));
+    }
+
+    void leave_allocation_scope(std::uint32_t previous) noexcept {
+        current_tag = previous;
+    }
+#else
+    void set_allocation_profiling([[maybe_unused]] bool enabled) noexcept {}
+
+    bool is_allocation_profiling_enabled() noexcept {
+        return false;
+    }
+
+    allocation_snapshot take_allocation_snapshot() {
+        return allocation_snapshot{};
+    }
+
+    std::uint32_t enter_allocation_scope([[maybe_unused]] std::string_view tag) noexcept {
+        return 0;
+    }
+
+    void leave_allocation_scope([[maybe_unused]] std::uint32_t previous) noexcept {}
+#endif
+
+    abi::string allocation_snapshot::to_json() const {
+        abi::json result{
+            {U8("supported"), supported},
+            {U8("tags"), abi::json::array()},
+        };
+
+        abi::json bounds = abi::json::array();
+
+        for (std::size_t i = 0; i + 1 < allocation_histogram_size; i++) {
+            bounds.emplace_back(std::uint64_t{16} << i);
+        }
+
+        // The last bucket is unbounded.
+        bounds.emplace_back(nullptr);
+        result[U8("histogram_upper_bounds")] = std::move(bounds);
+
+        for (auto&& item : tags) {
+            result[U8("tags")].emplace_back(abi::json{
+                {U8("tag"), item.tag},
+                {U8("allocations"), item.allocations},
+                {U8("allocated_bytes"), item.allocated_bytes},
+                {U8("deallocations"), item.deallocations},
+                {U8("deallocated_bytes"), item.deallocated_bytes},
+                {U8("histogram"), item.histogram},
+            });
+        }
+
+        return result.dump();
+    }
+} // namespace essence::memory
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "memory/interleave.hpp"
+
+#include "char8_t_remediation.hpp"
+#include "error_extensions.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+
+#define ES_INTERLEAVE_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+
+#define ES_INTERLEAVE_NEON 1
+#endif
+
+namespace essence::memory {
+    namespace {
+        using plane_pointers = std::array<std::byte*, max_interleaved_channels>;
+
+#ifdef ES_INTERLEAVE_SSE2
+        template <int Shift>
+        __m128i extract_byte_lane(__m128i value) noexcept {
+            return _mm_and_si128(_mm_srli_epi32(value, Shift), _mm_set1_epi32(0xFF));
+        }
+
+        template <int Shift>
+        void store_byte_lane(const __m128i (&pixels)[4], std::byte* target) noexcept {
+            // The lanes hold 0-255, so the saturating packs never clamp.
+            const auto low  = _mm_packs_epi32(extract_byte_lane<Shift>(pixels[0]), extract_byte_lane<Shift>(pixels[1]));
+            const auto high = _mm_packs_epi32(extract_byte_lane<Shift>(pixels[2]), extract_byte_lane<Shift>(pixels[3]));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target), _mm_packus_epi16(low, high));
+        }
+
+        /**
+         * @brief Deinterleaves the leading elements in blocks of 16.
+         * @return The number of the elements processed.
+         */
+        std::size_t deinterleave_bytes_simd(
+            const std::byte* source, const plane_pointers& planes, std::size_t channels, std::size_t count) noexcept {
+            std::size_t i{};
+
+            if (channels == 2) {
+                const auto mask = _mm_set1_epi16(0xFF);
+
+                for (; i + 16 <= count; i += 16) {
+                    const auto first  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2));
+                    const auto second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2 + 16));
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[0] + i),
+                        _mm_packus_epi16(_mm_and_si128(first, mask), _mm_and_si128(second, mask)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[1] + i),
+                        _mm_packus_epi16(_mm_srli_epi16(first, 8), _mm_srli_epi16(second, 8)));
+                }
+            } else if (channels == 4) {
+                for (; i + 16 <= count; i += 16) {
+                    const __m128i pixels[]{
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4)),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4 + 16)),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4 + 32)),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4 + 48)),
+                    };
+
+                    store_byte_lane<0>(pixels, planes[0] + i);
+                    store_byte_lane<8>(pixels, planes[1] + i);
+                    store_byte_lane<16>(pixels, planes[2] + i);
+                    store_byte_lane<24>(pixels, planes[3] + i);
+                }
+            }
+
+            return i;
+        }
+
+        /**
+         * @brief Interleaves the leading elements in blocks of 16.
+         * @return The number of the elements processed.
+         */
+        std::size_t interleave_bytes_simd(
+            const plane_pointers& planes, std::byte* target, std::size_t channels, std::size_t count) noexcept {
+            std::size_t i{};
+            const auto load = [&](std::size_t channel) {
+                return _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[channel] + i));
+            };
+            const auto store = [&](std::size_t offset, __m128i value) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i * channels + offset), value);
+            };
+
+            if (channels == 2) {
+                for (; i + 16 <= count; i += 16) {
+                    const auto first  = load(0);
+                    const auto second = load(1);
+
+                    store(0, _mm_unpacklo_epi8(first, second));
+                    store(16, _mm_unpackhi_epi8(first, second));
+                }
+            } else if (channels == 4) {
+                for (; i + 16 <= count; i += 16) {
+                    const auto pairs01_low  = _mm_unpacklo_epi8(load(0), load(1));
+                    const auto pairs01_high = _mm_unpackhi_epi8(load(0), load(1));
+                    const auto pairs23_low  = _mm_unpacklo_epi8(load(2), load(3));
+                    const auto pairs23_high = _mm_unpackhi_epi8(load(2), load(3));
+
+                    store(0, _mm_unpacklo_epi16(pairs01_low, pairs23_low));
+                    store(16, _mm_unpackhi_epi16(pairs01_low, pairs23_low));
+                    store(32, _mm_unpacklo_epi16(pairs01_high, pairs23_high));
+                    store(48, _mm_unpackhi_epi16(pairs01_high, pairs23_high));
+                }
+            }
+
+            return i;
+        }
+#elif defined(ES_INTERLEAVE_NEON)
+        std::size_t deinterleave_bytes_simd(
+            const std::byte* source, const plane_pointers& planes, std::size_t channels, std::size_t count) noexcept {
+            const auto input = reinterpret_cast<const std::uint8_t*>(source);
+            const auto plane = [&](std::size_t channel) { return reinterpret_cast<std::uint8_t*>(planes[channel]); };
+            std::size_t i{};
+
+            if (channels == 2) {
+                for (; i + 16 <= count; i += 16) {
+                    const auto lanes = vld2q_u8(input + i * 2);
+
+                    vst1q_u8(plane(0) + i, lanes.val[0]);
+                    vst1q_u8(plane(1) + i, lanes.val[1]);
+                }
+            } else if (channels == 3) {
+                for (; i + 16 <= count; i += 16) {
+                    const auto lanes = vld3q_u8(input + i * 3);
+
+                    vst1q_u8(plane(0) + i, lanes.val[0]);
+                    vst1q_u8(plane(1) + i, lanes.val[1]);
+                    vst1q_u8(plane(2) + i, lanes.val[2]);
+                }
+            } else if (channels == 4) {
+                for (; i + 16 <= count; i += 16) {
+                    const auto lanes = vld4q_u8(input + i * 4);
+
+                    vst1q_u8(plane(0) + i, lanes.val[0]);
+                    vst1q_u8(plane(1) + i, lanes.val[1]);
+                    vst1q_u8(plane(2) + i, lanes.val[2]);
+                    vst1q_u8(plane(3) + i, lanes.val[3]);
+                }
+            }
+
+            return i;
+        }
+
+        std::size_t interleave_bytes_simd(
+            const plane_pointers& planes, std::byte* target, std::size_t channels, std::size_t count) noexcept {
+            const auto output = reinterpret_cast<std::uint8_t*>(target);
+            const auto plane  = [&](std::size_t channel, std::size_t offset) {
+                return vld1q_u8(reinterpret_cast<const std::uint8_t*>(planes[channel]) + offset);
+            };
+            std::size_t i{};
+
+            if (channels == 2) {
+                for (; i + 16 <= count; i += 16) {
+                    vst2q_u8(output + i * 2, uint8x16x2_t{{plane(0, i), plane(1, i)}});
+                }
+            } else if (channels == 3) {
+                for (; i + 16 <= count; i += 16) {
+                    vst3q_u8(output + i * 3, uint8x16x3_t{{plane(0, i), plane(1, i), plane(2, i)}});
+                }
+            } else if (channels == 4) {
+                for (; i + 16 <= count; i += 16) {
+                    vst4q_u8(output + i * 4, uint8x16x4_t{{plane(0, i), plane(1, i), plane(2, i), plane(3, i)}});
+                }
+            }
+
+            return i;
+        }
+#else
+        std::size_t deinterleave_bytes_simd(
+            const std::byte*, const plane_pointers&, std::size_t, std::size_t) noexcept {
+            return 0;
+        }
+
+        std::size_t interleave_bytes_simd(const plane_pointers&, std::byte*, std::size_t, std::size_t) noexcept {
+            return 0;
+        }
+#endif
+
+        /**
+         * @brief Deinterleaves elements of a fixed size and a fixed number of channels, which the compiler unrolls
+         *        and vectorizes.
+         */
+        template <std::size_t Size, std::size_t Channels>
+        void deinterleave_fixed(
+            const std::byte* source, const plane_pointers& planes, std::size_t first, std::size_t count) noexcept {
+            for (auto i = first; i < count; i++) {
+                for (std::size_t channel = 0; channel < Channels; channel++) {
+                    std::memcpy(planes[channel] + i * Size, source + (i * Channels + channel) * Size, Size);
+                }
+            }
+        }
+
+        template <std::size_t Size, std::size_t Channels>
+        void interleave_fixed(
+            const plane_pointers& planes, std::byte* target, std::size_t first, std::size_t count) noexcept {
+            for (auto i = first; i < count; i++) {
+                for (std::size_t channel = 0; channel < Channels; channel++) {
+                    std::memcpy(target + (i * Channels + channel) * Size, planes[channel] + i * Size, Size);
+                }
+            }
+        }
+
+        template <std::size_t Size>
+        void deinterleave_sized(const std::byte* source, const plane_pointers& planes, std::size_t channels,
+            std::size_t first, std::size_t count) noexcept {
+            switch (channels) {
+            case 2:
+                return deinterleave_fixed<Size, 2>(source, planes, first, count);
+            case 3:
+                return deinterleave_fixed<Size, 3>(source, planes, first, count);
+            case 4:
+                return deinterleave_fixed<Size, 4>(source, planes, first, count);
+            default:
+                for (auto i = first; i < count; i++) {
+                    for (std::size_t channel = 0; channel < channels; channel++) {
+                        std::memcpy(planes[channel] + i * Size, source + (i * channels + channel) * Size, Size);
+                    }
+                }
+            }
+        }
+
+        template <std::size_t Size>
+        void interleave_sized(const plane_pointers& planes, std::byte* target, std::size_t channels,
+            std::size_t first, std::size_t count) noexcept {
+            switch (channels) {
+            case 2:
+                return interleave_fixed<Size, 2>(planes, target, first, count);
+            case 3:
+                return interleave_fixed<Size, 3>(planes, target, first, count);
+            case 4:
+                return interleave_fixed<Size, 4>(planes, target, first, count);
+            default:
+                for (auto i = first; i < count; i++) {
+                    for (std::size_t channel = 0; channel < channels; channel++) {
+                        std::memcpy(target + (i * channels + channel) * Size, planes[channel] + i * Size, Size);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Validates the shapes and gets the number of the elements in each plane.
+         */
+        std::size_t get_element_count(std::size_t interleaved_size, std::size_t plane_count, std::size_t plane_size,
+            std::size_t element_size) {
+            if (plane_count == 0 || plane_count > max_interleaved_channels) {
+                throw source_code_aware_runtime_error{U8("Planes"), plane_count, U8("Message"),
+                    U8("The number of the planes is out of range.")};
+            }
+
+            if (element_size == 0 || plane_size % element_size != 0 || interleaved_size != plane_size * plane_count) {
+                throw source_code_aware_runtime_error{U8("Interleaved Size"), interleaved_size, U8("Plane Size"),
+                    plane_size, U8("Element Size"), element_size, U8("Message"),
+                    U8("The size of the interleaved buffer does not match the planes.")};
+            }
+
+            return plane_size / element_size;
+        }
+    } // namespace
+
+    void deinterleave(std::span<const std::byte> interleaved, std::span<const std::span<std::byte>> planes,
+        std::size_t element_size) {
+        const auto count =
+            get_element_count(interleaved.size(), planes.size(), planes.empty() ? 0 : planes[0].size(), element_size);
+        const auto channels = planes.size();
+        plane_pointers pointers{};
+
+        for (std::size_t i = 0; i < channels; i++) {
+            if (planes[i].size() != planes[0].size()) {
+                throw source_code_aware_runtime_error{U8("Plane"), i, U8("Message"), U8("The planes differ in size.")};
+            }
+
+            pointers[i] = planes[i].data();
+        }
+
+        if (count == 0) {
+            return;
+        }
+
+        if (channels == 1) {
+            std::memcpy(pointers[0], interleaved.data(), interleaved.size());
+
+            return;
+        }
+
+        const auto source = interleaved.data();
+
+        switch (element_size) {
+        case 1:
+            return deinterleave_sized<1>(
+                source, pointers, channels, deinterleave_bytes_simd(source, pointers, channels, count), count);
+        case 2:
+            return deinterleave_sized<2>(source, pointers, channels, 0, count);
+        case 4:
+            return deinterleave_sized<4>(source, pointers, channels, 0, count);
+        case 8:
+            return deinterleave_sized<8>(source, pointers, channels, 0, count);
+        default:
+            for (std::size_t i = 0; i < count; i++) {
+                for (std::size_t channel = 0; channel < channels; channel++) {
+                    std::memcpy(pointers[channel] + i * element_size,
+                        source + (i * channels + channel) * element_size, element_size);
+                }
+            }
+        }
+    }
+
+    void interleave(std::span<const std::span<const std::byte>> planes, std::span<std::byte> interleaved,
+        std::size_t element_size) {
+        const auto count =
+            get_element_count(interleaved.size(), planes.size(), planes.empty() ? 0 : planes[0].size(), element_size);
+        const auto channels = planes.size();
+        plane_pointers pointers{};
+
+        for (std::size_t i = 0; i < channels; i++) {
+            if (planes[i].size() != planes[0].size()) {
+                throw source_code_aware_runtime_error{U8("Plane"), i, U8("Message"), U8("The planes differ in size.")};
+            }
+
+            // The kernels only read through the pointers.
+            pointers[i] = const_cast<std::byte*>(planes[i].data());
+        }
+
+        if (count == 0) {
+            return;
+        }
+
+        if (channels == 1) {
+            std::memcpy(interleaved.data(), pointers[0], interleaved.size());
+
+            return;
+        }
+
+        const auto target = interleaved.data();
+
+        switch (element_size) {
+        case 1:
+            return interleave_sized<1>(
+                pointers, target, channels, interleave_bytes_simd(pointers, target, channels, count), count);
+        case 2:
+            return interleave_sized<2>(pointers, target, channels, 0, count);
+        case 4:
+            return interleave_sized<4>(pointers, target, channels, 0, count);
+        case 8:
+            return interleave_sized<8>(pointers, target, channels, 0, count);
+        default:
+            for (std::size_t i = 0; i < count; i++) {
+                for (std::size_t channel = 0; channel < channels; channel++) {
+                    std::memcpy(target + (i * channels + channel) * element_size,
+                        pointers[channel] + i * element_size, element_size);
+                }
+            }
+        }
+    }
+} // namespace essence::memory
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "memory/memory_resources.hpp"
+
+#include "memory/aligned_buffer.hpp"
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <new>
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define ES_HAS_PAGE_MAPPING 1
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace essence::memory {
+    namespace {
+#ifdef _WIN32
+        std::size_t get_allocation_granularity() noexcept {
+            static const auto granularity = [] {
+                SYSTEM_INFO info{};
+
+                GetSystemInfo(&info);
+
+                return static_cast<std::size_t>(info.dwAllocationGranularity);
+            }();
+
+            return granularity;
+        }
+
+        std::int32_t get_current_node() noexcept {
+            PROCESSOR_NUMBER processor{};
+            USHORT node{};
+
+            GetCurrentProcessorNumberEx(&processor);
+
+            return GetNumaProcessorNodeEx(&processor, &node) ? static_cast<std::int32_t>(node) : -1;
+        }
+
+        bool is_mappable(std::size_t size, std::size_t alignment) noexcept {
+            return size >= page_resource_threshold && alignment <= get_allocation_granularity();
+        }
+
+        void* map_pages(std::size_t size, [[maybe_unused]] std::size_t alignment, bool numa_local) noexcept {
+            // Large pages need the SeLockMemoryPrivilege, so only the placement is controlled.
+            const auto node = numa_local ? get_current_node() : -1;
+
+            return node >= 0 ? VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT,
+                                   PAGE_READWRITE, static_cast<DWORD>(node))
+                             : VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        }
+
+        void unmap_pages(
+            void* ptr, [[maybe_unused]] std::size_t size, [[maybe_unused]] std::size_t alignment) noexcept {
+            VirtualFree(ptr, 0, MEM_RELEASE);
+        }
+#elif defined(ES_HAS_PAGE_MAPPING)
+        std::size_t get_page_size() noexcept {
+            static const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+            return page_size;
+        }
+
+        std::int32_t get_current_node() noexcept {
+#if defined(__linux__) && defined(SYS_getcpu)
+            unsigned int cpu{};
+            unsigned int node{};
+
+            return syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 ? static_cast<std::int32_t>(node) : -1;
+#else
+            return -1;
+#endif
+        }
+
+        bool is_mappable(std::size_t size, std::size_t alignment) noexcept {
+            return size >= page_resource_threshold && alignment <= huge_page_threshold;
+        }
+
+        /**
+         * @brief Gets the length of the mapping of an allocation, which is whole huge pages for large ones.
+         */
+        std::size_t get_mapping_size(std::size_t size) noexcept {
+            const auto granularity = size >= huge_page_threshold ? huge_page_threshold : get_page_size();
+
+            return (size + granularity - 1) / granularity * granularity;
+        }
+
+        void* map_aligned(std::size_t size, std::size_t alignment) noexcept {
+            if (alignment <= get_page_size()) {
+                const auto result = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+                return result == MAP_FAILED ? nullptr : result;
+            }
+
+            // Over-maps and trims both ends to reach an alignment beyond the page size.
+            const auto reserved = mmap(
+                nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (reserved == MAP_FAILED) {
+                return nullptr;
+            }
+
+            const auto address = reinterpret_cast<std::uintptr_t>(reserved);
+            const auto head    = (alignment - address % alignment) % alignment;
+            const auto result  = static_cast<std::byte*>(reserved) + head;
+
+            if (head != 0) {
+                munmap(reserved, head);
+            }
+
+            munmap(result + size, alignment - head);
+
+            return result;
+        }
+
+        void bind_to_node([[maybe_unused]] void* ptr, [[maybe_unused]] std::size_t size,
+            [[maybe_unused]] std::int32_t node) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+            // MPOL_PREFERRED from <numaif.h>, which falls back to other nodes rather than failing on a full node.
+            static constexpr int preferred_policy = 1;
+            static constexpr std::size_t bits     = sizeof(unsigned long) * CHAR_BIT;
+
+            std::array<unsigned long, 16> mask{};
+
+            if (node < 0 || static_cast<std::size_t>(node) >= mask.size() * bits) {
+                return;
+            }
+
+            mask[static_cast<std::size_t>(node) / bits] = 1UL << (static_cast<std::size_t>(node) % bits);
+
+            // Only a hint, the pages stay usable wherever the kernel places them when it fails.
+            static_cast<void>(syscall(SYS_mbind, ptr, size, preferred_policy, mask.data(), mask.size() * bits + 1, 0));
+#endif
+        }
+
+        void* map_explicit_huge_pages([[maybe_unused]] std::size_t size) noexcept {
+#ifdef MAP_HUGETLB
+            // Explicit huge pages only exist if the administrator has reserved them, and are naturally aligned.
+            const auto result =
+                mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+            return result == MAP_FAILED ? nullptr : result;
+#else
+            return nullptr;
+#endif
+        }
+
+        void* map_pages(std::size_t size, std::size_t alignment, bool numa_local) noexcept {
+            const auto mapping_size = get_mapping_size(size);
+            const auto huge         = mapping_size >= huge_page_threshold;
+            auto result             = huge ? map_explicit_huge_pages(mapping_size) : nullptr;
+
+            if (!result) {
+                result = map_aligned(mapping_size, huge ? huge_page_threshold : alignment);
+
+                if (!result) {
+                    return nullptr;
+                }
+
+#ifdef MADV_HUGEPAGE
+                // Falls back to transparent huge pages, which is also only a hint.
+                if (huge) {
+                    static_cast<void>(madvise(result, mapping_size, MADV_HUGEPAGE));
+                }
+#endif
+            }
+
+            // The policy applies to the pages faulted in later, so it must be set before the memory is touched.
+            if (numa_local) {
+                bind_to_node(result, mapping_size, get_current_node());
+            }
+
+            return result;
+        }
+
+        void unmap_pages(void* ptr, std::size_t size, [[maybe_unused]] std::size_t alignment) noexcept {
+            munmap(ptr, get_mapping_size(size));
+        }
+#else
+        std::int32_t get_current_node() noexcept {
+            return -1;
+        }
+
+        bool is_mappable([[maybe_unused]] std::size_t size, [[maybe_unused]] std::size_t alignment) noexcept {
+            return false;
+        }
+
+        void* map_pages([[maybe_unused]] std::size_t size, [[maybe_unused]] std::size_t alignment,
+            [[maybe_unused]] bool numa_local) noexcept {
+            return nullptr;
+        }
+
+        void unmap_pages([[maybe_unused]] void* ptr, [[maybe_unused]] std::size_t size,
+            [[maybe_unused]] std::size_t alignment) noexcept {}
+#endif
+
+        /**
+         * @brief A resource mapping large allocations to their own pages, whose choice between the pages and the heap
+         *        only depends on the size and the alignment, so deallocations need no bookkeeping.
+         */
+        class page_resource final : public std::pmr::memory_resource {
+        public:
+            explicit page_resource(bool numa_local) noexcept : numa_local_{numa_local} {}
+
+        protected:
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+                if (!is_mappable(bytes, alignment)) {
+                    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+                }
+
+                const auto result = map_pages(bytes, alignment, numa_local_);
+
+                if (!result) {
+                    throw std::bad_alloc{};
+                }
+
+                return result;
+            }
+
+            void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+                if (is_mappable(bytes, alignment)) {
+                    unmap_pages(ptr, bytes, alignment);
+                } else {
+                    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+                }
+            }
+
+            [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override {
+                const auto target = dynamic_cast<const page_resource*>(&other);
+
+                return target && target->numa_local_ == numa_local_;
+            }
+
+        private:
+            bool numa_local_;
+        };
+    } // namespace
+
+    std::pmr::memory_resource* get_huge_page_resource() noexcept {
+        static const auto resource = new page_resource{false};
+
+        return resource;
+    }
+
+    std::pmr::memory_resource* get_numa_local_resource() noexcept {
+        static const auto resource = new page_resource{true};
+
+        return resource;
+    }
+
+    std::int32_t get_current_numa_node() noexcept {
+        return get_current_node();
+    }
+} // namespace essence::memory
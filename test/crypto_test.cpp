@@ -116,6 +116,23 @@ MAKE_TEST(digest) {
     }
 }
 
+MAKE_TEST(file_digest_async) {
+    const std::string content(3 * 1024 * 1024 + 17, U8('x'));
+    const std::array<std::string, 2> file_names{
+        std::string{test_info_->name()} + U8(".empty"), std::string{test_info_->name()} + U8(".large")};
+
+    get_native_fs_operator().write_all(file_names[0], {});
+    get_native_fs_operator().write_all(file_names[1], as_const_byte_span(content));
+
+    const std::array<std::string_view, 3> paths{file_names[0], file_names[1], U8("not_existing_file")};
+    auto futures = make_file_digests_async(digest_mode::sha256, paths);
+
+    ASSERT_EQ(futures.size(), paths.size());
+    ASSERT_EQ(futures[0].get(), make_file_digest(digest_mode::sha256, file_names[0]));
+    ASSERT_EQ(futures[1].get(), make_digest(digest_mode::sha256, content));
+    ASSERT_THROW(futures[2].get(), std::runtime_error);
+}
+
 MAKE_TEST(base64) {
     static const essence::abi::vector<std::byte> binary{std::byte{0}, std::byte{1}, std::byte{2}, std::byte{3}};
     static constexpr zstring_view str{U8("Something like that!!!")};
@@ -18,12 +18,39 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <ranges>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <thread>
+#include <vector>
 
 #include <essence/char8_t_remediation.hpp>
+#include <essence/io/async_file_io.hpp>
+#include <essence/io/bitstream_type_judger.hpp>
+#include <essence/io/caching_fs_operator.hpp>
+#include <essence/io/compresser.hpp>
+#include <essence/io/compression_dictionary.hpp>
+#include <essence/io/directory_scanner.hpp>
+#include <essence/io/fs_operator.hpp>
+#include <essence/io/memory_stream.hpp>
+#include <essence/io/mmap_fs_operator.hpp>
+#include <essence/io/multiplexed_stdio_watcher.hpp>
+#include <essence/io/resource_archive.hpp>
+#include <essence/io/seekable_compression.hpp>
 #include <essence/io/stdio_watcher.hpp>
 
 #include <gtest/gtest.h>
@@ -33,6 +60,757 @@ using namespace essence::io;
 
 #define MAKE_TEST(name) TEST(io_test, name)
 
+namespace {
+    std::string make_repetitive_text(std::size_t size) {
+        std::string result;
+
+        for (std::size_t i = 0; result.size() < size; i++) {
+            result.append(std::to_string(i % 1000)).append(U8(" The quick brown fox jumps over the lazy dog.\n"));
+        }
+
+        return result;
+    }
+
+    std::vector<std::string> make_json_messages(std::size_t count) {
+        std::vector<std::string> result;
+
+        for (std::size_t i = 0; i < count; i++) {
+            const auto id = std::to_string(i);
+
+            result.emplace_back(U8(R"({"id":)") + id + U8(R"(,"name":"user-)") + id
+                                + U8(R"(","roles":["reader","writer"],"active":true,"region":"cn-north-)")
+                                + std::to_string(i % 7) + U8(R"(","tags":{"tier":"gold","source":"mobile"}})"));
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Builds a zstd frame of raw blocks which omits its content size, as a streaming encoder does when the
+     *        size is not pledged.
+     */
+    std::vector<std::byte> make_unsized_zstd_frame(std::string_view content) {
+        static constexpr std::size_t max_block_size = 128 * 1024;
+
+        // The magic number, a descriptor without the content size and a 2 MiB window.
+        std::vector<std::byte> result{
+            std::byte{0x28}, std::byte{0xB5}, std::byte{0x2F}, std::byte{0xFD}, std::byte{0x00}, std::byte{0x58}};
+
+        do {
+            const auto block = content.substr(0, max_block_size);
+
+            content.remove_prefix(block.size());
+
+            // The 3-byte block header holds the last-block flag, the block type (raw) and the block size.
+            const auto header = static_cast<std::uint32_t>(block.size() << 3 | (content.empty() ? 1 : 0));
+
+            for (std::size_t i = 0; i < 3; i++) {
+                result.emplace_back(static_cast<std::byte>(header >> (i * 8)));
+            }
+
+            const auto bytes = as_const_byte_span(block);
+
+            result.insert(result.end(), bytes.begin(), bytes.end());
+        } while (!content.empty());
+
+        return result;
+    }
+
+    struct test_type_hint {
+        std::string name_;
+        std::string leading_;
+        std::string trailing_;
+
+        [[nodiscard]] essence::abi::string name() const {
+            return essence::abi::string{name_};
+        }
+
+        [[nodiscard]] static std::span<const essence::abi::string> file_extensions() noexcept {
+            return {};
+        }
+
+        [[nodiscard]] std::size_t leading_signature_size() const noexcept {
+            return leading_.size();
+        }
+
+        [[nodiscard]] std::span<const std::byte> leading_signature() const noexcept {
+            return as_const_byte_span(leading_);
+        }
+
+        [[nodiscard]] std::string_view leading_signature_str() const noexcept {
+            return leading_;
+        }
+
+        [[nodiscard]] std::size_t trailing_signature_size() const noexcept {
+            return trailing_.size();
+        }
+
+        [[nodiscard]] std::span<const std::byte> trailing_signature() const noexcept {
+            return as_const_byte_span(trailing_);
+        }
+
+        [[nodiscard]] std::string_view trailing_signature_str() const noexcept {
+            return trailing_;
+        }
+    };
+
+    struct stream_only_fs_operator {
+        static bool exists(std::string_view path) {
+            return get_native_fs_operator().exists(path);
+        }
+
+        static bool is_file(std::string_view path) {
+            return get_native_fs_operator().is_file(path);
+        }
+
+        static bool is_directory(std::string_view path) {
+            return get_native_fs_operator().is_directory(path);
+        }
+
+        static std::unique_ptr<std::iostream> open(std::string_view path, std::ios_base::openmode mode) {
+            return get_native_fs_operator().open(path, mode);
+        }
+
+        static std::unique_ptr<std::istream> open_read(std::string_view path, std::ios_base::openmode mode) {
+            return get_native_fs_operator().open_read(path, mode);
+        }
+
+        static std::unique_ptr<std::ostream> open_write(std::string_view path, std::ios_base::openmode mode) {
+            return get_native_fs_operator().open_write(path, mode);
+        }
+    };
+} // namespace
+
+MAKE_TEST(compresser_multithreaded) {
+    const auto text = make_repetitive_text(8 * 1024 * 1024);
+    const compresser single_threaded{compression_mode::zstd};
+    const compresser multithreaded{compression_mode::zstd, compression_options{
+                                                               .worker_count           = 4,
+                                                               .job_size               = 1024 * 1024,
+                                                               .long_distance_matching = true,
+                                                               .window_log             = 24,
+                                                           }};
+
+    const auto compressed = multithreaded.as_bytes(text, 3);
+
+    ASSERT_LT(compressed.size(), text.size());
+    ASSERT_EQ(single_threaded.inverse_as_string(compressed), std::string_view{text});
+    ASSERT_EQ(multithreaded.inverse_as_string(single_threaded.as_bytes(text, 3)), std::string_view{text});
+}
+
+MAKE_TEST(compresser_dictionary) {
+    const auto messages   = make_json_messages(2000);
+    const auto dictionary = compression_dictionary::train(messages, 16 * 1024);
+    const compresser plain{compression_mode::zstd};
+    const compresser with_dictionary{compression_mode::zstd, dictionary};
+    std::size_t plain_size{};
+    std::size_t dictionary_size{};
+
+    for (auto&& item : messages) {
+        const auto compressed = with_dictionary.as_bytes(item, 3);
+
+        plain_size += plain.as_bytes(item, 3).size();
+        dictionary_size += compressed.size();
+        ASSERT_EQ(with_dictionary.inverse_as_string(compressed), std::string_view{item});
+    }
+
+    ASSERT_LT(dictionary_size * 2, plain_size);
+
+    const auto file_name = std::string{test_info_->name()} + U8(".dict");
+
+    get_native_fs_operator()
+        .open_write(file_name, std::ios::out | std::ios::binary)
+        ->write(reinterpret_cast<const char*>(dictionary.content().data()),
+            static_cast<std::streamsize>(dictionary.content().size()));
+
+    ASSERT_EQ(compression_dictionary::from_file(get_native_fs_operator(), file_name).id(), dictionary.id());
+}
+
+MAKE_TEST(compresser_concatenated_frames) {
+    const auto first  = make_repetitive_text(300 * 1024);
+    const auto second = make_repetitive_text(200 * 1024);
+    const compresser zstd{compression_mode::zstd};
+    auto compressed         = zstd.as_bytes(first, 3);
+    const auto second_frame = zstd.as_bytes(second, 3);
+
+    compressed.insert(compressed.end(), second_frame.begin(), second_frame.end());
+
+    const auto expected = first + second;
+
+    ASSERT_EQ(zstd.inverse_as_string(compressed), std::string_view{expected});
+}
+
+MAKE_TEST(compresser_unknown_content_size) {
+    const auto text = make_repetitive_text(300 * 1024);
+    const compresser zstd{compression_mode::zstd};
+    const auto unsized = make_unsized_zstd_frame(text);
+
+    // The frames without a content size are decompressed by streaming, alone or after a sized one.
+    ASSERT_EQ(zstd.inverse_as_string(unsized), std::string_view{text});
+
+    auto concatenated = zstd.as_bytes(text, 3);
+
+    concatenated.insert(concatenated.end(), unsized.begin(), unsized.end());
+
+    const auto expected = text + text;
+
+    ASSERT_EQ(zstd.inverse_as_string(concatenated), std::string_view{expected});
+}
+
+MAKE_TEST(compresser_truncated_frame) {
+    const auto text = make_repetitive_text(300 * 1024);
+    const compresser zstd{compression_mode::zstd};
+    const auto sized   = zstd.as_bytes(text, 3);
+    const auto unsized = make_unsized_zstd_frame(text);
+
+    ASSERT_THROW(static_cast<void>(zstd.inverse_as_bytes(std::span{sized}.first(sized.size() - 1))),
+        std::runtime_error);
+    ASSERT_THROW(static_cast<void>(zstd.inverse_as_bytes(std::span{unsized}.first(unsized.size() - 1))),
+        std::runtime_error);
+}
+
+MAKE_TEST(compresser_max_decompressed_size) {
+    const auto text = make_repetitive_text(1024 * 1024);
+
+    for (auto mode : {compression_mode::zstd, compression_mode::zlib}) {
+        const compresser unlimited{mode};
+        const compresser limited{mode, compression_options{.max_decompressed_size = 64 * 1024}};
+        const auto compressed = unlimited.as_bytes(text, 3);
+
+        ASSERT_EQ(unlimited.inverse_as_string(compressed), std::string_view{text});
+        ASSERT_THROW(static_cast<void>(limited.inverse_as_bytes(compressed)), std::runtime_error);
+    }
+}
+
+MAKE_TEST(compresser_caller_buffer) {
+    const auto messages = make_json_messages(100);
+
+    for (auto mode : {compression_mode::zstd, compression_mode::zlib}) {
+        const compresser instance{mode};
+        std::vector<std::byte> compressed;
+        std::vector<std::byte> decompressed;
+
+        for (auto&& item : messages) {
+            const auto buffer = as_const_byte_span(item);
+
+            compressed.resize(instance.compress_bound(buffer.size()));
+            decompressed.resize(buffer.size());
+            compressed.resize(instance.compress_into(buffer, compressed, 3));
+
+            ASSERT_EQ(instance.decompress_into(compressed, decompressed), buffer.size());
+            ASSERT_TRUE(std::ranges::equal(decompressed, buffer));
+            ASSERT_EQ(instance.inverse_as_string(compressed), std::string_view{item});
+        }
+
+        decompressed.resize(8);
+        ASSERT_THROW(static_cast<void>(instance.decompress_into(compressed, decompressed)), std::runtime_error);
+    }
+}
+
+MAKE_TEST(compresser_parallel_gzip) {
+    const auto text = make_repetitive_text(2 * 1024 * 1024 + 7);
+    const compresser single_threaded{compression_mode::gzip};
+    const compresser multithreaded{compression_mode::gzip, compression_options{
+                                                               .worker_count = 4,
+                                                               .job_size     = 64 * 1024,
+                                                           }};
+
+    auto compressed         = multithreaded.as_bytes(text, 6);
+    const auto other_member = single_threaded.as_bytes(text, 6);
+
+    ASSERT_LT(compressed.size(), text.size() / 4);
+    ASSERT_EQ(std::to_integer<std::uint8_t>(compressed[0]), 0x1F);
+    ASSERT_EQ(std::to_integer<std::uint8_t>(compressed[1]), 0x8B);
+    ASSERT_EQ(single_threaded.inverse_as_string(compressed), std::string_view{text});
+    ASSERT_EQ(multithreaded.inverse_as_string(other_member), std::string_view{text});
+
+    // Concatenated gzip members decompress to the concatenation of their contents.
+    compressed.insert(compressed.end(), other_member.begin(), other_member.end());
+
+    const auto expected = text + text;
+
+    ASSERT_EQ(single_threaded.inverse_as_string(compressed), std::string_view{expected});
+}
+
+MAKE_TEST(compresser_adaptive) {
+    std::mt19937 engine{42};
+    std::vector<std::byte> random_data(512 * 1024);
+    const auto text = make_repetitive_text(512 * 1024);
+
+    std::ranges::generate(random_data, [&] { return static_cast<std::byte>(engine()); });
+
+    auto payload = random_data;
+
+    payload.insert(payload.end(), as_const_byte_span(text).begin(), as_const_byte_span(text).end());
+
+    const compresser adaptive{compression_mode::adaptive};
+    const compresser zstd{compression_mode::zstd};
+    const auto compressed = adaptive.as_bytes(payload, 3);
+
+    // The random half is stored raw, so the container costs little more than the compressed text.
+    ASSERT_LT(compressed.size(), random_data.size() + zstd.as_bytes(text, 3).size() + 64);
+    ASSERT_TRUE(std::ranges::equal(adaptive.inverse_as_bytes(compressed), payload));
+    ASSERT_EQ(adaptive.inverse_as_string(adaptive.as_bytes(text, 3)), std::string_view{text});
+    ASSERT_TRUE(adaptive.inverse_as_bytes(adaptive.as_bytes(std::span<const std::byte>{}, 3)).empty());
+}
+
+MAKE_TEST(seekable_compression) {
+    const auto text       = make_repetitive_text(3 * 1024 * 1024 + 123);
+    const auto compressed = compress_seekable(text, 3, seekable_compression_options{.block_size = 64 * 1024});
+    const auto file_name  = std::string{test_info_->name()} + U8(".zst");
+
+    get_native_fs_operator()
+        .open_write(file_name, std::ios::out | std::ios::binary)
+        ->write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+
+    // The seek table is a skippable frame, so the whole data remains a valid zstd stream.
+    ASSERT_EQ(compresser{compression_mode::zstd}.inverse_as_string(compressed), std::string_view{text});
+
+    const std::array decompressers{
+        seekable_decompresser{compressed}, seekable_decompresser{get_native_fs_operator(), file_name}};
+
+    for (auto&& decompresser : decompressers) {
+        ASSERT_EQ(decompresser.size(), text.size());
+        ASSERT_EQ(decompresser.frame_count(), text.size() / (64 * 1024) + 1);
+
+        for (const auto& [offset, length] : std::initializer_list<std::pair<std::size_t, std::size_t>>{
+                 {0, 10}, {65530, 20}, {100000, 500000}, {text.size() - 5, 100}, {text.size(), 1}}) {
+            const auto expected = std::string_view{text}.substr(offset, length);
+
+            for (std::uint32_t worker_count : {0U, 4U}) {
+                const auto range = decompresser.read_range(offset, length, worker_count);
+
+                ASSERT_TRUE(std::ranges::equal(range, as_const_byte_span(expected)));
+            }
+        }
+    }
+}
+
+MAKE_TEST(memory_stream) {
+    const auto text = make_repetitive_text(100 * 1024);
+    memory_stream stream;
+
+    // Bulk writes grow the buffer geometrically and character writes go through overflow.
+    stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+    stream << 'x' << 42;
+    ASSERT_EQ(stream.size(), text.size() + 3);
+
+    std::string head(16, '\0');
+
+    ASSERT_TRUE(stream.read(head.data(), static_cast<std::streamsize>(head.size())));
+    ASSERT_EQ(head, std::string_view{text}.substr(0, head.size()));
+
+    // Overwrites the beginning without changing the size.
+    stream.seekp(0);
+    stream << U8("HEAD");
+    ASSERT_EQ(stream.size(), text.size() + 3);
+
+    stream.seekg(-3, std::ios_base::end);
+    std::string tail;
+    stream >> tail;
+    ASSERT_EQ(tail, U8("x42"));
+
+    const auto* data  = stream.span().data();
+    const auto buffer = stream.release();
+
+    ASSERT_EQ(reinterpret_cast<const char*>(buffer.data()), data) << U8("The buffer is copied.");
+    ASSERT_EQ(buffer.size(), text.size() + 3);
+    ASSERT_EQ(stream.size(), 0U);
+
+    memory_istream input{buffer};
+    std::string prefix(4, '\0');
+
+    ASSERT_TRUE(input.read(prefix.data(), static_cast<std::streamsize>(prefix.size())));
+    ASSERT_EQ(prefix, U8("HEAD"));
+}
+
+MAKE_TEST(mmap_fs_operator) {
+    const mmap_fs_operator fs_operator;
+
+    for (const std::size_t size : {0, 100, 256 * 1024}) {
+        const auto text      = make_repetitive_text(size);
+        const auto file_name = std::string{test_info_->name()} + U8(".") + std::to_string(size) + U8(".txt");
+
+        get_native_fs_operator().open_write(file_name, std::ios::out | std::ios::binary)->write(text.data(),
+            static_cast<std::streamsize>(text.size()));
+
+        const auto buffer = fs_operator.map_read(file_name);
+
+        ASSERT_EQ(buffer.size(), text.size());
+        ASSERT_TRUE(std::ranges::equal(buffer.span(), as_const_byte_span(text)));
+
+        const auto stream = get_mmap_fs_operator().open_read(file_name, std::ios::in | std::ios::binary);
+
+        ASSERT_EQ((std::string{std::istreambuf_iterator<char>{*stream}, std::istreambuf_iterator<char>{}}), text);
+    }
+
+    ASSERT_THROW(static_cast<void>(fs_operator.map_read(U8("not_existing_file"))), std::runtime_error);
+    ASSERT_THROW(static_cast<void>(get_mmap_fs_operator().open_write(U8("foo"))), std::runtime_error);
+}
+
+MAKE_TEST(virtual_fs_operator_read_apis) {
+    const auto text      = make_repetitive_text(64 * 1024);
+    const auto file_name = std::string{test_info_->name()} + U8(".txt");
+    const abstract::virtual_fs_operator stream_only{stream_only_fs_operator{}};
+
+    for (auto&& fs_operator : {&get_native_fs_operator(), &stream_only}) {
+        fs_operator->write_all(file_name, as_const_byte_span(text));
+
+        ASSERT_EQ(fs_operator->file_size(file_name), text.size());
+        ASSERT_TRUE(std::ranges::equal(fs_operator->read_all(file_name), as_const_byte_span(text)));
+
+        std::array<std::byte, 100> range{};
+
+        ASSERT_EQ(fs_operator->read_range(file_name, 1000, range), range.size());
+        ASSERT_TRUE(std::ranges::equal(range, as_const_byte_span(text).subspan(1000, range.size())));
+        ASSERT_EQ(fs_operator->read_range(file_name, text.size() - 10, range), 10U);
+        ASSERT_EQ(fs_operator->read_range(file_name, text.size() + 10, range), 0U);
+    }
+
+    ASSERT_TRUE(std::ranges::equal(get_mmap_fs_operator().read_all(file_name), as_const_byte_span(text)));
+    ASSERT_THROW(get_mmap_fs_operator().write_all(file_name, {}), std::runtime_error);
+    ASSERT_THROW(static_cast<void>(get_native_fs_operator().read_all(U8("not_existing_file"))), std::runtime_error);
+}
+
+MAKE_TEST(caching_fs_operator) {
+    const auto file_name = std::string{test_info_->name()} + U8(".txt");
+    const caching_fs_operator cache{
+        get_native_fs_operator(), caching_fs_options{.capacity = 64 * 1024, .shard_count = 1}};
+    const auto fs_operator = abstract::virtual_fs_operator{caching_fs_operator{cache}};
+
+    const auto original = make_repetitive_text(1000);
+
+    get_native_fs_operator().write_all(file_name, as_const_byte_span(original));
+
+    ASSERT_EQ(fs_operator.read_all(file_name).size(), original.size());
+    ASSERT_EQ(fs_operator.read_all(file_name).size(), original.size());
+    ASSERT_EQ(cache.stats().hits, 1U);
+    ASSERT_EQ(cache.stats().misses, 1U);
+    ASSERT_EQ(cache.stats().cached_bytes, original.size());
+
+    // The file is modified behind the cache.
+    const auto text = make_repetitive_text(2000);
+
+    get_native_fs_operator().write_all(file_name, as_const_byte_span(text));
+
+    const auto stream = fs_operator.open_read(file_name, std::ios::in | std::ios::binary);
+
+    ASSERT_EQ((std::string{std::istreambuf_iterator<char>{*stream}, std::istreambuf_iterator<char>{}}), text);
+    ASSERT_EQ(cache.stats().stale, 1U);
+
+    ASSERT_TRUE(fs_operator.exists(file_name));
+    ASSERT_TRUE(fs_operator.is_file(file_name));
+    ASSERT_TRUE(fs_operator.exists(file_name));
+    ASSERT_EQ(cache.stats().metadata_hits, 1U);
+
+    // Files beyond the capacity evict the least recently used ones.
+    for (std::size_t i = 0; i < 3; i++) {
+        fs_operator.write_all(file_name + std::to_string(i), as_const_byte_span(make_repetitive_text(40 * 1024)));
+        static_cast<void>(fs_operator.read_all(file_name + std::to_string(i)));
+    }
+
+    ASSERT_EQ(cache.stats().evictions, 3U);
+    ASSERT_LE(cache.stats().cached_bytes, 64U * 1024);
+
+    // Ranges of a file beyond the capacity are read without loading the file.
+    const auto large_text   = make_repetitive_text(128 * 1024);
+    const auto cached_bytes  = cache.stats().cached_bytes;
+    std::array<std::byte, 100> range{};
+
+    fs_operator.write_all(file_name, as_const_byte_span(large_text));
+
+    ASSERT_EQ(fs_operator.read_range(file_name, 1000, range), range.size());
+    ASSERT_TRUE(std::ranges::equal(range, as_const_byte_span(large_text).subspan(1000, range.size())));
+    ASSERT_EQ(cache.stats().cached_bytes, cached_bytes);
+
+    cache.clear();
+    ASSERT_EQ(cache.stats().cached_bytes, 0U);
+}
+
+MAKE_TEST(resource_archive) {
+    const auto archive_name = std::string{test_info_->name()} + U8(".pack");
+    const auto text         = make_repetitive_text(64 * 1024);
+    std::vector<std::byte> noise(10000);
+    std::mt19937 engine{42};
+
+    std::ranges::generate(noise, [&] { return static_cast<std::byte>(engine()); });
+
+    {
+        const resource_archive_writer writer;
+
+        writer.add(U8("lang/zh.lang"), as_const_byte_span(text));
+        writer.add(U8("/images/noise.bin"), noise);
+        writer.add(U8("empty"), {});
+        ASSERT_THROW(writer.add(U8("lang\\zh.lang"), {}), std::runtime_error) << U8("Duplicate paths are accepted.");
+        writer.save(archive_name);
+    }
+
+    const resource_archive_fs_operator archive{archive_name, resource_archive_options{.cache_capacity = 1024}};
+    const auto fs_operator = make_resource_archive_fs_operator(archive_name);
+
+    ASSERT_EQ(archive.entry_count(), 3U);
+    ASSERT_TRUE(archive.is_file(U8("images/noise.bin")));
+    ASSERT_TRUE(archive.is_directory(U8("lang")));
+    ASSERT_FALSE(archive.is_directory(U8("lan")));
+    ASSERT_FALSE(archive.exists(U8("lang/en.lang")));
+    ASSERT_TRUE(fs_operator.exists(U8("./lang/zh.lang")));
+    ASSERT_EQ(fs_operator.file_size(U8("lang/zh.lang")), text.size());
+    ASSERT_TRUE(std::ranges::equal(fs_operator.read_all(U8("lang/zh.lang")), as_const_byte_span(text)));
+    ASSERT_TRUE(std::ranges::equal(archive.read_all(U8("images/noise.bin")), noise));
+    ASSERT_TRUE(archive.read_all(U8("empty")).empty());
+
+    std::array<std::byte, 100> range{};
+
+    ASSERT_EQ(archive.read_range(U8("lang/zh.lang"), 1000, range), range.size());
+    ASSERT_TRUE(std::ranges::equal(range, as_const_byte_span(text).subspan(1000, range.size())));
+    ASSERT_EQ(archive.read_range(U8("images/noise.bin"), noise.size() - 10, range), 10U);
+
+    const auto root = fs_operator.list_directory({});
+
+    ASSERT_EQ(root.size(), 3U);
+    ASSERT_EQ(root[0].name, U8("empty"));
+    ASSERT_EQ(root[1].name, U8("images"));
+    ASSERT_EQ(root[1].type, directory_entry_type::directory);
+    ASSERT_EQ(fs_operator.list_directory(U8("lang")).front().name, U8("zh.lang"));
+
+    const auto stream = fs_operator.open_read(U8("lang/zh.lang"), std::ios::in | std::ios::binary);
+
+    ASSERT_EQ((std::string{std::istreambuf_iterator<char>{*stream}, std::istreambuf_iterator<char>{}}), text);
+    ASSERT_THROW(static_cast<void>(archive.read_all(U8("missing"))), std::runtime_error);
+    ASSERT_THROW(fs_operator.write_all(U8("lang/zh.lang"), {}), std::runtime_error);
+
+    get_native_fs_operator().write_all(archive_name, as_const_byte_span(text));
+    ASSERT_THROW(resource_archive_fs_operator{archive_name}, std::runtime_error) << U8("Not an archive.");
+}
+
+MAKE_TEST(resource_archive_corrupted) {
+    const auto archive_name = std::string{test_info_->name()} + U8(".pack");
+
+    {
+        const resource_archive_writer writer;
+
+        writer.add(U8("text"), as_const_byte_span(make_repetitive_text(64 * 1024)));
+        writer.save(archive_name);
+    }
+
+    const auto original = get_native_fs_operator().read_all(archive_name);
+
+    // The record of the only entry follows the 32-byte header, and stores the offset of the data at byte 16, the
+    // stored size at byte 24 and the original size at byte 32.
+    const auto check_corrupted = [&](std::size_t size, std::size_t field_offset, std::uint64_t value) {
+        auto data = original;
+
+        data.resize(size);
+
+        if (field_offset != 0) {
+            for (std::size_t i = 0; i < sizeof(value); i++) {
+                data[32 + field_offset + i] = static_cast<std::byte>(value >> (i * 8));
+            }
+        }
+
+        get_native_fs_operator().write_all(archive_name, data);
+        ASSERT_THROW(resource_archive_fs_operator{archive_name}, std::runtime_error);
+    };
+
+    ASSERT_NO_THROW(resource_archive_fs_operator{archive_name});
+    check_corrupted(original.size() - 1, 0, 0);
+    check_corrupted(original.size(), 16, original.size() + 1);
+    check_corrupted(original.size(), 32, std::uint64_t{1} << 40);
+}
+
+MAKE_TEST(directory_scanner) {
+    const auto root = std::string{test_info_->name()} + U8("_tree");
+    std::vector<std::string> expected;
+
+    std::filesystem::remove_all(root);
+
+    // Builds a tree of 4 levels with a file of each kind and 3 subdirectories per directory.
+    std::function<void(const std::string&, std::size_t)> make_tree = [&](const std::string& directory,
+                                                                         std::size_t depth) {
+        std::filesystem::create_directories(directory);
+        get_native_fs_operator().write_all(directory + U8("/a.TXT"), as_const_byte_span(std::string(depth * 10, 'a')));
+        get_native_fs_operator().write_all(directory + U8("/b.png"), as_const_byte_span(std::string(100, 'b')));
+
+        if (depth >= 2) {
+            expected.emplace_back(directory + U8("/a.TXT"));
+        }
+
+        if (depth != 0) {
+            for (std::size_t i = 0; i < 3; i++) {
+                make_tree(directory + U8("/d") + std::to_string(i), depth - 1);
+            }
+        }
+    };
+
+    make_tree(root, 3);
+    std::ranges::sort(expected);
+
+    const directory_scan_options options{.worker_count = 4, .extensions = {U8(".txt")}, .min_size = 20};
+    std::mutex mutex;
+    std::vector<std::string> paths;
+
+    scan_directory(get_native_fs_operator(), root, [&](std::span<const scan_entry> entries) {
+        std::scoped_lock lock{mutex};
+
+        for (auto&& item : entries) {
+            paths.emplace_back(item.path);
+        }
+
+        return true;
+    }, options);
+
+    std::ranges::sort(paths);
+    ASSERT_EQ(paths, expected);
+
+    const directory_scanner scanner{get_native_fs_operator(), root, {.include_directories = true}, 2};
+    std::size_t files{};
+    std::size_t directories{};
+
+    while (const auto entry = scanner.next()) {
+        ++(entry->type == directory_entry_type::directory ? directories : files);
+    }
+
+    ASSERT_EQ(directories, 3U + 9U + 27U);
+    ASSERT_EQ(files, (1U + 3U + 9U + 27U) * 2);
+    ASSERT_THROW(scan_directory(get_native_fs_operator(), root + U8("/a.TXT"), {}), std::runtime_error);
+
+    std::filesystem::remove_all(root);
+}
+
+MAKE_TEST(async_file_engine) {
+    const auto text      = make_repetitive_text(200 * 1024);
+    const auto file_name = std::string{test_info_->name()} + U8(".txt");
+
+    for (const auto backend : {async_io_backend::automatic, async_io_backend::thread_pool}) {
+        const async_file_engine engine{async_io_options{.backend = backend, .queue_depth = 4, .worker_count = 2}};
+
+        engine.write(file_name, as_const_byte_span(text)).get();
+
+        const std::array requests{
+            async_read_request{.path = file_name},
+            async_read_request{.path = file_name, .offset = 1000, .length = 100},
+            async_read_request{.path = file_name, .offset = 10, .length = 100, .origin = std::ios_base::end},
+            async_read_request{.path = file_name, .offset = text.size() - 10, .length = 100},
+        };
+
+        std::vector<std::future<async_read_result>> futures;
+
+        // Exceeds the queue depth deliberately.
+        for (std::size_t i = 0; i < 4; i++) {
+            for (auto&& item : requests) {
+                futures.emplace_back(engine.read(item));
+            }
+        }
+
+        for (std::size_t i = 0; i < futures.size(); i++) {
+            const auto result = futures[i].get();
+            const auto bytes  = as_const_byte_span(text);
+
+            ASSERT_EQ(result.file_size, text.size());
+
+            switch (i % requests.size()) {
+            case 0:
+                ASSERT_TRUE(std::ranges::equal(result.data, bytes));
+                break;
+            case 1:
+                ASSERT_TRUE(std::ranges::equal(result.data, bytes.subspan(1000, 100)));
+                break;
+            case 2:
+                ASSERT_TRUE(std::ranges::equal(result.data, bytes.subspan(bytes.size() - 110, 100)));
+                break;
+            default:
+                ASSERT_TRUE(std::ranges::equal(result.data, bytes.last(10)));
+                break;
+            }
+        }
+
+        ASSERT_THROW(static_cast<void>(engine.read(async_read_request{.path = U8("not_existing_file")}).get()),
+            std::runtime_error);
+
+        // Reads of an opened file are not affected by replacing the file on the path.
+        const async_read_file file{file_name};
+
+        const auto replacement = file_name + U8(".new");
+
+        engine.write(replacement, as_const_byte_span(std::string_view{U8("replaced")})).get();
+        std::filesystem::rename(replacement, file_name);
+
+        std::promise<async_read_result> promise;
+
+        engine.read(file, async_read_request{.offset = 1000, .length = 100},
+            [&](async_read_result result, std::exception_ptr error) {
+                if (error) {
+                    promise.set_exception(error);
+                } else {
+                    promise.set_value(std::move(result));
+                }
+            });
+
+        const auto result = promise.get_future().get();
+
+        ASSERT_EQ(result.file_size, text.size());
+        ASSERT_TRUE(std::ranges::equal(result.data, as_const_byte_span(text).subspan(1000, 100)));
+    }
+}
+
+MAKE_TEST(bitstream_type_judger) {
+    const std::array hints{
+        abstract::bitstream_type_hint{test_type_hint{U8("ab"), U8("AB"), U8("")}},
+        abstract::bitstream_type_hint{test_type_hint{U8("abc"), U8("ABC"), U8("")}},
+        abstract::bitstream_type_hint{test_type_hint{U8("ab-zz"), U8("AB"), U8("ZZ")}},
+        abstract::bitstream_type_hint{test_type_hint{U8("end"), U8(""), U8("END")}},
+        abstract::bitstream_type_hint{test_type_hint{U8("empty"), U8(""), U8("")}},
+    };
+
+    const bitstream_type_judger judger{hints};
+    const auto identify = [&](std::string_view buffer) {
+        const auto result = judger.identify(as_const_byte_span(buffer));
+
+        return result ? std::string{result->name()} : std::string{};
+    };
+
+    // The longest leading signature wins, then the longest trailing signature.
+    ASSERT_EQ(identify(U8("ABCxxx")), U8("abc"));
+    ASSERT_EQ(identify(U8("ABxxZZ")), U8("ab-zz"));
+    ASSERT_EQ(identify(U8("ABxx")), U8("ab"));
+    ASSERT_EQ(identify(U8("xxEND")), U8("end"));
+    ASSERT_EQ(identify(U8("ABZ")), U8("ab"));
+    ASSERT_EQ(identify(U8("xx")), U8(""));
+    ASSERT_EQ(identify(U8("")), U8(""));
+
+    const std::array contents{U8("ABCxxx"), U8("ABxxZZ"), U8("xxEND"), U8("AB")};
+    std::vector<std::string> file_names;
+
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        file_names.emplace_back(std::string{test_info_->name()} + U8(".") + std::to_string(i));
+        get_native_fs_operator().write_all(file_names.back(), as_const_byte_span(std::string_view{contents[i]}));
+    }
+
+    std::vector<std::string_view> paths{file_names.begin(), file_names.end()};
+
+    paths.emplace_back(U8("not_existing_file"));
+
+    const auto results = judger.identify_many(paths, 2);
+
+    ASSERT_EQ(results.size(), paths.size());
+    ASSERT_TRUE(std::ranges::all_of(
+        results | std::views::take(4), [](const auto& inner) { return inner.hint.has_value(); }));
+    ASSERT_EQ(results[0].hint->name(), U8("abc"));
+    ASSERT_EQ(results[1].hint->name(), U8("ab-zz"));
+    ASSERT_EQ(results[2].hint->name(), U8("end"));
+    ASSERT_EQ(results[3].hint->name(), U8("ab"));
+    ASSERT_FALSE(results[4].hint);
+    ASSERT_TRUE(results[4].error);
+    ASSERT_EQ(judger.identify(file_names[1])->name(), U8("ab-zz"));
+
+    // Streams are laid out as the files are, so that the trailing signature of short data is found too.
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        std::istringstream stream{contents[i]};
+
+        ASSERT_EQ(judger.identify(stream)->name(), results[i].hint->name());
+    }
+}
+
 MAKE_TEST(stdio_watcher) {
     const stdio_watcher watcher{stdio_watcher_mode::error};
     std::string lines;
@@ -52,3 +830,50 @@ MAKE_TEST(stdio_watcher) {
         lines.c_str(), U8("一些测试内容，Some Tests Included\n一旦发生错误所有的信息推荐使用 stderr 输出，以和 stdout "
                           "区分。\nAny error that occurrs in the context should be printed via stderr.\n"));
 }
+
+#ifndef _WIN32
+MAKE_TEST(multiplexed_stdio_watcher) {
+    const multiplexed_stdio_watcher watcher{multiplexed_stdio_options{.max_line_size = 16}};
+    std::vector<std::string> lines;
+    std::size_t batches{};
+
+    watcher.watch(stdio_watcher_mode::error);
+    watcher.on_lines([&](std::span<const stdio_line> batch) {
+        ++batches;
+
+        for (auto&& item : batch) {
+            ASSERT_EQ(item.source, fileno(stderr));
+            lines.emplace_back(item.text);
+        }
+    });
+
+    watcher.start();
+    ASSERT_ANY_THROW(watcher.watch(fileno(stdout)));
+
+    // Partial lines are reassembled and overlong lines are split.
+    std::cerr << U8("first ") << std::flush;
+    std::cerr << U8("line\r\nsecond line\n") << std::flush;
+    std::cerr << U8("a line longer than sixteen bytes\n") << U8("unterminated") << std::flush;
+    watcher.stop();
+
+    const std::vector<std::string> expected{
+        U8("first line"), U8("second line"), U8("a line longer th"), U8("an sixteen bytes"), U8("unterminated")};
+
+    ASSERT_EQ(lines, expected);
+    ASSERT_GE(batches, 1U);
+}
+
+#ifdef __linux__
+MAKE_TEST(multiplexed_stdio_watcher_unpollable_descriptor) {
+    const multiplexed_stdio_watcher watcher;
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file{std::tmpfile(), &std::fclose};
+
+    ASSERT_NE(file, nullptr);
+
+    // epoll rejects regular files, which is reported by start() rather than lost on the worker thread.
+    watcher.watch(fileno(file.get()));
+    ASSERT_ANY_THROW(watcher.start());
+    watcher.stop();
+}
+#endif
+#endif
@@ -0,0 +1,779 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <essence/abi/memory.hpp>
+#include <essence/abi/vector.hpp>
+#include <essence/char8_t_remediation.hpp>
+#include <essence/error_extensions.hpp>
+#include <essence/memory/aligned_buffer.hpp>
+#include <essence/memory/allocation_profiler.hpp>
+#include <essence/memory/atomic_readable_buffer.hpp>
+#include <essence/memory/dynamic_grid_buffer.hpp>
+#include <essence/memory/generic_resource_pool.hpp>
+#include <essence/memory/interleave.hpp>
+#include <essence/memory/memory_resources.hpp>
+#include <essence/memory/ring_queue.hpp>
+
+#include <gtest/gtest.h>
+
+#define MAKE_TEST(name) TEST(memory_test, name)
+
+namespace essence::testing {
+    namespace {
+        struct pooled_object {
+            std::int32_t id{};
+            std::int32_t uses{};
+        };
+
+        struct alignas(64) over_aligned_object {
+            std::byte value{};
+        };
+
+        bool is_aligned(const void* ptr, std::size_t alignment) noexcept {
+            return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+        }
+
+        [[maybe_unused]] memory::allocation_tag_stats find_tag_stats(std::string_view tag) {
+            const auto snapshot = memory::take_allocation_snapshot();
+            const auto iter     = std::ranges::find(snapshot.tags, tag, &memory::allocation_tag_stats::tag);
+
+            return iter == snapshot.tags.end() ? memory::allocation_tag_stats{} : *iter;
+        }
+    } // namespace
+
+    MAKE_TEST(generic_resource_pool) {
+        std::int32_t next_id{};
+        const generic_resource_pool<pooled_object> pool{
+            [&] { return pooled_object{.id = next_id++}; },
+            [](pooled_object& value) {
+                value.uses++;
+
+                // Objects used three times are destroyed instead of being reused.
+                return value.uses < 3;
+            },
+            resource_pool_options{.max_size = 2, .thread_cache_size = 0}};
+
+        {
+            auto first  = pool.acquire();
+            auto second = pool.acquire();
+            auto third  = pool.acquire();
+
+            ASSERT_TRUE(first);
+            ASSERT_EQ(first->id, 0);
+            ASSERT_EQ(second->id, 1);
+            ASSERT_EQ((*third).id, 2);
+        }
+
+        // Only two of the three released objects fit in the shared free list, and the leases are destroyed in the
+        // reverse order.
+        auto stats = pool.stats();
+
+        ASSERT_EQ(stats.created, 3U);
+        ASSERT_EQ(stats.discarded, 1U);
+        ASSERT_EQ(stats.idle, 2U);
+
+        {
+            const auto first  = pool.acquire();
+            const auto second = pool.acquire();
+
+            ASSERT_GT(first->id, 0);
+            ASSERT_GT(second->id, 0);
+            ASSERT_EQ(pool.stats().shared_hits, 2U);
+        }
+
+        // The objects have been used twice, so the third release makes the reset hook reject them.
+        { [[maybe_unused]] const auto lease = pool.acquire(); }
+        { [[maybe_unused]] const auto lease = pool.acquire(); }
+
+        stats = pool.stats();
+
+        ASSERT_EQ(stats.created, 3U);
+        ASSERT_EQ(stats.discarded, 3U);
+        ASSERT_EQ(stats.idle, 0U);
+
+        auto lease         = pool.acquire();
+        const auto object  = lease.detach();
+        const auto created = pool.stats().created;
+
+        ASSERT_FALSE(lease);
+        ASSERT_EQ(object->id, 3);
+        ASSERT_EQ(pool.stats().idle, 0U);
+
+        { [[maybe_unused]] const auto other = pool.acquire(); }
+
+        ASSERT_EQ(pool.stats().idle, 1U);
+        pool.trim();
+        ASSERT_EQ(pool.stats().idle, 0U);
+        ASSERT_EQ(pool.stats().created, created + 1);
+    }
+
+    MAKE_TEST(generic_resource_pool_thread_cache) {
+        const generic_resource_pool<std::vector<std::byte>> pool{[] { return std::vector<std::byte>(1024); },
+            [](std::vector<std::byte>& value) {
+                value.assign(value.size(), std::byte{});
+
+                return true;
+            }};
+
+        for (std::size_t i = 0; i < 100; i++) {
+            auto lease = pool.acquire();
+
+            ASSERT_EQ(lease->size(), 1024U);
+            (*lease)[0] = std::byte{1};
+        }
+
+        // The object kept by this thread serves every acquisition after the first.
+        auto stats = pool.stats();
+
+        ASSERT_EQ(stats.created, 1U);
+        ASSERT_EQ(stats.thread_cache_hits, 99U);
+        ASSERT_EQ(stats.idle, 0U);
+
+        static constexpr std::size_t thread_count = 8;
+        static constexpr std::size_t iterations   = 2000;
+
+        std::atomic<std::size_t> corrupted{};
+        std::vector<std::thread> threads;
+
+        for (std::size_t i = 0; i < thread_count; i++) {
+            threads.emplace_back([&] {
+                for (std::size_t j = 0; j < iterations; j++) {
+                    auto first  = pool.acquire();
+                    auto second = pool.acquire();
+
+                    // An object must never be leased twice at the same time, and must always be reset.
+                    if (first.get() == second.get() || (*first)[0] != std::byte{} || (*second)[0] != std::byte{}) {
+                        corrupted.fetch_add(1, std::memory_order::relaxed);
+                    }
+
+                    (*first)[0]  = std::byte{1};
+                    (*second)[0] = std::byte{1};
+                }
+            });
+        }
+
+        for (auto&& item : threads) {
+            item.join();
+        }
+
+        stats = pool.stats();
+
+        ASSERT_EQ(corrupted.load(), 0U);
+        ASSERT_EQ(stats.created + stats.thread_cache_hits + stats.shared_hits,
+            100 + thread_count * iterations * 2);
+
+        // The objects cached by the exited threads have been returned to the shared free list.
+        ASSERT_GT(stats.idle, 0U);
+        ASSERT_LE(stats.created, 1 + thread_count * 2);
+    }
+
+    MAKE_TEST(uniform_allocator_alignment) {
+        abi::vector<over_aligned_object> objects(3);
+
+        for (std::size_t i = 0; i < 10; i++) {
+            objects.emplace_back();
+            ASSERT_TRUE(is_aligned(objects.data(), alignof(over_aligned_object)));
+        }
+
+        // The current backend has served the allocations above, so it can no longer be replaced.
+        ASSERT_FALSE(es_set_allocator_backend(es_get_size_class_allocator_backend()));
+        ASSERT_NE(es_get_allocator_backend(), nullptr);
+    }
+
+    MAKE_TEST(size_class_allocator) {
+        const auto backend = es_get_size_class_allocator_backend();
+
+        static constexpr std::array sizes{0U, 1U, 15U, 16U, 17U, 100U, 129U, 1000U, 4096U, 4097U, 100000U};
+        static constexpr std::array alignments{1U, 8U, 16U, 32U, 64U, 128U, 4096U};
+
+        for (auto&& size : sizes) {
+            for (auto&& alignment : alignments) {
+                const auto ptr = backend->allocate(backend->context, size, alignment);
+
+                ASSERT_NE(ptr, nullptr);
+                ASSERT_TRUE(is_aligned(ptr, alignment));
+                std::memset(ptr, 0xcc, size);
+                backend->deallocate(backend->context, ptr, size, alignment);
+            }
+        }
+
+        // A released block is reused by the next allocation of the same class on the same thread.
+        const auto first = backend->allocate(backend->context, 40, 8);
+
+        backend->deallocate(backend->context, first, 40, 8);
+        ASSERT_EQ(backend->allocate(backend->context, 48, 16), first);
+        backend->deallocate(backend->context, first, 48, 16);
+
+        // Blocks allocated on one thread and released on another must never be handed out twice.
+        static constexpr std::size_t thread_count = 4;
+        static constexpr std::size_t block_count  = 10000;
+
+        std::vector<std::vector<void*>> blocks(thread_count);
+        std::vector<std::thread> threads;
+
+        for (std::size_t i = 0; i < thread_count; i++) {
+            threads.emplace_back([&, i] {
+                for (std::size_t j = 0; j < block_count; j++) {
+                    const auto size = 8 + (i + j) % 256;
+                    const auto ptr  = backend->allocate(backend->context, size, 8);
+
+                    std::memset(ptr, static_cast<std::int32_t>(i), size);
+                    blocks[i].emplace_back(ptr);
+                }
+            });
+        }
+
+        for (auto&& item : threads) {
+            item.join();
+        }
+
+        std::vector<void*> all_blocks;
+
+        for (auto&& item : blocks) {
+            all_blocks.insert(all_blocks.end(), item.begin(), item.end());
+        }
+
+        std::ranges::sort(all_blocks);
+        ASSERT_EQ(std::ranges::adjacent_find(all_blocks), all_blocks.end());
+
+        threads.clear();
+
+        for (std::size_t i = 0; i < thread_count; i++) {
+            threads.emplace_back([&, i] {
+                const auto owner = (i + 1) % thread_count;
+
+                for (std::size_t j = 0; j < block_count; j++) {
+                    backend->deallocate(backend->context, blocks[owner][j], 8 + (owner + j) % 256, 8);
+                }
+            });
+        }
+
+        for (auto&& item : threads) {
+            item.join();
+        }
+    }
+
+    MAKE_TEST(allocation_profiler) {
+#ifdef CPP_ESSENCE_HAS_ALLOCATION_PROFILING
+        static constexpr std::string_view tag{U8("memory_test")};
+
+        // The counters are cumulative, so only the differences are checked.
+        const auto before = find_tag_stats(tag);
+
+        memory::set_allocation_profiling(true);
+        ASSERT_TRUE(memory::is_allocation_profiling_enabled());
+
+        {
+            const memory::alloc_scope scope{tag};
+            const abi::vector<std::byte> buffer(100);
+
+            // Allocations on other threads are kept after the threads exit.
+            std::thread{[] {
+                const memory::alloc_scope inner_scope{tag};
+                const abi::vector<std::byte> inner_buffer(1000);
+            }}.join();
+        }
+
+        { const abi::vector<std::byte> untagged(100); }
+
+        memory::set_allocation_profiling(false);
+
+        const auto stats = find_tag_stats(tag);
+
+        ASSERT_EQ(stats.tag, tag);
+        ASSERT_EQ(stats.allocations - before.allocations, 2U);
+        ASSERT_EQ(stats.allocated_bytes - before.allocated_bytes, 1100U);
+        ASSERT_EQ(stats.deallocations - before.deallocations, 2U);
+        ASSERT_EQ(stats.deallocated_bytes - before.deallocated_bytes, 1100U);
+        ASSERT_EQ(stats.histogram[3] - before.histogram[3], 1U);
+        ASSERT_EQ(stats.histogram[6] - before.histogram[6], 1U);
+
+        // Nothing is counted while disabled.
+        {
+            const memory::alloc_scope scope{tag};
+            const abi::vector<std::byte> buffer(100);
+        }
+
+        ASSERT_EQ(find_tag_stats(tag).allocations, stats.allocations);
+
+        const auto json = memory::take_allocation_snapshot().to_json();
+
+        ASSERT_NE(json.find(U8(R"("tag":"memory_test")")), abi::string::npos);
+        ASSERT_NE(json.find(U8(R"("supported":true)")), abi::string::npos);
+#else
+        // The stubs ignore the switch and report that profiling is unsupported, even after tagged allocations.
+        memory::set_allocation_profiling(true);
+        ASSERT_FALSE(memory::is_allocation_profiling_enabled());
+
+        {
+            const memory::alloc_scope scope{U8("memory_test")};
+            const abi::vector<std::byte> buffer(100);
+        }
+
+        const auto snapshot = memory::take_allocation_snapshot();
+
+        ASSERT_FALSE(snapshot.supported);
+        ASSERT_TRUE(snapshot.tags.empty());
+        ASSERT_NE(snapshot.to_json().find(U8(R"("supported":false)")), abi::string::npos);
+        memory::set_allocation_profiling(false);
+#endif
+    }
+
+    MAKE_TEST(aligned_buffer) {
+        memory::aligned_buffer<std::byte> empty;
+
+        ASSERT_TRUE(empty.empty());
+        ASSERT_EQ(empty.data(), nullptr);
+
+        memory::aligned_buffer<std::uint32_t> values(1000);
+
+        ASSERT_EQ(values.size(), 1000U);
+        ASSERT_EQ(values.size_bytes(), 4000U);
+        ASSERT_TRUE(is_aligned(values.data(), memory::default_buffer_alignment));
+        ASSERT_TRUE(std::ranges::all_of(values, [](auto inner) { return inner == 0; }));
+
+        // Large buffers are aligned to huge pages.
+        memory::aligned_buffer<std::byte, 4096> large(memory::huge_page_threshold, memory::for_overwrite);
+        const std::span<std::byte> span = large;
+
+        ASSERT_EQ(span.data(), large.data());
+        ASSERT_EQ(span.size(), memory::huge_page_threshold);
+        ASSERT_TRUE(is_aligned(large.data(), memory::huge_page_threshold));
+        std::ranges::fill(span, std::byte{1});
+
+        auto moved = std::move(large);
+
+        ASSERT_TRUE(large.empty());
+        ASSERT_EQ(moved[memory::huge_page_threshold - 1], std::byte{1});
+
+        memory::aligned_buffer<std::string, 128> strings(3, memory::for_overwrite);
+
+        ASSERT_TRUE(is_aligned(strings.data(), 128));
+        ASSERT_TRUE(std::ranges::all_of(strings, &std::string::empty));
+        strings[0] = std::string(100, 'a');
+        strings.reset();
+        ASSERT_TRUE(strings.empty());
+    }
+
+    MAKE_TEST(atomic_readable_buffer) {
+        atomic_readable_buffer<std::string> strings;
+
+        ASSERT_TRUE(strings.read().empty());
+        ASSERT_EQ(strings.read().version(), 0U);
+
+        strings.update(std::vector<std::string>{"a", "b"});
+
+        {
+            const auto view = strings.read();
+
+            ASSERT_EQ(view.version(), 1U);
+            ASSERT_EQ(view.size(), 2U);
+            ASSERT_EQ(view[1], "b");
+
+            // The version held by the view is only reclaimed after the view is gone.
+            strings.update(1, [](auto& builder) { builder.emplace_back(3, 'c'); });
+            ASSERT_GT(strings.reclaim(), 0U);
+            ASSERT_EQ(view[0], "a");
+            ASSERT_EQ(strings.read()[0], "ccc");
+        }
+
+        ASSERT_EQ(strings.reclaim(), 0U);
+        ASSERT_THROW(strings.update(0, [](auto& builder) { builder.emplace_back("d"); }), std::length_error);
+        ASSERT_EQ(strings.read().version(), 2U);
+
+        strings.modify(1, [](auto& builder) {
+            builder.span()[0] += "c";
+            builder.emplace_back("d");
+        });
+
+        const std::vector<std::string> expected{"cccc", "d"};
+
+        ASSERT_TRUE(std::ranges::equal(strings.read(), expected));
+        strings.reset();
+        ASSERT_TRUE(strings.read().empty());
+        ASSERT_EQ(strings.read().version(), 4U);
+
+        // Readers always observe the size and the elements of the same version.
+        atomic_readable_buffer<std::uint64_t> values;
+        std::atomic_bool stopped{};
+        std::atomic_bool consistent{true};
+        std::vector<std::jthread> readers;
+
+        for (std::size_t i = 0; i < 4; i++) {
+            readers.emplace_back([&] {
+                while (!stopped.load(std::memory_order::relaxed)) {
+                    const auto view = values.read();
+
+                    if (view.size() != view.version() % 64
+                        || !std::ranges::all_of(view, [&](auto inner) { return inner == view.version(); })) {
+                        consistent = false;
+                    }
+                }
+            });
+        }
+
+        for (std::uint64_t version = 1; version <= 2000; version++) {
+            values.update(version % 64, [&](auto& builder) {
+                for (std::size_t i = 0; i < builder.capacity(); i++) {
+                    builder.emplace_back(version);
+                }
+            });
+        }
+
+        stopped = true;
+        readers.clear();
+        ASSERT_TRUE(consistent);
+        ASSERT_EQ(values.reclaim(), 0U);
+
+        // Concurrent modifications are serialized, so none of the appended elements is lost.
+        atomic_readable_buffer<std::uint64_t> appended;
+        std::vector<std::jthread> writers;
+
+        for (std::size_t i = 0; i < 4; i++) {
+            writers.emplace_back([&, i] {
+                for (std::uint64_t j = 0; j < 250; j++) {
+                    appended.modify(1, [&](auto& builder) { builder.emplace_back(i * 250 + j); });
+                }
+            });
+        }
+
+        writers.clear();
+        ASSERT_EQ(appended.read().size(), 1000U);
+        ASSERT_EQ(appended.read().version(), 1000U);
+    }
+
+    MAKE_TEST(spsc_ring_queue) {
+        memory::spsc_ring_queue<std::string> strings{3};
+
+        ASSERT_EQ(strings.capacity(), 4U);
+        ASSERT_FALSE(strings.try_pop());
+
+        for (std::size_t i = 0; i < strings.capacity(); i++) {
+            ASSERT_TRUE(strings.try_emplace(i + 1, 'a'));
+        }
+
+        ASSERT_FALSE(strings.try_push("b"));
+        ASSERT_EQ(strings.try_pop(), "a");
+
+        std::array<std::string, 4> batch{"b", "c", "d", "e"};
+
+        ASSERT_EQ(strings.try_push_n(batch), 1U);
+        ASSERT_EQ(batch[0], "");
+        ASSERT_EQ(strings.try_pop_n(batch), 4U);
+        ASSERT_TRUE(std::ranges::equal(batch, std::array<std::string_view, 4>{"aa", "aaa", "aaaa", "b"}));
+        ASSERT_TRUE(strings.empty());
+        ASSERT_EQ(strings.pop_n({}), 0U);
+
+        // The elements left in the queue are destroyed with it.
+        strings.push("f");
+
+        // The blocking operations keep the order across the wrap-around.
+        static constexpr std::uint64_t count = 100000;
+
+        memory::spsc_ring_queue<std::uint64_t> values{64};
+        std::jthread producer{[&] {
+            for (std::uint64_t i = 0; i < count; i++) {
+                values.push(i);
+            }
+        }};
+
+        std::uint64_t expected{};
+        std::array<std::uint64_t, 16> buffer{};
+
+        while (expected < count) {
+            const auto popped = values.pop_n(buffer);
+
+            for (std::size_t i = 0; i < popped; i++) {
+                ASSERT_EQ(buffer[i], expected++);
+            }
+        }
+    }
+
+    MAKE_TEST(mpmc_ring_queue) {
+        memory::mpmc_ring_queue<std::unique_ptr<std::int32_t>> pointers{2};
+
+        ASSERT_TRUE(pointers.try_push(std::make_unique<std::int32_t>(1)));
+
+        std::array<std::unique_ptr<std::int32_t>, 3> batch{
+            std::make_unique<std::int32_t>(2), std::make_unique<std::int32_t>(3), nullptr};
+
+        ASSERT_EQ(pointers.try_push_n(batch), 1U);
+        ASSERT_FALSE(pointers.try_emplace(nullptr));
+        ASSERT_EQ(pointers.size(), 2U);
+        ASSERT_EQ(*pointers.pop(), 1);
+        ASSERT_EQ(pointers.try_pop_n(batch), 1U);
+        ASSERT_EQ(*batch[0], 2);
+        ASSERT_FALSE(pointers.try_pop());
+        ASSERT_EQ(pointers.pop_n({}), 0U);
+
+        // Every element is delivered exactly once under contention, which also reports the throughput.
+        static constexpr std::size_t thread_count = 4;
+        static constexpr std::uint64_t count      = 200000;
+
+        memory::mpmc_ring_queue<std::uint64_t> values{1024};
+        std::atomic<std::uint64_t> sum{};
+        std::vector<std::jthread> threads;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < thread_count; i++) {
+            threads.emplace_back([&, i] {
+                for (auto value = i + 1; value <= count; value += thread_count) {
+                    values.push(value);
+                }
+            });
+
+            threads.emplace_back([&] {
+                std::array<std::uint64_t, 8> buffer{};
+                std::uint64_t local_sum{};
+
+                for (std::uint64_t popped = 0; popped < count / thread_count;) {
+                    const auto batch_size =
+                        values.pop_n(std::span{buffer}.first(std::min<std::size_t>(8, count / thread_count - popped)));
+
+                    local_sum = std::accumulate(buffer.begin(), buffer.begin() + batch_size, local_sum);
+                    popped += batch_size;
+                }
+
+                sum += local_sum;
+            });
+        }
+
+        threads.clear();
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        ::testing::Test::RecordProperty("ops_per_second", std::to_string(static_cast<std::uint64_t>(count / elapsed)));
+        ASSERT_EQ(sum, count * (count + 1) / 2);
+        ASSERT_TRUE(values.empty());
+    }
+
+    MAKE_TEST(byte_ring) {
+        memory::byte_ring ring{10};
+        std::array<std::byte, 12> buffer{};
+
+        ASSERT_EQ(ring.capacity(), 16U);
+        ASSERT_EQ(ring.try_read(buffer), 0U);
+        ASSERT_EQ(ring.read({}), 0U);
+        ASSERT_EQ(ring.try_write(std::as_bytes(std::span{"0123456789abcdef0", 17}.first(12))), 12U);
+        ASSERT_EQ(ring.try_read(std::span{buffer}.first(8)), 8U);
+
+        // The write wraps around the end of the storage.
+        ASSERT_EQ(ring.try_write(std::as_bytes(std::span{"ghijklmnopqr", 12})), 12U);
+        ASSERT_EQ(ring.size(), 16U);
+        ASSERT_EQ(ring.try_read(buffer), 12U);
+        ASSERT_EQ(std::memcmp(buffer.data(), "89abghijklmn", 12), 0);
+
+        // A stream larger than the ring passes through in order.
+        std::vector<std::byte> input(100000);
+
+        for (std::size_t i = 0; i < input.size(); i++) {
+            input[i] = static_cast<std::byte>(i * 7);
+        }
+
+        memory::byte_ring stream{256};
+        std::jthread writer{[&] {
+            for (std::size_t offset = 0; offset < input.size(); offset += 1000) {
+                stream.write(std::span{input}.subspan(offset, 1000));
+            }
+        }};
+
+        std::vector<std::byte> output(input.size());
+
+        for (std::size_t offset = 0; offset < output.size();) {
+            offset += stream.read(
+                std::span{output}.subspan(offset, std::min<std::size_t>(300, output.size() - offset)));
+        }
+
+        ASSERT_EQ(output, input);
+    }
+
+    MAKE_TEST(interleave) {
+        // Odd lengths cover both the SIMD blocks and the scalar tails.
+        for (const std::size_t channels : {2, 3, 4, 5}) {
+            for (const std::size_t element_size : {1, 2, 4, 3}) {
+                static constexpr std::size_t count = 37;
+
+                std::vector<std::byte> interleaved(count * channels * element_size);
+                std::vector<std::vector<std::byte>> planes(channels, std::vector<std::byte>(count * element_size));
+
+                for (std::size_t i = 0; i < interleaved.size(); i++) {
+                    interleaved[i] = static_cast<std::byte>(i * 31 + 7);
+                }
+
+                std::vector<std::span<std::byte>> plane_spans(planes.begin(), planes.end());
+
+                memory::deinterleave(interleaved, plane_spans, element_size);
+
+                for (std::size_t i = 0; i < count; i++) {
+                    for (std::size_t j = 0; j < channels; j++) {
+                        ASSERT_EQ(std::memcmp(planes[j].data() + i * element_size,
+                                      interleaved.data() + (i * channels + j) * element_size, element_size),
+                            0);
+                    }
+                }
+
+                std::vector<std::byte> merged(interleaved.size());
+                std::vector<std::span<const std::byte>> const_plane_spans(planes.begin(), planes.end());
+
+                memory::interleave(const_plane_spans, merged, element_size);
+                ASSERT_EQ(merged, interleaved);
+            }
+        }
+
+        std::array<std::byte, 6> small{};
+        std::array<std::byte, 2> plane{};
+        const std::array<std::span<std::byte>, 2> mismatched{plane, plane};
+
+        ASSERT_THROW(memory::deinterleave(small, mismatched, 1), source_code_aware_runtime_error);
+    }
+
+    MAKE_TEST(dynamic_grid_buffer) {
+        memory::dynamic_grid_buffer<std::uint16_t> grid{3, {5, 2}, memory::grid_layout_options{.row_alignment = 32}};
+
+        ASSERT_EQ(grid.rows(), 3U);
+        ASSERT_EQ(grid.component_count(), 2U);
+        ASSERT_EQ(grid.row_cell_count(), 7U);
+        ASSERT_EQ(grid.row_stride(), 32U);
+        ASSERT_EQ(grid.underlying_buffer().size(), 96U);
+
+        for (std::size_t i = 0; i < grid.rows(); i++) {
+            ASSERT_TRUE(is_aligned(grid.get_row(i).data(), 32));
+        }
+
+        const std::array<std::uint16_t, 2> values{1, 2};
+
+        grid.set_component(1, 1, values);
+        ASSERT_EQ(grid.get_row(1)[5], 1);
+        ASSERT_EQ(grid.get_component(1, 1)[1], 2);
+        ASSERT_THROW(grid.set_component(0, 0, values), source_code_aware_runtime_error);
+
+        // A larger stride only changes the padding.
+        memory::dynamic_grid_buffer<std::uint16_t> padded{
+            3, {5, 2}, memory::grid_layout_options{.min_row_stride = 100}};
+
+        ASSERT_EQ(padded.row_stride(), 128U);
+        padded.copy_from(grid);
+        ASSERT_TRUE(std::ranges::equal(padded.get_row(1), grid.get_row(1)));
+
+        auto copied = padded;
+
+        std::ranges::fill(padded.get_component(2, 0), 9);
+        copied.copy_component_from(padded, 0);
+        ASSERT_EQ(copied.get_row(2)[4], 9);
+        ASSERT_EQ(copied.get_row(1)[6], 2);
+
+        // Interleaved RGBA rows round-trip through the planar components.
+        memory::dynamic_grid_buffer<std::uint8_t> planar{4, {20, 20, 20, 20}};
+        std::vector<std::uint8_t> interleaved(4 * 80);
+        std::vector<std::uint8_t> merged(interleaved.size());
+
+        std::iota(interleaved.begin(), interleaved.end(), std::uint8_t{});
+        planar.load_interleaved(interleaved);
+        ASSERT_EQ(planar.get_component(1, 2)[3], (80 + 3 * 4 + 2) % 256);
+        planar.store_interleaved(merged);
+        ASSERT_EQ(merged, interleaved);
+        ASSERT_THROW(grid.load_interleaved(std::span<const std::uint16_t>{}), source_code_aware_runtime_error);
+    }
+
+    MAKE_TEST(memory_resources) {
+        for (const auto resource : {memory::get_huge_page_resource(), memory::get_numa_local_resource()}) {
+            // Large allocations are mapped and aligned to huge pages, small ones come from the heap.
+            const auto large = static_cast<std::byte*>(resource->allocate(memory::huge_page_threshold * 2, 64));
+
+            ASSERT_TRUE(is_aligned(large, memory::huge_page_threshold));
+            std::memset(large, 1, memory::huge_page_threshold * 2);
+            resource->deallocate(large, memory::huge_page_threshold * 2, 64);
+
+            const auto medium = resource->allocate(memory::page_resource_threshold * 3, 8192);
+
+            ASSERT_TRUE(is_aligned(medium, 8192));
+            std::memset(medium, 1, memory::page_resource_threshold * 3);
+            resource->deallocate(medium, memory::page_resource_threshold * 3, 8192);
+
+            std::pmr::vector<std::int32_t> small{{1, 2, 3}, resource};
+
+            ASSERT_EQ(small[2], 3);
+        }
+
+        ASSERT_FALSE(memory::get_huge_page_resource()->is_equal(*memory::get_numa_local_resource()));
+        ASSERT_GE(memory::get_current_numa_node(), -1);
+
+        // A reset arena serves the next request from its largest chunk.
+        memory::monotonic_arena_resource arena{memory::get_huge_page_resource(), 1024};
+
+        for (std::size_t i = 0; i < 3; i++) {
+            const auto first = arena.allocate(16, 16);
+
+            std::pmr::vector<std::uint64_t> values{&arena};
+
+            values.resize(10000);
+            ASSERT_TRUE(is_aligned(arena.allocate(1, 256), 256));
+            ASSERT_GE(arena.bytes_used(), 80000U);
+
+            arena.reset();
+            ASSERT_EQ(arena.bytes_used(), 0U);
+
+            if (i != 0) {
+                ASSERT_EQ(arena.allocate(16, 16), first);
+                arena.reset();
+            }
+        }
+
+        ASSERT_THROW(static_cast<void>(arena.allocate(std::numeric_limits<std::size_t>::max() - 8, 16)),
+            std::bad_alloc);
+
+        // The resources serve the ABI containers through backends.
+        const auto backend = abi::make_allocator_backend(arena);
+        const auto ptr     = backend.allocate(backend.context, 64, 16);
+
+        ASSERT_NE(ptr, nullptr);
+        backend.deallocate(backend.context, ptr, 64, 16);
+
+        for (const auto item : {es_get_huge_page_allocator_backend(), es_get_numa_local_allocator_backend()}) {
+            const auto buffer = item->allocate(item->context, memory::huge_page_threshold, 16);
+
+            ASSERT_NE(buffer, nullptr);
+            std::memset(buffer, 1, memory::huge_page_threshold);
+            item->deallocate(item->context, buffer, memory::huge_page_threshold, 16);
+        }
+    }
+} // namespace essence::testing
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 The RefValue Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <exception>
+
+#include <essence/char8_t_remediation.hpp>
+#include <essence/cli/arg_parser.hpp>
+#include <essence/io/resource_archive.hpp>
+
+#include <spdlog/spdlog.h>
+
+int main(int argc, char* argv[]) try {
+    using namespace essence;
+    using namespace essence::cli;
+    using namespace essence::io;
+
+    if (const arg_parser parser; parser.parse(argc, argv), parser) {
+        const auto unmatched = parser.unmatched_args();
+
+        if (unmatched.size() == 2) {
+            spdlog::error(U8("Missing an argument: the output archive."));
+            std::exit(-1);
+        }
+
+        if (unmatched.size() == 1) {
+            spdlog::error(U8("Missing an argument: the input directory."));
+            std::exit(-2);
+        }
+
+        const resource_archive_writer writer;
+
+        spdlog::info(U8("Packing {} to {}..."), unmatched[1], unmatched[2]);
+        writer.add_directory(unmatched[1]);
+        writer.save(unmatched[2]);
+        spdlog::info(U8("Packed {} entries."), writer.entry_count());
+    }
+} catch (const std::exception& ex) {
+    spdlog::error(ex.what());
+
+    return -99;
+}